@@ -6,16 +6,172 @@
  *
  *   1. We open an SDL_AudioStream via SDL_OpenAudioDeviceStream(),
  *      which creates a stream bound to a playback device.
- *   2. A "get" callback fires when the device needs more samples.
- *      We decode FFmpeg audio frames, resample to F32 stereo, and
- *      push data into the stream via SDL_PutAudioStreamData().
- *   3. Volume is controlled via SDL_SetAudioStreamGain() — no
+ *   2. An audio decode thread decodes FFmpeg audio frames, converts
+ *      them to F32 at the device's channel count (swr only when
+ *      resampling; float sources are interleaved or SIMD-downmixed
+ *      directly, see downmix.c), and fills a lock-free PCM ring.
+ *   3. A "get" callback fires when the device needs more samples. It
+ *      only copies from the ring into the stream via
+ *      SDL_PutAudioStreamData() — no decode, no swr, no queue locks on
+ *      SDL's real-time thread.
+ *   4. Volume is controlled via SDL_SetAudioStreamGain() — no
  *      manual mixing needed.
- *   4. audio_clock tracks playback position for A/V sync.
+ *   5. In passthrough (bitstream.c) the thread fills the ring with
+ *      IEC 61937 bursts instead, the stream is S16 at the burst carrier
+ *      rate, and the gain stays at 1.0.
+ *   6. audio_clock_sync is the PTS at the ring read position, minus
+ *      what SDL still holds — the playback position for A/V sync.
  */
 
 #include "dsvp.h"
 
+/* ═══════════════════════════════════════════════════════════════════
+ * Output Conversion
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Channel layout in SDL's channel order for `n` device channels. SDL's
+ * 5.1 slots 5/6 are the surrounds; a 5.1(side) source keeps its own
+ * layout there, so it plays unchanged instead of being remixed to back. */
+static void audio_sdl_layout(AVChannelLayout *out, int n, const AVChannelLayout *src) {
+    switch (n) {
+    case 1:  *out = (AVChannelLayout)AV_CHANNEL_LAYOUT_MONO;   break;
+    case 4:  *out = (AVChannelLayout)AV_CHANNEL_LAYOUT_QUAD;   break;
+    case 6: {
+        AVChannelLayout side = AV_CHANNEL_LAYOUT_5POINT1;
+        if (src && av_channel_layout_compare(src, &side) == 0)
+            *out = side;
+        else
+            *out = (AVChannelLayout)AV_CHANNEL_LAYOUT_5POINT1_BACK;
+        break;
+    }
+    case 8:  *out = (AVChannelLayout)AV_CHANNEL_LAYOUT_7POINT1; break;
+    default: *out = (AVChannelLayout)AV_CHANNEL_LAYOUT_STEREO;  break;
+    }
+}
+
+/* Output channel count for a `src_ch` source: as many as both the source
+ * and the default device have, rounded down to a layout whose SDL order
+ * matches FFmpeg's (mono, stereo, quad, 5.1, 7.1). */
+static int audio_pick_channels(int src_ch) {
+    SDL_AudioSpec dev;
+    int dev_ch = 2;
+    if (SDL_GetAudioDeviceFormat(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &dev, NULL) &&
+        dev.channels > 0)
+        dev_ch = dev.channels;
+
+    int n = src_ch < dev_ch ? src_ch : dev_ch;
+    if (n > AUDIO_MAX_OUT_CH) n = AUDIO_MAX_OUT_CH;
+    static const int ok[] = { 8, 6, 4, 2, 1 };
+    for (int i = 0; i < 5; i++)
+        if (n >= ok[i]) return ok[i];
+    return 2;
+}
+
+/* Convert the decoded frame into audio_buf as interleaved F32 in the
+ * negotiated layout. Returns frames written, or -1.
+ *
+ * Float sources at the device rate bypass swr: a matching layout is
+ * copied or interleaved, a wider one goes through the SIMD downmix with
+ * swr's own coefficients. Everything else (resampling, integer
+ * formats, upmix) still goes through swr — and so does everything in
+ * display sync, where swr's compensation bends the audio rate. */
+static int audio_convert_frame(PlayerState *ps, AVFrame *f) {
+    const AVChannelLayout *out_layout = &ps->audio_out_layout;
+    int out_ch = out_layout->nb_channels;
+    int in_ch  = f->ch_layout.nb_channels;
+    int n      = f->nb_samples;
+    float *out = (float *)ps->audio_buf;
+
+    if ((size_t)n * out_ch * sizeof(float) > AUDIO_BUF_SIZE) {
+        log_msg("WARN: audio frame of %d samples exceeds buffer, dropped", n);
+        return -1;
+    }
+
+    int planar = (f->format == AV_SAMPLE_FMT_FLTP);
+    int packed = (f->format == AV_SAMPLE_FMT_FLT);
+
+    int slaved = (ps->sync_mode == SYNC_DISPLAY);
+
+    if (!slaved && f->sample_rate == ps->audio_spec.freq && (planar || packed)) {
+        int same = av_channel_layout_compare(&f->ch_layout, out_layout) == 0;
+
+        /* ── Same layout: no arithmetic ── */
+        if (same && packed) {
+            memcpy(out, f->data[0], (size_t)n * out_ch * sizeof(float));
+            ps->audio_path = AUDIO_PATH_DIRECT;
+            return n;
+        }
+        if (same && planar) {
+            audio_interleave((const float *const *)f->extended_data, in_ch, out, n);
+            ps->audio_path = AUDIO_PATH_INTERLEAVE;
+            return n;
+        }
+
+        /* ── Downmix: matrix from swr, applied by downmix.c ── */
+        if (planar && in_ch > out_ch && in_ch <= AUDIO_MAX_IN_CH) {
+            if (av_channel_layout_compare(&f->ch_layout, &ps->audio_mix_in) != 0) {
+                double m[AUDIO_MAX_OUT_CH * AUDIO_MAX_IN_CH];
+                /* swr's defaults for float output: -3 dB centre and
+                 * surround, no LFE. Its auto maxval (rematrix_maxval 0)
+                 * resolves to INT_MAX for float, i.e. no normalization;
+                 * a literal 0 here would scale every coefficient by 1/0 */
+                int ret = swr_build_matrix2(&f->ch_layout, out_layout,
+                                            M_SQRT1_2, M_SQRT1_2, 0.0, INT_MAX, 1.0,
+                                            m, in_ch, AV_MATRIX_ENCODING_NONE, NULL);
+                if (ret < 0) goto resample;
+                for (int i = 0; i < out_ch * in_ch; i++)
+                    ps->audio_mix_matrix[i] = (float)m[i];
+                av_channel_layout_uninit(&ps->audio_mix_in);
+                av_channel_layout_copy(&ps->audio_mix_in, &f->ch_layout);
+                log_msg("Audio: %dch -> %dch downmix (%s kernel)",
+                        in_ch, out_ch, audio_mix_kernel_name(-1));
+            }
+            audio_mix((const float *const *)f->extended_data, in_ch,
+                      ps->audio_mix_matrix, out_ch, out, n);
+            ps->audio_path = AUDIO_PATH_DOWNMIX;
+            return n;
+        }
+    }
+
+resample:
+    if (!ps->swr_ctx) {
+        int ret = swr_alloc_set_opts2(&ps->swr_ctx,
+            out_layout, AV_SAMPLE_FMT_FLT, ps->audio_spec.freq,    // was AV_SAMPLE_FMT_S16
+            &f->ch_layout, f->format, f->sample_rate, 0, NULL);
+        if (ret < 0 || swr_init(ps->swr_ctx) < 0) {
+            log_msg("ERROR: swr init failed: %s", av_err2str(ret));
+            return -1;
+        }
+    }
+
+    /* ── Display sync: play at ds_audio_speed ──
+     * Spread the sample surplus or deficit over this frame. At most
+     * ±0.5%, below what pitch perception can pick up on programme
+     * material. */
+    if (slaved) {
+        int nominal = (int)av_rescale_rnd(n, ps->audio_spec.freq, f->sample_rate,
+                                          AV_ROUND_UP);
+        double speed = ps->ds_audio_speed > 0.0 ? ps->ds_audio_speed : 1.0;
+        int delta = (int)lrint(nominal * (1.0 / speed - 1.0));
+        if (nominal > 0)
+            swr_set_compensation(ps->swr_ctx, delta, nominal);
+    }
+
+    int out_samples = swr_get_out_samples(ps->swr_ctx, n);
+    int cap = (int)(AUDIO_BUF_SIZE / (out_ch * sizeof(float)));
+    if (out_samples > cap) out_samples = cap;
+
+    uint8_t *out_buf = ps->audio_buf;
+    int converted = swr_convert(ps->swr_ctx, &out_buf, out_samples,
+                                (const uint8_t **)f->extended_data, n);
+    if (converted < 0) {
+        fprintf(stderr, "[DSVP] Resample error\n");
+        return -1;
+    }
+    ps->audio_path = AUDIO_PATH_SWR;
+    return converted;
+}
+
 /* ═══════════════════════════════════════════════════════════════════
  * Audio Decode
  * ═══════════════════════════════════════════════════════════════════ */
@@ -55,39 +211,58 @@ int audio_decode_frame(PlayerState *ps) {
                 ps->audio_pts_floor = 0.0;  /* floor satisfied — clear */
             }
 
-            if (!ps->swr_ctx) {
-                AVChannelLayout out_layout = AV_CHANNEL_LAYOUT_STEREO;
-                ret = swr_alloc_set_opts2(&ps->swr_ctx,
-                    &out_layout, AV_SAMPLE_FMT_FLT, ps->audio_spec.freq,    // was AV_SAMPLE_FMT_S16
-                    &ps->audio_frame->ch_layout, ps->audio_frame->format,
-                    ps->audio_frame->sample_rate, 0, NULL);
-                if (ret < 0 || swr_init(ps->swr_ctx) < 0) {
-                    log_msg("ERROR: swr init failed: %s", av_err2str(ret));
-                    return -1;
-                }
-            }
-
-            int out_samples = swr_get_out_samples(ps->swr_ctx, ps->audio_frame->nb_samples);
-            int out_size = out_samples * 2 * 4;
-
-            if (!ps->audio_buf || out_size > AUDIO_BUF_SIZE) {
-                av_free(ps->audio_buf);
+            if (!ps->audio_buf) {
                 ps->audio_buf = av_malloc(AUDIO_BUF_SIZE);
                 if (!ps->audio_buf) return -1;
             }
 
-            uint8_t *out_buf = ps->audio_buf;
-            int converted = swr_convert(ps->swr_ctx,
-                &out_buf, out_samples,
-                (const uint8_t **)ps->audio_frame->data,
-                ps->audio_frame->nb_samples);
-
+            int converted = audio_convert_frame(ps, ps->audio_frame);
             if (converted < 0) {
-                fprintf(stderr, "[DSVP] Resample error\n");
+                av_frame_unref(ps->audio_frame);
                 return -1;
             }
 
-            data_size = converted * 2 * 4;
+            /* ── Track switch splice ──
+             * The ring still holds the old track up to audio_splice_pts
+             * (audio_ring_cut); the new decoder was primed from before
+             * it. Trim its output to start on that exact sample and
+             * crossfade in over the old track's next few milliseconds. */
+            double spliced_at = -1.0;
+            if (ps->audio_splice_pts > 0.0) {
+                int64_t fp = ps->audio_frame->best_effort_timestamp;
+                if (fp == AV_NOPTS_VALUE) fp = ps->audio_frame->pts;
+                if (fp != AV_NOPTS_VALUE) {
+                    AVStream *as = ps->fmt_ctx->streams[ps->audio_stream_idx];
+                    double pts_sec = (double)fp * av_q2d(as->time_base);
+                    int skip = (int)((ps->audio_splice_pts - pts_sec) *
+                                     ps->audio_spec.freq + 0.5);
+                    if (skip >= converted) {
+                        av_frame_unref(ps->audio_frame);
+                        continue;   /* wholly before the splice */
+                    }
+                    if (skip > 0) {
+                        size_t fb = (size_t)ps->audio_spec.channels * sizeof(float);
+                        memmove(ps->audio_buf, ps->audio_buf + skip * fb,
+                                (size_t)(converted - skip) * fb);
+                        converted -= skip;
+                        spliced_at = ps->audio_splice_pts;
+                    }
+                }
+                int ch  = ps->audio_spec.channels;
+                int len = ps->audio_xfade_len;
+                int n   = len < converted ? len : converted;
+                float *out = (float *)ps->audio_buf;
+                for (int i = 0; i < n; i++) {
+                    float g = ((float)i + 0.5f) / (float)len;
+                    for (int c = 0; c < ch; c++)
+                        out[i * ch + c] = out[i * ch + c] * g
+                                        + ps->audio_xfade[i * ch + c] * (1.0f - g);
+                }
+                ps->audio_xfade_len  = 0;
+                ps->audio_splice_pts = 0.0;
+            }
+
+            data_size = converted * ps->audio_spec.channels * (int)sizeof(float);
 
             int64_t frame_pts = ps->audio_frame->best_effort_timestamp;
             if (frame_pts == AV_NOPTS_VALUE)
@@ -98,6 +273,9 @@ int audio_decode_frame(PlayerState *ps) {
                 AVStream *as = ps->fmt_ctx->streams[ps->audio_stream_idx];
                 ps->audio_clock = (double)frame_pts * av_q2d(as->time_base);
             }
+            if (spliced_at >= 0.0)
+                ps->audio_clock = spliced_at;   /* first sample kept */
+            ps->audio_buf_pts = ps->audio_clock;
             ps->audio_clock += (double)converted / ps->audio_spec.freq;
 
             av_frame_unref(ps->audio_frame);
@@ -117,6 +295,289 @@ int audio_decode_frame(PlayerState *ps) {
 }
 
 
+/* ═══════════════════════════════════════════════════════════════════
+ * PCM Ring
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Lossless tracks (TrueHD/MLP, DTS-HD MA) decode in bursts: MLP access
+ * units are small but expensive, and the DTS-HD MA extension can cost
+ * several times the core. They get a deeper ring to ride out a slow
+ * stretch while the video decoder has every core busy. */
+static int audio_is_lossless(const AVCodecContext *ctx) {
+    switch (ctx->codec_id) {
+    case AV_CODEC_ID_TRUEHD:
+    case AV_CODEC_ID_MLP:
+        return 1;
+    case AV_CODEC_ID_DTS:
+        return ctx->profile == AV_PROFILE_DTS_HD_MA ||
+               ctx->profile == AV_PROFILE_DTS_HD_MA_X ||
+               ctx->profile == AV_PROFILE_DTS_HD_MA_X_IMAX;
+    default:
+        return 0;
+    }
+}
+
+/* Packet ring slots for `sec` of this track. TrueHD/MLP sends one
+ * access unit per packet, 1200 a second at any sample rate, so the
+ * default ring holds under a second of it — too little for the audio
+ * readahead, and a full ring stops the demuxer for video too. Other
+ * codecs go by frame_size where the demuxer knows it. */
+unsigned audio_queue_slots(const AVCodecParameters *par, double sec) {
+    double rate = 0.0;   /* packets per second */
+    if (par->codec_id == AV_CODEC_ID_TRUEHD || par->codec_id == AV_CODEC_ID_MLP)
+        rate = 1200.0;
+    else if (par->frame_size > 0 && par->sample_rate > 0)
+        rate = (double)par->sample_rate / par->frame_size;
+
+    double need = rate * sec * 1.25;   /* headroom for packet jitter */
+    unsigned slots = PACKET_QUEUE_SLOTS;
+    while (slots < need && slots < (1u << 16))
+        slots <<= 1;
+    return slots;
+}
+
+static int audio_ring_ms(const AVCodecContext *ctx) {
+    return audio_is_lossless(ctx) ? AUDIO_RING_LOSSLESS_MS : AUDIO_RING_MS;
+}
+
+static int audio_ring_init(AudioRing *r, int freq, int frame_bytes, int ms) {
+    unsigned want = (unsigned)((int64_t)freq * ms / 1000);
+    unsigned cap  = 1024;
+    while (cap < want) cap <<= 1;
+
+    memset(r, 0, sizeof(*r));
+    r->buf = malloc((size_t)cap * frame_bytes);
+    if (!r->buf) return -1;
+    r->capacity    = cap;
+    r->mask        = cap - 1;
+    r->frame_bytes = frame_bytes;
+    r->freq        = freq;
+    r->align       = 1;
+    return 0;
+}
+
+static void audio_ring_free(AudioRing *r) {
+    free(r->buf);
+    memset(r, 0, sizeof(*r));
+}
+
+/* Drop everything buffered. Caller holds adec_mutex (excludes the decode
+ * thread); the stream lock excludes the callback. */
+void audio_ring_reset(PlayerState *ps) {
+    AudioRing *r = &ps->audio_ring;
+    if (ps->audio_stream) SDL_LockAudioStream(ps->audio_stream);
+    SDL_SetAtomicInt(&r->wpos, 0);
+    SDL_SetAtomicInt(&r->rpos, 0);
+    SDL_SetAtomicInt(&r->tag_w, 0);
+    SDL_SetAtomicInt(&r->tag_r, 0);
+    r->floor = 0.0;
+    r->floor_slack = 0.0;
+    if (ps->audio_stream) SDL_UnlockAudioStream(ps->audio_stream);
+    ps->audio_buf_size  = 0;
+    ps->audio_buf_index = 0;
+}
+
+/* Track switch: keep `lead` seconds of PCM past the read position and
+ * drop the rest of the ring, so the new track follows almost at once
+ * instead of after the whole ring (up to AUDIO_RING_LOSSLESS_MS). The
+ * first AUDIO_SWITCH_FADE of the dropped tail is kept in audio_xfade
+ * for audio_decode_frame() to crossfade into the new track. *pts is the
+ * PTS of the cut, *heard the estimated time until it is audible (ring,
+ * SDL stream and device buffer). Caller holds adec_mutex (excludes the
+ * producer); the stream lock excludes the callback. Returns 0 if the
+ * ring has never been tagged. */
+int audio_ring_cut(PlayerState *ps, double lead, double *pts, double *heard) {
+    AudioRing *r = &ps->audio_ring;
+    ps->audio_xfade_len = 0;
+    if (!r->buf || !ps->audio_stream) return 0;
+
+    SDL_LockAudioStream(ps->audio_stream);
+    unsigned rd = (unsigned)SDL_GetAtomicInt(&r->rpos);
+    unsigned w  = (unsigned)SDL_GetAtomicInt(&r->wpos);
+    unsigned tr = (unsigned)SDL_GetAtomicInt(&r->tag_r);
+    unsigned tw = (unsigned)SDL_GetAtomicInt(&r->tag_w);
+    if (tr == tw) {
+        SDL_UnlockAudioStream(ps->audio_stream);
+        return 0;
+    }
+
+    unsigned cut = rd + (unsigned)(lead * r->freq);
+    if ((int)(cut - w) > 0) cut = w;
+
+    /* PTS at the cut from the latest tag at or before it. Tags past it
+     * go with the dropped PCM; the current one always stays. */
+    unsigned t = tr;
+    while (t + 1 != tw && (int)(cut - r->tags[(t + 1) % AUDIO_RING_TAGS].pos) >= 0)
+        t++;
+    *pts = r->tags[t % AUDIO_RING_TAGS].pts
+         + (double)(cut - r->tags[t % AUDIO_RING_TAGS].pos) / r->freq;
+    while (tw - 1 != tr && (int)(r->tags[(tw - 1) % AUDIO_RING_TAGS].pos - cut) >= 0)
+        tw--;
+
+    /* Old track's PCM just past the cut, for the crossfade (float PCM;
+     * passthrough never takes the fast switch) */
+    unsigned fade = (unsigned)(AUDIO_SWITCH_FADE * r->freq);
+    if (fade > AUDIO_XFADE_MAX) fade = AUDIO_XFADE_MAX;
+    if (fade > w - cut) fade = w - cut;
+    if (r->frame_bytes == ps->audio_spec.channels * (int)sizeof(float)) {
+        for (unsigned i = 0; i < fade; i++)
+            memcpy(ps->audio_xfade + (size_t)i * ps->audio_spec.channels,
+                   r->buf + (size_t)((cut + i) & r->mask) * r->frame_bytes,
+                   (size_t)r->frame_bytes);
+        ps->audio_xfade_len = (int)fade;
+    }
+
+    SDL_SetAtomicInt(&r->tag_w, (int)tw);
+    SDL_SetAtomicInt(&r->wpos, (int)cut);
+
+    int queued = SDL_GetAudioStreamQueued(ps->audio_stream);
+    SDL_UnlockAudioStream(ps->audio_stream);
+
+    *heard = (double)(cut - rd) / r->freq;
+    if (queued > 0 && ps->audio_spec.freq > 0)
+        *heard += (double)queued / ((double)ps->audio_spec.freq * r->frame_bytes);
+    SDL_AudioSpec dev;
+    int dev_frames = 0;
+    SDL_AudioDeviceID dev_id = SDL_GetAudioStreamDevice(ps->audio_stream);
+    if (dev_id && SDL_GetAudioDeviceFormat(dev_id, &dev, &dev_frames) &&
+        dev_frames > 0 && dev.freq > 0)
+        *heard += (double)dev_frames / dev.freq;
+    return 1;
+}
+
+/* Producer: move as much of audio_buf into the ring as fits. A new
+ * decoded frame also needs a free tag slot. Returns frames moved. */
+static int audio_ring_push(PlayerState *ps) {
+    AudioRing *r = &ps->audio_ring;
+    int frame_bytes = r->frame_bytes;
+
+    unsigned w = (unsigned)SDL_GetAtomicInt(&r->wpos);
+    unsigned space = r->capacity - (w - (unsigned)SDL_GetAtomicInt(&r->rpos));
+    unsigned avail = (ps->audio_buf_size - ps->audio_buf_index) / frame_bytes;
+    unsigned n = avail < space ? avail : space;
+    if (n == 0) return 0;
+
+    /* Tag a new decoded frame only when its PTS breaks from the last
+     * tag's extrapolation. Continuous audio then needs one tag per
+     * discontinuity, not one per frame — MLP emits 1200 frames/s. */
+    if (ps->audio_buf_index == 0) {
+        unsigned tw = (unsigned)SDL_GetAtomicInt(&r->tag_w);
+        unsigned tr = (unsigned)SDL_GetAtomicInt(&r->tag_r);
+        int continuous = 0;
+        if (tw != tr) {
+            const AudioRingTag *t = &r->tags[(tw - 1) % AUDIO_RING_TAGS];
+            double expect = t->pts + (double)(w - t->pos) / r->freq;
+            continuous = fabs(ps->audio_buf_pts - expect) < 0.001;
+        }
+        if (!continuous) {
+            if (tw - tr >= AUDIO_RING_TAGS)
+                return 0;
+            r->tags[tw % AUDIO_RING_TAGS].pos = w;
+            r->tags[tw % AUDIO_RING_TAGS].pts = ps->audio_buf_pts;
+            SDL_SetAtomicInt(&r->tag_w, (int)(tw + 1));
+        }
+    }
+
+    /* Copy in up to two pieces (wrap) */
+    const uint8_t *src = ps->audio_buf + ps->audio_buf_index;
+    unsigned off   = w & r->mask;
+    unsigned first = r->capacity - off;
+    if (first > n) first = n;
+    memcpy(r->buf + (size_t)off * frame_bytes, src,
+           (size_t)first * frame_bytes);
+    memcpy(r->buf, src + (size_t)first * frame_bytes,
+           (size_t)(n - first) * frame_bytes);
+
+    ps->audio_buf_index += n * frame_bytes;
+    SDL_SetAtomicInt(&r->wpos, (int)(w + n));   /* publish */
+    return (int)n;
+}
+
+/* Callback: PTS of ring position `pos`, from the latest tag at or before
+ * it. Retires tags the read position has moved past. */
+static int audio_ring_pts(AudioRing *r, unsigned pos, double *pts) {
+    unsigned tr = (unsigned)SDL_GetAtomicInt(&r->tag_r);
+    unsigned tw = (unsigned)SDL_GetAtomicInt(&r->tag_w);
+    if (tr == tw) return 0;
+
+    while (tr + 1 != tw &&
+           (int)(pos - r->tags[(tr + 1) % AUDIO_RING_TAGS].pos) >= 0)
+        tr++;
+    SDL_SetAtomicInt(&r->tag_r, (int)tr);
+
+    const AudioRingTag *t = &r->tags[tr % AUDIO_RING_TAGS];
+    if ((int)(pos - t->pos) < 0) return 0;
+    *pts = t->pts + (double)(pos - t->pos) / r->freq;
+    return 1;
+}
+
+/* Callback: ring position where the tag after the current one starts,
+ * or `end` if there is none. */
+static unsigned audio_ring_segment_end(AudioRing *r, unsigned end) {
+    unsigned tr = (unsigned)SDL_GetAtomicInt(&r->tag_r);
+    unsigned tw = (unsigned)SDL_GetAtomicInt(&r->tag_w);
+    if (tr + 1 == tw || tr == tw) return end;
+    unsigned pos = r->tags[(tr + 1) % AUDIO_RING_TAGS].pos;
+    return ((int)(pos - end) > 0) ? end : pos;  /* tag written, PCM not yet */
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Audio Decode Thread
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Keeps the PCM ring full. Decodes under adec_mutex, which only a seek
+ * flush or track switch contends for (video decode has its own lock),
+ * so it blocks for those rather than polling; waits outside the lock
+ * for packets or for ring space.
+ *
+ * Runs at high priority: audio is the master clock, and with a 12-thread
+ * HEVC decoder saturating the cores, a lossless track must still win the
+ * scheduler when its ring runs low. What it takes from video is the one
+ * core it occupies while decoding (TrueHD costs most; --bench-audio
+ * measures it). It shares no lock with video decode, so a long MLP
+ * burst does not hold the video decoder up. */
+int audio_decode_thread_func(void *arg) {
+    PlayerState *ps = (PlayerState *)arg;
+    if (!SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_HIGH))
+        log_msg("Audio decode thread: high priority unavailable (%s)", SDL_GetError());
+    log_msg("Audio decode thread started");
+
+    while (!ps->quit) {
+        SDL_LockMutex(ps->adec_mutex);
+        if (!ps->audio_codec_ctx || !ps->audio_ring.buf) {
+            SDL_UnlockMutex(ps->adec_mutex);
+            SDL_Delay(10);
+            continue;
+        }
+
+        int starved = 0;
+        if (ps->audio_buf_index >= ps->audio_buf_size) {
+            double t0 = get_time_sec();
+            int decoded = ps->bitstream_active ? bitstream_fill(ps)
+                                               : audio_decode_frame(ps);
+            ps->diag_audio_decode_sec += get_time_sec() - t0;
+            if (decoded > 0) {
+                ps->audio_buf_size  = decoded;
+                ps->audio_buf_index = 0;
+            } else {
+                starved = 1;
+            }
+        }
+        int pushed = starved ? 0 : audio_ring_push(ps);
+        SDL_UnlockMutex(ps->adec_mutex);
+
+        if (starved)
+            pq_wait(&ps->audio_pq, 10);
+        else if (pushed == 0)
+            SDL_WaitSemaphoreTimeout(ps->audio_space, 10);  /* ring full */
+    }
+
+    log_msg("Audio decode thread exiting");
+    return 0;
+}
+
+
 /* ═══════════════════════════════════════════════════════════════════
  * SDL3 Audio Stream Callback
  * ═══════════════════════════════════════════════════════════════════ */
@@ -124,71 +585,85 @@ int audio_decode_frame(PlayerState *ps) {
 void SDLCALL audio_callback(void *userdata, SDL_AudioStream *stream,
                              int additional_amount, int total_amount) {
     PlayerState *ps = (PlayerState *)userdata;
+    AudioRing   *r  = &ps->audio_ring;
     (void)total_amount;
 
     if (ps->paused || ps->seek_request || ps->seeking) return;
-    if (additional_amount <= 0) return;
-
-    int written = 0;
-    while (written < additional_amount) {
-        if (ps->audio_buf_index >= ps->audio_buf_size) {
-            int decoded = audio_decode_frame(ps);
-            if (decoded <= 0) break;
-            ps->audio_buf_size  = decoded;
-            ps->audio_buf_index = 0;
+    if (additional_amount <= 0 || !r->buf) return;
+
+    int      frame_bytes = r->frame_bytes;
+    unsigned rd = (unsigned)SDL_GetAtomicInt(&r->rpos);
+    unsigned w  = (unsigned)SDL_GetAtomicInt(&r->wpos);
+
+    /* ── Post-seek / post-switch stale PCM skip ──
+     * After a seek, audio decoded from the keyframe onwards sits in the
+     * ring before the first video frame is shown: drop what is more than
+     * 50ms before the recovery point (see audio_decode_frame). In
+     * passthrough the skip
+     * is rounded up to whole bursts — a cut burst is noise to the
+     * receiver. */
+    while (r->floor > 0.0 && rd != w) {
+        double pts;
+        double limit = r->floor - r->floor_slack;
+        if (!audio_ring_pts(r, rd, &pts) || pts >= limit) {
+            r->floor = 0.0;
+            break;
         }
+        unsigned skip = (unsigned)((limit - pts) * r->freq) + 1;
+        if (r->align > 1)
+            skip = (skip + r->align - 1) / r->align * r->align;
+        unsigned seg  = audio_ring_segment_end(r, w) - rd;
+        rd += skip < seg ? skip : seg;
+    }
 
-        int remaining = ps->audio_buf_size - ps->audio_buf_index;
-        int to_push   = additional_amount - written;
-        if (to_push > remaining) to_push = remaining;
-
-        SDL_PutAudioStreamData(stream,
-            ps->audio_buf + ps->audio_buf_index, to_push);
-
-        written             += to_push;
-        ps->audio_buf_index += to_push;
+    /* ── Copy out: at most two pieces (wrap) ── */
+    unsigned n = w - rd;
+    unsigned want = (unsigned)((additional_amount + frame_bytes - 1) / frame_bytes);
+    if (n > want) n = want;
+    if (n > 0) {
+        unsigned off   = rd & r->mask;
+        unsigned first = r->capacity - off;
+        if (first > n) first = n;
+        SDL_PutAudioStreamData(stream, r->buf + (size_t)off * frame_bytes,
+                               (int)(first * frame_bytes));
+        if (n > first)
+            SDL_PutAudioStreamData(stream, r->buf,
+                                   (int)((n - first) * frame_bytes));
+        rd += n;
     }
+    if (n < want && r->floor == 0.0 && !ps->seek_recovering)
+        ps->diag_audio_underruns++;
+    SDL_SetAtomicInt(&r->rpos, (int)rd);
+    if (ps->audio_space) SDL_SignalSemaphore(ps->audio_space);
 
     /* ── Audio clock sync snapshot ──
      *
-     * audio_clock reflects the PTS at the END of the last decoded frame.
-     * But audio_decode_frame() updates audio_clock multiple times during
-     * the callback (line 70: set PTS, line 72: += samples, loop repeats).
-     * The main thread reads audio_clock for A/V sync at arbitrary times.
+     * The decode thread runs up to AUDIO_RING_MS ahead, so its
+     * audio_clock says nothing about what is audible. The PTS tag at the
+     * ring read position is exact: it is the first sample SDL has not
+     * been given yet. Subtract what SDL still holds (pushed but not yet
+     * played by the device) to get the playback position.
      *
-     * If the main thread reads DURING this callback, it sees the raw
-     * decode position (too far ahead) instead of the corrected playback
-     * position.  This data race causes audio_clock to appear ~20-40ms
-     * ahead, making av_diff chronically negative and locking 60fps
-     * content into a two-decode-per-VSync equilibrium.
-     *
-     * Fix: compute the corrected value ONCE at the end of the callback
-     * and write it to audio_clock_sync.  The main thread reads ONLY
-     * audio_clock_sync, which always has the full correction applied.
+     * The main thread reads ONLY audio_clock_sync, written once here.
      *
      * CRITICAL: Cap the correction at 100ms to prevent FLAC/large-buffer
      * runaway where SDL reports huge queued amounts during startup. */
+    double pts;
+    if (!audio_ring_pts(r, rd, &pts)) return;
     if (ps->audio_spec.freq > 0 && !ps->seek_recovering) {
-        int bytes_per_sample = 2 * 4;  /* F32 stereo */
-
-        /* Our internal buffer: decoded but not yet pushed to SDL */
-        int internal_pending = ps->audio_buf_size - ps->audio_buf_index;
-        if (internal_pending < 0) internal_pending = 0;
-
-        /* SDL stream pipeline: pushed but not yet played by device */
         int stream_pending = SDL_GetAudioStreamQueued(stream);
         if (stream_pending < 0) stream_pending = 0;
 
-        double buffered_sec = (double)(internal_pending + stream_pending)
-                            / (ps->audio_spec.freq * bytes_per_sample);
+        double buffered_sec = (double)stream_pending
+                            / (ps->audio_spec.freq * frame_bytes);
 
         /* Cap at 100ms — prevents FLAC/large-buffer runaway */
         if (buffered_sec > 0.1) buffered_sec = 0.1;
 
         /* Single atomic write — main thread reads only this field */
-        ps->audio_clock_sync = ps->audio_clock - buffered_sec;
+        ps->audio_clock_sync = pts - buffered_sec;
     } else {
-        ps->audio_clock_sync = ps->audio_clock;
+        ps->audio_clock_sync = pts;
     }
 }
 
@@ -197,38 +672,93 @@ void SDLCALL audio_callback(void *userdata, SDL_AudioStream *stream,
  * Open / Close Audio Device
  * ═══════════════════════════════════════════════════════════════════ */
 
+static SDL_AudioStream *audio_open_stream(PlayerState *ps, const SDL_AudioSpec *spec) {
+    if (ps->bench_audio) {
+        /* --bench-audio: unbound stream, drained by SDL_GetAudioStreamData
+         * (which runs audio_callback) at the video's pace */
+        SDL_AudioStream *s = SDL_CreateAudioStream(spec, spec);
+        if (s) SDL_SetAudioStreamGetCallback(s, audio_callback, ps);
+        return s;
+    }
+    return SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
+                                     spec, audio_callback, ps);
+}
+
 int audio_open(PlayerState *ps) {
     if (!ps->audio_codec_ctx) return -1;
 
     SDL_AudioSpec spec;
     SDL_zero(spec);
-    spec.format   = SDL_AUDIO_F32;    // was SDL_AUDIO_S16
-    spec.channels = 2;
-    spec.freq     = ps->audio_codec_ctx->sample_rate;
 
-    ps->audio_stream = SDL_OpenAudioDeviceStream(
-        SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
-        &spec, audio_callback, ps);
+    /* ── Passthrough: IEC 61937 bursts as S16 at the carrier rate ──
+     * Falls back to PCM if the device refuses the carrier format. */
+    int passthrough = (bitstream_open(ps) == 0);
+    if (passthrough) {
+        spec.format   = SDL_AUDIO_S16LE;
+        spec.channels = ps->spdif.channels;
+        spec.freq     = ps->spdif.rate;
+        ps->audio_stream = audio_open_stream(ps, &spec);
+        if (!ps->audio_stream) {
+            log_msg("Bitstream: device refused %d Hz %d ch S16 (%s), decoding to PCM",
+                    spec.freq, spec.channels, SDL_GetError());
+            bitstream_close(ps);
+            passthrough = 0;
+        } else if (bitstream_pin_channels(ps->audio_stream) < 0) {
+            log_msg("Bitstream: cannot keep the %d ch burst order (%s), decoding to PCM",
+                    spec.channels, SDL_GetError());
+            SDL_DestroyAudioStream(ps->audio_stream);
+            ps->audio_stream = NULL;
+            bitstream_close(ps);
+            passthrough = 0;
+        }
+    }
+
+    if (!passthrough) {
+        const AVChannelLayout *src = &ps->audio_codec_ctx->ch_layout;
+        spec.format   = SDL_AUDIO_F32;    // was SDL_AUDIO_S16
+        spec.channels = audio_pick_channels(src->nb_channels > 0 ? src->nb_channels : 2);
+        spec.freq     = ps->audio_codec_ctx->sample_rate;
+        av_channel_layout_uninit(&ps->audio_out_layout);
+        audio_sdl_layout(&ps->audio_out_layout, spec.channels, src);
+        ps->audio_stream = audio_open_stream(ps, &spec);
+    }
 
     if (!ps->audio_stream) {
         log_msg("ERROR: SDL_OpenAudioDeviceStream failed: %s", SDL_GetError());
         return -1;
     }
 
-    ps->audio_spec = spec;
+    ps->audio_spec       = spec;
+    ps->bitstream_active = passthrough;
 
     ps->audio_buf       = av_malloc(AUDIO_BUF_SIZE);
     ps->audio_buf_size  = 0;
     ps->audio_buf_index = 0;
 
-    SDL_SetAudioStreamGain(ps->audio_stream, ps->volume);
+    /* Bursts cost nothing to produce: no lossless decode to ride out */
+    int ring_ms = passthrough ? AUDIO_RING_MS : audio_ring_ms(ps->audio_codec_ctx);
+    if (audio_ring_init(&ps->audio_ring, spec.freq, SDL_AUDIO_FRAMESIZE(spec),
+                        ring_ms) < 0) {
+        log_msg("ERROR: Cannot allocate audio PCM ring");
+        SDL_DestroyAudioStream(ps->audio_stream);
+        ps->audio_stream = NULL;
+        bitstream_close(ps);
+        ps->bitstream_active = 0;
+        return -1;
+    }
+
+    /* Bursts must reach the device bit-exact: unity gain, volume is the
+     * receiver's job */
+    SDL_SetAudioStreamGain(ps->audio_stream, passthrough ? 1.0f : ps->volume);
     /* Audio device starts paused. Resume is deferred until the first
      * video frame is displayed (seek_recovering gate in main.c).
      * This prevents audio from running ahead during initial decode latency. */
 
-    log_msg("Audio opened: %s %d Hz, %d ch (SDL3 stream)",
-        (spec.format == SDL_AUDIO_F32) ? "F32" : "S16",
-        spec.freq, spec.channels);
+    log_msg("Audio opened: %s %d Hz, %d ch (SDL3 stream, %u-frame ring%s)",
+        passthrough ? "IEC 61937" : (spec.format == SDL_AUDIO_F32) ? "F32" : "S16",
+        spec.freq, spec.channels, ps->audio_ring.capacity,
+        passthrough ? ", passthrough" :
+        audio_is_lossless(ps->audio_codec_ctx) ? ", lossless" : "");
     return 0;
 }
 
@@ -237,6 +767,10 @@ void audio_close(PlayerState *ps) {
         SDL_DestroyAudioStream(ps->audio_stream);
         ps->audio_stream = NULL;
     }
+    audio_ring_free(&ps->audio_ring);
+    av_channel_layout_uninit(&ps->audio_mix_in);
+    bitstream_close(ps);
+    ps->bitstream_active = 0;
 }
 
 
@@ -304,6 +838,39 @@ void audio_find_streams(PlayerState *ps) {
  * Audio Track Cycling
  * ═══════════════════════════════════════════════════════════════════ */
 
+/* Open a decoder for catalog entry `sel`. Returns NULL on failure. */
+static AVCodecContext *audio_open_track(PlayerState *ps, int sel) {
+    AVStream *as = ps->fmt_ctx->streams[ps->aud_stream_indices[sel]];
+    const AVCodec *codec = avcodec_find_decoder(as->codecpar->codec_id);
+    if (!codec) {
+        log_msg("ERROR: No decoder for audio codec %s",
+            avcodec_get_name(as->codecpar->codec_id));
+        return NULL;
+    }
+
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    if (!ctx) return NULL;
+    avcodec_parameters_to_context(ctx, as->codecpar);
+    ctx->thread_count = 0;
+
+    int ret = avcodec_open2(ctx, codec, NULL);
+    if (ret < 0) {
+        log_msg("ERROR: Cannot open audio codec: %s", av_err2str(ret));
+        avcodec_free_context(&ctx);
+    }
+    return ctx;
+}
+
+/* Switch to the next cataloged audio track.
+ *
+ * Fast path — same sample rate, channel count and ring size, PCM on both
+ * sides: the new decoder is opened here and handed to the demux thread,
+ * which primes it from the track's alt packet ring and splices at the
+ * current playback PTS. No seek, no device pause; video is untouched
+ * (player.c, demux_switch_audio).
+ *
+ * Slow path — the output stream must be reopened: pause, swap the codec,
+ * reopen and seek back to the current position. */
 void audio_cycle(PlayerState *ps) {
     if (ps->aud_count <= 1) {
         snprintf(ps->aud_osd, sizeof(ps->aud_osd),
@@ -312,36 +879,60 @@ void audio_cycle(PlayerState *ps) {
         return;
     }
 
+    /* Previous switch still being spliced — ignore the key press */
+    if (SDL_GetAtomicInt(&ps->aud_switch_request)) return;
+    double t_press = get_time_sec();
+
+    /* Decoder swapped out by the last fast switch (main thread owns it
+     * again once the request is cleared) */
+    if (ps->aud_switch_ctx)
+        avcodec_free_context(&ps->aud_switch_ctx);
+
     int new_sel = (ps->aud_selection + 1) % ps->aud_count;
+    int new_stream_idx = ps->aud_stream_indices[new_sel];
 
-    /* Skip TrueHD tracks — unusable without HDMI bitstreaming */
-    int checked = 0;
-    while (checked < ps->aud_count) {
-        int idx = ps->aud_stream_indices[new_sel];
-        AVStream *st = ps->fmt_ctx->streams[idx];
-        if (st->codecpar->codec_id != AV_CODEC_ID_TRUEHD)
-            break;
-        log_msg("Audio: skipping TrueHD track %d (%s)",
-            new_sel, ps->aud_stream_names[new_sel]);
-        new_sel = (new_sel + 1) % ps->aud_count;
-        checked++;
-    }
-    if (checked >= ps->aud_count || new_sel == ps->aud_selection) {
-        /* All other tracks are TrueHD — stay on current */
-        snprintf(ps->aud_osd, sizeof(ps->aud_osd),
-            "No other non-TrueHD audio tracks");
+    log_msg("Audio: switching to %s (stream %d)",
+        ps->aud_stream_names[new_sel], new_stream_idx);
+
+    AVCodecContext *ctx = audio_open_track(ps, new_sel);
+    if (!ctx) {
+        snprintf(ps->aud_osd, sizeof(ps->aud_osd), "Audio: codec error");
         ps->aud_osd_until = get_time_sec() + 2.0;
         return;
     }
 
-    int new_stream_idx = ps->aud_stream_indices[new_sel];
+    snprintf(ps->aud_osd, sizeof(ps->aud_osd), "Audio: %s",
+        ps->aud_stream_names[new_sel]);
+    ps->aud_osd_until = get_time_sec() + 2.0;
 
-    log_msg("Audio: switching to %s (stream %d)",
-        ps->aud_stream_names[new_sel], new_stream_idx);
+    int new_rate = ctx->sample_rate;
+    unsigned ring_want = (unsigned)((int64_t)new_rate * audio_ring_ms(ctx) / 1000);
+    int same_output = ps->audio_stream && ps->audio_ring.buf &&
+                      !ps->bitstream_active && !bitstream_wanted(ps, new_sel) &&
+                      new_rate == ps->audio_spec.freq &&
+                      audio_pick_channels(ctx->ch_layout.nb_channels) ==
+                          ps->audio_spec.channels &&
+                      ring_want <= ps->audio_ring.capacity &&
+                      ring_want * 2 > ps->audio_ring.capacity;
+
+    /* ── Fast path: splice in the demux thread ── */
+    if (same_output) {
+        ps->aud_switch_time = t_press;
+        ps->aud_switch_ctx = ctx;
+        ps->aud_switch_sel = new_sel;
+        SDL_SetAtomicInt(&ps->aud_switch_request, 1);
+        demux_wake(ps);
+        return;
+    }
 
+    /* ── Slow path: reopen the output stream and seek ── */
     if (ps->audio_stream)
         SDL_PauseAudioStreamDevice(ps->audio_stream);
 
+    /* Keep the audio decode thread out while the codec is swapped
+     * (seek_mutex first: lock order, and no demux seek mid-swap) */
+    SDL_LockMutex(ps->seek_mutex);
+    SDL_LockMutex(ps->adec_mutex);
     pq_flush(&ps->audio_pq);
 
     if (ps->audio_codec_ctx)
@@ -349,56 +940,36 @@ void audio_cycle(PlayerState *ps) {
     if (ps->swr_ctx)
         swr_free(&ps->swr_ctx);
 
-    ps->audio_buf_size  = 0;
-    ps->audio_buf_index = 0;
+    audio_ring_reset(ps);
+    ps->audio_codec_ctx = ctx;
 
-    AVStream *as = ps->fmt_ctx->streams[new_stream_idx];
-    const AVCodec *codec = avcodec_find_decoder(as->codecpar->codec_id);
-    if (!codec) {
-        log_msg("ERROR: No decoder for audio codec %s",
-            avcodec_get_name(as->codecpar->codec_id));
-        snprintf(ps->aud_osd, sizeof(ps->aud_osd), "Audio: codec error");
-        ps->aud_osd_until = get_time_sec() + 2.0;
-        return;
-    }
-
-    ps->audio_codec_ctx = avcodec_alloc_context3(codec);
-    avcodec_parameters_to_context(ps->audio_codec_ctx, as->codecpar);
-    ps->audio_codec_ctx->thread_count = 0;
-
-    int ret = avcodec_open2(ps->audio_codec_ctx, codec, NULL);
-    if (ret < 0) {
-        log_msg("ERROR: Cannot open audio codec: %s", av_err2str(ret));
-        avcodec_free_context(&ps->audio_codec_ctx);
-        snprintf(ps->aud_osd, sizeof(ps->aud_osd), "Audio: codec error");
-        ps->aud_osd_until = get_time_sec() + 2.0;
-        return;
-    }
-
-    int new_rate = ps->audio_codec_ctx->sample_rate;
-    if (new_rate != ps->audio_spec.freq) {
+    if (ps->bitstream_active || bitstream_wanted(ps, new_sel)) {
+        log_msg("Audio: passthrough track change, reopening stream");
+    } else if (new_rate != ps->audio_spec.freq) {
         log_msg("Audio: sample rate changed %d -> %d, reopening stream",
             ps->audio_spec.freq, new_rate);
-        audio_close(ps);
-        audio_open(ps);
+    } else {
+        log_msg("Audio: %s track, resizing PCM ring",
+            audio_is_lossless(ctx) ? "lossless" : "lossy");
     }
-
+    /* audio_open() picks passthrough from the new stream index */
     ps->aud_selection    = new_sel;
     ps->audio_stream_idx = new_stream_idx;
+    audio_close(ps);
+    audio_open(ps);
+    SDL_UnlockMutex(ps->adec_mutex);
+    SDL_UnlockMutex(ps->seek_mutex);
 
     log_msg("Audio: now playing %s (%s %dHz)",
-        ps->aud_stream_names[new_sel], codec->name, new_rate);
+        ps->aud_stream_names[new_sel], ctx->codec->name, new_rate);
 
     double pos = ps->audio_clock_sync;
     if (pos < 0.1) pos = 0.1;
     ps->seek_target  = (int64_t)(pos * AV_TIME_BASE);
     ps->seek_flags   = AVSEEK_FLAG_BACKWARD;
     ps->seek_request = 1;
+    demux_wake(ps);
 
     if (ps->audio_stream && !ps->paused)
         SDL_ResumeAudioStreamDevice(ps->audio_stream);
-
-    snprintf(ps->aud_osd, sizeof(ps->aud_osd), "Audio: %s",
-        ps->aud_stream_names[new_sel]);
-    ps->aud_osd_until = get_time_sec() + 2.0;
 }
@@ -0,0 +1,1228 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * bench.c — Decode-only benchmark (--bench-decode), audio-load
+ *           benchmark (--bench-audio), decoder thread calibration
+ *           (--calibrate) and CPU histogram, overlay blend and
+ *           downmix microbenchmarks (--bench-hist, --bench-blend,
+ *           --bench-downmix)
+ *
+ * Runs the real playback pipeline minus presentation: player_open()
+ * starts the demux thread and the video decode thread exactly as in
+ * windowed mode, and this file drains the frame queue as fast as it
+ * fills. No GPU device, no audio, no A/V clock.
+ *
+ * The sweep re-opens the file once per decoder configuration:
+ *   - "default": the thread caps player_open() applies in normal playback
+ *   - frame threading at 1, 2, 4, ... threads up to the core count
+ *   - slice threading at the same counts
+ *
+ * For each run it reports:
+ *   fps       sustained decode rate, first frame excluded
+ *   fill_ms   pipeline-fill latency: open → first decoded frame
+ *   rss_mb    peak resident set growth over the run's own baseline
+ *             (sampled per frame; freed heap is trimmed back to the OS
+ *             before each open, so runs do not inherit earlier peaks)
+ *
+ * Results go to stdout as one table row per configuration.
+ *
+ * The same runs drive the per-machine decoder thread calibration that
+ * player_open() consults (see Decoder Calibration below).
+ */
+
+#include "dsvp.h"
+
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #include <windows.h>
+  #include <psapi.h>
+#elif defined(__APPLE__)
+  #include <mach/mach.h>
+#else
+  #include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+  #include <malloc.h>
+#endif
+
+/* Frames decoded per configuration when --frames is not given */
+#define BENCH_DEFAULT_FRAMES  600
+
+/* Thread counts tried: powers of two and the common core-count
+ * midpoints, clipped to the machine's logical core count. */
+static const int bench_counts[] = { 1, 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+#define BENCH_NUM_COUNTS ((int)(sizeof(bench_counts) / sizeof(bench_counts[0])))
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Helpers
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Current resident set size in bytes, 0 if unavailable. */
+static size_t bench_rss_bytes(void) {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return pmc.WorkingSetSize;
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  (task_info_t)&info, &count) == KERN_SUCCESS)
+        return info.resident_size;
+    return 0;
+#else
+    /* /proc/self/statm: size resident shared ... (in pages) */
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(f, "%lu %lu", &size, &resident);
+    fclose(f);
+    if (n != 2) return 0;
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/* Resident set before a run: give freed heap back to the OS first, so
+ * the previous configuration's frames and packets are not counted as
+ * resident again (and later reused unseen) by this one. */
+static size_t bench_rss_baseline(void) {
+#if defined(_WIN32)
+    SetProcessWorkingSetSize(GetCurrentProcess(), (SIZE_T)-1, (SIZE_T)-1);
+#elif defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+    return bench_rss_bytes();
+}
+
+static const char *bench_type_name(int type) {
+    switch (type) {
+    case FF_THREAD_FRAME:                   return "frame";
+    case FF_THREAD_SLICE:                   return "slice";
+    case FF_THREAD_FRAME | FF_THREAD_SLICE: return "frame+slice";
+    default:                                return "none";
+    }
+}
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Single Run
+ * ═══════════════════════════════════════════════════════════════════ */
+
+typedef struct BenchResult {
+    int    threads;         /* thread_count after avcodec_open2 */
+    int    active_type;     /* FF_THREAD_* the decoder actually uses */
+    int    frames;
+    double fps;
+    double fill_ms;
+    double rss_mb;          /* peak RSS growth over the pre-open baseline */
+    int    underruns;       /* audio callbacks the PCM ring could not fill */
+    double adec_pct;        /* audio decode time, % of one core */
+} BenchResult;
+
+/* --bench-audio: pull PCM through the audio callback until the audio
+ * position reaches `pts`, so audio is decoded for exactly the media time
+ * video has covered. Waits (bounded) while the audio decode thread is
+ * behind — that coupling is the cost being measured. Returns 0 once
+ * audio has ended (or stopped arriving), 1 otherwise. */
+static int bench_pull_audio(PlayerState *ps, double pts) {
+    float  scratch[4096];
+    double t_give_up = get_time_sec() + 2.0;
+    while (ps->audio_clock_sync < pts && !ps->quit) {
+        int got = SDL_GetAudioStreamData(ps->audio_stream, scratch, sizeof(scratch));
+        if (got > 0) continue;
+        if ((ps->eof && pq_nb_packets(&ps->audio_pq) == 0) ||
+            get_time_sec() > t_give_up)
+            return 0;  /* audio ended, or shorter than video */
+        SDL_Delay(1);
+    }
+    return 1;
+}
+
+/* Set to cut an idle-time calibration pass short (see calib_poll) */
+static SDL_AtomicInt s_calib_abort;
+
+/* Open `path` with the given decoder override (type 0 = default caps),
+ * decode up to max_frames and fill *r. A deadline > 0 (get_time_sec()
+ * clock) ends the run early with whatever frames it has, as does a
+ * cancelled calibration. Returns 0 on success. */
+static int bench_run_one(PlayerState *ps, const char *path,
+                         int threads, int type, int max_frames,
+                         double deadline, BenchResult *r)
+{
+    memset(r, 0, sizeof(*r));
+    ps->vdec_threads     = threads;
+    ps->vdec_thread_type = type;
+
+    size_t rss_base = bench_rss_baseline();
+    size_t rss_peak = rss_base;
+    double t_open = get_time_sec();
+    if (player_open(ps, path) != 0)
+        return -1;
+
+    r->threads     = ps->video_codec_ctx->thread_count;
+    r->active_type = ps->video_codec_ctx->active_thread_type;
+
+    /* --bench-audio: no first-frame gate, audio is pulled per frame */
+    int audio_live = ps->audio_stream != NULL;
+    if (audio_live)
+        ps->seek_recovering = 0;
+
+    double t_first = 0.0;
+    double t_last  = t_open;
+    while (r->frames < max_frames) {
+        if (deadline > 0.0 && get_time_sec() > deadline)
+            break;
+        if (SDL_GetAtomicInt(&s_calib_abort))
+            break;
+        if (!video_next_frame(ps)) {
+            if (ps->eof && ps->video_eof && ps->video_fq.count == 0 &&
+                pq_nb_packets(&ps->video_pq) == 0)
+                break;
+            SDL_Delay(1);
+            continue;
+        }
+        if (audio_live)
+            audio_live = bench_pull_audio(ps, ps->video_clock);
+        t_last = get_time_sec();
+        if (r->frames == 0) t_first = t_last;
+        r->frames++;
+
+        size_t rss = bench_rss_bytes();
+        if (rss > rss_peak) rss_peak = rss;
+    }
+
+    if (r->frames > 0)
+        r->fill_ms = (t_first - t_open) * 1000.0;
+    if (r->frames > 1 && t_last > t_first)
+        r->fps = (r->frames - 1) / (t_last - t_first);
+    r->rss_mb = (rss_peak - rss_base) / (1024.0 * 1024.0);
+    r->underruns = ps->diag_audio_underruns;
+    if (t_last > t_open)
+        r->adec_pct = 100.0 * ps->diag_audio_decode_sec / (t_last - t_open);
+
+    player_close(ps);
+    return 0;
+}
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Sweep
+ * ═══════════════════════════════════════════════════════════════════ */
+
+static void bench_print_row(const char *label, const BenchResult *r) {
+    printf("%-8s %7d  %-11s %7d %9.1f %9.1f %9.1f\n",
+           label, r->threads, bench_type_name(r->active_type),
+           r->frames, r->fps, r->fill_ms, r->rss_mb);
+    fflush(stdout);
+}
+
+/* Decode `path` under every thread configuration and print a table.
+ * Returns the process exit code: 0 on success. */
+int bench_decode_run(const char *path, int max_frames) {
+    if (max_frames <= 0) max_frames = BENCH_DEFAULT_FRAMES;
+    log_msg("Bench: %s (%d frames per run)", path, max_frames);
+
+    if (!SDL_Init(0)) {
+        fprintf(stderr, "[DSVP] SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    av_log_set_level(AV_LOG_ERROR);
+
+    /* No window, no GPU device, no audio: player_open skips textures
+     * and audio output, leaving demux + decode threads only. */
+    PlayerState *ps = calloc(1, sizeof(PlayerState));
+    if (!ps) {
+        SDL_Quit();
+        return 1;
+    }
+    ps->headless = 1;
+    ps->volume   = 1.00;
+    ps->video_stream_idx = -1;
+    ps->audio_stream_idx = -1;
+    ps->sub_active_idx   = -1;
+
+    int cores = SDL_GetNumLogicalCPUCores();
+    BenchResult r;
+
+    /* ── Baseline: normal playback policy ── */
+    if (bench_run_one(ps, path, 0, 0, max_frames, 0.0, &r) < 0) {
+        fprintf(stderr, "[DSVP] Failed to open: %s\n", path);
+        free(ps);
+        SDL_Quit();
+        return 1;
+    }
+
+    {
+        /* Describe the stream once, from a short-lived open */
+        AVFormatContext *fc = NULL;
+        const char *codec = "?";
+        int w = 0, h = 0;
+        const char *pix = "?";
+        if (avformat_open_input(&fc, path, NULL, NULL) == 0 &&
+            avformat_find_stream_info(fc, NULL) >= 0) {
+            int vi = av_find_best_stream(fc, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+            if (vi >= 0) {
+                AVCodecParameters *par = fc->streams[vi]->codecpar;
+                codec = avcodec_get_name(par->codec_id);
+                w = par->width;
+                h = par->height;
+                const char *pn = av_get_pix_fmt_name(par->format);
+                if (pn) pix = pn;
+            }
+        }
+        printf("bench-decode: %s\n", path);
+        printf("stream: %s %dx%d %s  cores=%d  frames/run=%d\n\n",
+               codec, w, h, pix, cores, max_frames);
+        if (fc) avformat_close_input(&fc);
+    }
+
+    printf("%-8s %7s  %-11s %7s %9s %9s %9s\n",
+           "mode", "threads", "active", "frames", "fps", "fill_ms", "rss_mb");
+    bench_print_row("default", &r);
+
+    /* ── Sweep: explicit counts for each threading type ──
+     * bench_counts up to the machine's logical core count (which is
+     * always included). */
+    const int types[2] = { FF_THREAD_FRAME, FF_THREAD_SLICE };
+
+    for (int t = 0; t < 2; t++) {
+        int last = 0;
+        for (int i = 0; i < BENCH_NUM_COUNTS; i++) {
+            int n = bench_counts[i];
+            if (n > cores) n = cores;
+            if (n <= last) break;
+            if (bench_run_one(ps, path, n, types[t], max_frames, 0.0, &r) < 0)
+                break;
+            bench_print_row(bench_type_name(types[t]), &r);
+            log_msg("Bench: %s threads=%d fps=%.1f fill=%.1fms rss=%.1fMB",
+                    bench_type_name(types[t]), n, r.fps, r.fill_ms, r.rss_mb);
+            last = n;
+        }
+    }
+
+    free(ps);
+    SDL_Quit();
+    return 0;
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Decoder Calibration (--calibrate, idle time after a first encounter)
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * The right decoder thread count depends on the machine as much as the
+ * stream: frame threading buys throughput with N frames of pipeline
+ * fill, and a 6-core and a 64-core box want very different N. Instead
+ * of fixed caps, each stream class is measured once per machine:
+ *
+ *   class   codec, resolution bucket, frame-rate bucket, bit depth and
+ *           the logical core count ("hevc 2160p60 10bit 16c")
+ *   need    content fps × CALIB_HEADROOM (audio decode, upload, seeks)
+ *   choice  the lowest pipeline fill that still sustains `need`; if
+ *           nothing does, the highest throughput
+ *
+ * Slice threading at the core count is tried first — it has no fill
+ * latency, so when it keeps up it wins outright. Otherwise frame
+ * threading is swept upward from 2 threads and stops at the first count
+ * that keeps up (fill only grows from there) or when another doubling
+ * stops paying (< 5% faster). The whole pass is capped at
+ * CALIB_BUDGET_SEC, checked per decoded frame: a run cut short by the
+ * deadline is scored on the frames it got.
+ *
+ * Playback never waits for a measurement. A first encounter opens with
+ * the default caps and queues its class; once the player has been idle
+ * or paused for CALIB_IDLE_SEC, a low-priority thread measures it, and
+ * the result applies from the next open of that class. Resuming
+ * playback cancels the pass, which is retried at the next idle spell.
+ *
+ * Results live in a small text file in the user's pref directory, one
+ * line per class. Delete it, or run --calibrate <file>, to re-measure.
+ */
+
+#define CALIB_FRAMES      90      /* frames per run (first excluded)     */
+#define CALIB_HEADROOM    1.5     /* decode fps needed per content fps   */
+#define CALIB_BUDGET_SEC  8.0     /* cap on one calibration pass         */
+#define CALIB_IDLE_SEC    3.0     /* idle/paused this long before a pass */
+#define CALIB_FILE        "decoder-threads.txt"
+
+/* Full path of the cache file, or NULL if there is no pref dir. */
+static char *calib_path(void) {
+    char *dir = SDL_GetPrefPath("dsvp", "dsvp");
+    if (!dir) return NULL;
+    size_t len = strlen(dir) + sizeof(CALIB_FILE);
+    char *path = malloc(len);
+    if (path) snprintf(path, len, "%s%s", dir, CALIB_FILE);
+    SDL_free(dir);
+    return path;
+}
+
+/* Stream class key for the video stream of fc. Returns the content
+ * frame rate (0 if unknown). */
+static double calib_key(AVFormatContext *fc, int vidx, char *key, int sz) {
+    AVStream *st = fc->streams[vidx];
+    AVCodecParameters *par = st->codecpar;
+    long px = (long)par->width * par->height;
+    const char *res = px <= 720L * 576   ? "sd"
+                    : px <= 1280L * 720  ? "720p"
+                    : px <= 1920L * 1088 ? "1080p"
+                    : px <= 2560L * 1440 ? "1440p"
+                    : px <= 4096L * 2160 ? "2160p"
+                                         : "4320p";
+    AVRational fr = av_guess_frame_rate(fc, st, NULL);
+    double fps = (fr.num > 0 && fr.den > 0) ? av_q2d(fr) : 0.0;
+    int rate = fps <= 0.0 ? 0 : fps <= 31.0 ? 30 : fps <= 61.0 ? 60 : 120;
+    const AVPixFmtDescriptor *d = av_pix_fmt_desc_get(par->format);
+    int depth = d ? d->comp[0].depth : 8;
+
+    snprintf(key, sz, "%s %s%d %dbit %dc", avcodec_get_name(par->codec_id),
+             res, rate, depth, SDL_GetNumLogicalCPUCores());
+    return fps;
+}
+
+/* Look key up in the cache. Returns 1 and fills threads/type on a hit. */
+static int calib_lookup(const char *key, int *threads, int *type) {
+    char *path = calib_path();
+    FILE *f = path ? fopen(path, "r") : NULL;
+    free(path);
+    if (!f) return 0;
+
+    char line[256];
+    size_t klen = strlen(key);
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || strncmp(line, key, klen) != 0 || line[klen] != '\t')
+            continue;
+        found = sscanf(line + klen + 1, "%d %d", threads, type) == 2
+             && *threads > 0 && *type > 0;
+    }
+    fclose(f);
+    return found;
+}
+
+/* Replace or append key's line. Other classes are kept as they are. */
+static void calib_store(const char *key, const BenchResult *r, int type) {
+    char *path = calib_path();
+    if (!path) return;
+
+    /* Small file: read it whole, drop the old line, write it back */
+    char  *keep = NULL;
+    size_t keep_len = 0, klen = strlen(key);
+    FILE *f = fopen(path, "r");
+    if (f) {
+        char line[256];
+        while (fgets(line, sizeof(line), f)) {
+            if (line[0] == '#' || (strncmp(line, key, klen) == 0 && line[klen] == '\t'))
+                continue;
+            size_t n = strlen(line);
+            char *grown = realloc(keep, keep_len + n + 1);
+            if (!grown) break;
+            keep = grown;
+            memcpy(keep + keep_len, line, n + 1);
+            keep_len += n;
+        }
+        fclose(f);
+    }
+
+    f = fopen(path, "w");
+    if (f) {
+        fprintf(f, "# dsvp decoder thread calibration: class<TAB>threads type fps fill_ms\n");
+        if (keep) fputs(keep, f);
+        fprintf(f, "%s\t%d %d %.1f %.1f\n", key, r->threads, type, r->fps, r->fill_ms);
+        fclose(f);
+    } else {
+        log_msg("Calibrate: cannot write %s", path);
+    }
+    free(keep);
+    free(path);
+}
+
+/* Measure path's class and pick a configuration. verbose prints each
+ * run as a bench table row. Returns 0 and fills *best/*best_type. */
+static int calib_measure(const char *path, double fps, int verbose,
+                         BenchResult *best, int *best_type)
+{
+    PlayerState *ps = calloc(1, sizeof(PlayerState));
+    if (!ps) return -1;
+    ps->headless = 1;
+    ps->volume   = 1.00;
+    ps->video_stream_idx = -1;
+    ps->audio_stream_idx = -1;
+    ps->sub_active_idx   = -1;
+
+    int    cores    = SDL_GetNumLogicalCPUCores();
+    double need     = (fps > 0.0 ? fps : 30.0) * CALIB_HEADROOM;
+    double deadline = get_time_sec() + CALIB_BUDGET_SEC;
+    BenchResult r, top;
+    int have = 0, top_type = 0;
+    memset(&top, 0, sizeof(top));
+
+    /* Slice threading: no pipeline fill at all */
+    if (bench_run_one(ps, path, cores, FF_THREAD_SLICE, CALIB_FRAMES, deadline, &r) == 0 &&
+        r.frames >= 2) {
+        if (verbose) bench_print_row("slice", &r);
+        top = r; top_type = FF_THREAD_SLICE; have = 1;
+        if (r.fps >= need) goto done;
+    }
+
+    /* Frame threading, upward until it keeps up or stops scaling */
+    double prev_fps = 0.0;
+    int last = 0;
+    for (int i = 1; i < BENCH_NUM_COUNTS && get_time_sec() < deadline &&
+                    !SDL_GetAtomicInt(&s_calib_abort); i++) {
+        int n = bench_counts[i] < cores ? bench_counts[i] : cores;
+        if (n <= last) break;
+        last = n;
+        if (bench_run_one(ps, path, n, FF_THREAD_FRAME, CALIB_FRAMES, deadline, &r) < 0 ||
+            r.frames < 2)
+            break;   /* failed, or the budget ran out before a rate */
+        if (verbose) bench_print_row("frame", &r);
+        if (r.fps >= need) {
+            top = r; top_type = FF_THREAD_FRAME; have = 1;
+            break;
+        }
+        if (!have || r.fps > top.fps) {
+            top = r; top_type = FF_THREAD_FRAME; have = 1;
+        }
+        if (prev_fps > 0.0 && r.fps < prev_fps * 1.05)
+            break;   /* saturated: more threads only add fill */
+        prev_fps = r.fps;
+    }
+
+done:
+    free(ps);
+    if (!have || SDL_GetAtomicInt(&s_calib_abort))
+        return -1;   /* nothing usable, or cancelled part-way */
+    *best = top;
+    *best_type = top_type;
+    log_msg("Calibrate: need %.1f fps -> %s x%d (%.1f fps, fill %.1fms)",
+            need, bench_type_name(top_type), top.threads, top.fps, top.fill_ms);
+    return 0;
+}
+
+/* One queued first-encounter class. Only the UI thread touches it,
+ * except the worker's result fields before `done` is set. */
+typedef struct CalibJob {
+    char          key[128];
+    char         *path;         /* NULL = nothing queued               */
+    double        fps;
+    SDL_Thread   *thread;       /* running pass, NULL if none          */
+    SDL_AtomicInt done;         /* worker finished, result below valid */
+    int           ok;
+    BenchResult   best;
+    int           type;
+    double        idle_since;   /* calib_poll: start of the idle spell */
+} CalibJob;
+
+static CalibJob s_calib;
+
+static int calib_thread_func(void *arg) {
+    CalibJob *job = (CalibJob *)arg;
+    SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+    job->ok = calib_measure(job->path, job->fps, 0, &job->best, &job->type) == 0;
+    SDL_SetAtomicInt(&job->done, 1);
+    return 0;
+}
+
+/* Queue key for an idle-time pass. One class at a time: a newer first
+ * encounter replaces a queued one, but not one being measured. */
+static void calib_defer(const char *key, const char *path, double fps) {
+    if (s_calib.path && (s_calib.thread || strcmp(s_calib.key, key) == 0))
+        return;
+    char *copy = strdup(path);
+    if (!copy) return;
+    free(s_calib.path);
+    s_calib.path = copy;
+    s_calib.fps  = fps;
+    snprintf(s_calib.key, sizeof(s_calib.key), "%s", key);
+    log_msg("Calibrate: first encounter of %s, default threads for now "
+            "(measured when idle)", key);
+}
+
+/* video_decoder_open() hook: decoder threads for stream vidx of fc from
+ * the cache. A new class is queued for an idle-time pass if measure is
+ * set (windowed playback — headless, bench and open-ahead runs just read
+ * the cache). Returns 1 and fills threads/type if a calibrated
+ * configuration applies. */
+int calib_decoder_threads(AVFormatContext *fc, int vidx, const char *path, int measure,
+                          int *threads, int *type)
+{
+    char key[128];
+    double fps = calib_key(fc, vidx, key, sizeof(key));
+
+    if (calib_lookup(key, threads, type)) {
+        log_msg("Calibrate: %s -> %s x%d (cached)", key, bench_type_name(*type), *threads);
+        return 1;
+    }
+    if (measure)
+        calib_defer(key, path, fps);
+    return 0;
+}
+
+/* player_open() hook for an adopted open-ahead decoder, which only read
+ * the cache: queue its class if it is still new. */
+void calib_queue(AVFormatContext *fc, int vidx, const char *path) {
+    char key[128];
+    int threads, type;
+    double fps = calib_key(fc, vidx, key, sizeof(key));
+    if (!calib_lookup(key, &threads, &type))
+        calib_defer(key, path, fps);
+}
+
+/* Main loop, once per iteration: run the queued class while the player
+ * is idle (nothing open, or paused), cancel it when playback resumes,
+ * and store the result once the pass is done. Cheap when nothing is
+ * queued. */
+void calib_poll(int idle, double now) {
+    CalibJob *job = &s_calib;
+
+    if (job->thread) {
+        if (!SDL_GetAtomicInt(&job->done)) {
+            if (!idle && !SDL_GetAtomicInt(&s_calib_abort)) {
+                SDL_SetAtomicInt(&s_calib_abort, 1);
+                log_msg("Calibrate: %s cancelled, playback resumed", job->key);
+            }
+            return;
+        }
+        SDL_WaitThread(job->thread, NULL);
+        job->thread = NULL;
+        job->idle_since = 0.0;
+        if (SDL_GetAtomicInt(&s_calib_abort)) {
+            SDL_SetAtomicInt(&s_calib_abort, 0);
+            return;   /* still queued: retried at the next idle spell */
+        }
+        if (job->ok) {
+            calib_store(job->key, &job->best, job->type);
+            log_msg("Calibrate: %s stored, applies from the next open", job->key);
+        }
+        free(job->path);
+        job->path = NULL;
+        return;
+    }
+
+    if (!job->path || !idle) {
+        job->idle_since = 0.0;
+        return;
+    }
+    if (job->idle_since <= 0.0)
+        job->idle_since = now;
+    if (now - job->idle_since < CALIB_IDLE_SEC)
+        return;
+
+    SDL_SetAtomicInt(&job->done, 0);
+    job->thread = SDL_CreateThread(calib_thread_func, "calibrate", job);
+    if (job->thread)
+        log_msg("Calibrate: measuring %s", job->key);
+}
+
+/* Shutdown: cancel a running pass and drop the queued class. */
+void calib_shutdown(void) {
+    if (s_calib.thread) {
+        SDL_SetAtomicInt(&s_calib_abort, 1);
+        SDL_WaitThread(s_calib.thread, NULL);
+        s_calib.thread = NULL;
+        SDL_SetAtomicInt(&s_calib_abort, 0);
+    }
+    free(s_calib.path);
+    s_calib.path = NULL;
+}
+
+/* --calibrate: re-measure path's class now and update the cache.
+ * Returns the process exit code: 0 on success. */
+int bench_calibrate_run(const char *path) {
+    if (!SDL_Init(0)) {
+        fprintf(stderr, "[DSVP] SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    av_log_set_level(AV_LOG_ERROR);
+
+    AVFormatContext *fc = NULL;
+    int vi = -1;
+    if (avformat_open_input(&fc, path, NULL, NULL) == 0 &&
+        avformat_find_stream_info(fc, NULL) >= 0)
+        vi = av_find_best_stream(fc, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (vi < 0) {
+        fprintf(stderr, "[DSVP] No video stream: %s\n", path);
+        if (fc) avformat_close_input(&fc);
+        SDL_Quit();
+        return 1;
+    }
+    char key[128];
+    double fps = calib_key(fc, vi, key, sizeof(key));
+    avformat_close_input(&fc);
+
+    printf("calibrate: %s\n", path);
+    printf("class: %s  content=%.3f fps  need=%.1f fps\n\n",
+           key, fps, (fps > 0.0 ? fps : 30.0) * CALIB_HEADROOM);
+    printf("%-8s %7s  %-11s %7s %9s %9s %9s\n",
+           "mode", "threads", "active", "frames", "fps", "fill_ms", "rss_mb");
+
+    BenchResult best;
+    int type = 0;
+    int rc = 1;
+    if (calib_measure(path, fps, 1, &best, &type) == 0) {
+        calib_store(key, &best, type);
+        printf("\nchosen: %s x%d (%.1f fps, fill %.1f ms)\n",
+               bench_type_name(type), best.threads, best.fps, best.fill_ms);
+        rc = 0;
+    }
+    SDL_Quit();
+    return rc;
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Audio Load (--bench-audio)
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Video decode fps with each audio track of the file decoded alongside,
+ * against a run with no audio at all — the cost a track (TrueHD,
+ * DTS-HD MA) imposes on the video pipeline. The audio stream is not
+ * bound to a device: after each video frame the bench pulls PCM through
+ * audio_callback() up to that frame's PTS, so both decoders cover the
+ * same media time at whatever speed video reaches under default thread
+ * caps. Underruns count pulls the PCM ring could not satisfy (audio
+ * decode falling behind video).
+ */
+
+/* Returns the process exit code: 0 on success. */
+int bench_audio_run(const char *path, int max_frames) {
+    if (max_frames <= 0) max_frames = BENCH_DEFAULT_FRAMES;
+    log_msg("Bench audio: %s (%d frames per run)", path, max_frames);
+
+    /* No output device is opened; the dummy driver just keeps audio
+     * init from touching real hardware. */
+    SDL_SetHint(SDL_HINT_AUDIO_DRIVER, "dummy");
+    if (!SDL_Init(SDL_INIT_AUDIO)) {
+        fprintf(stderr, "[DSVP] SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    av_log_set_level(AV_LOG_ERROR);
+
+    /* Catalog the audio tracks from a short-lived open */
+    int  tracks[MAX_AUDIO_STREAMS];
+    char names[MAX_AUDIO_STREAMS][64];
+    int  ntracks = 0;
+    {
+        AVFormatContext *fc = NULL;
+        if (avformat_open_input(&fc, path, NULL, NULL) < 0 ||
+            avformat_find_stream_info(fc, NULL) < 0) {
+            fprintf(stderr, "[DSVP] Failed to open: %s\n", path);
+            if (fc) avformat_close_input(&fc);
+            SDL_Quit();
+            return 1;
+        }
+        for (unsigned i = 0; i < fc->nb_streams && ntracks < MAX_AUDIO_STREAMS; i++) {
+            AVCodecParameters *par = fc->streams[i]->codecpar;
+            if (par->codec_type != AVMEDIA_TYPE_AUDIO) continue;
+            const char *prof = avcodec_profile_name(par->codec_id, par->profile);
+            snprintf(names[ntracks], sizeof(names[ntracks]), "%s%s%s %dch",
+                     avcodec_get_name(par->codec_id),
+                     prof ? "/" : "", prof ? prof : "",
+                     par->ch_layout.nb_channels);
+            tracks[ntracks++] = (int)i;
+        }
+        avformat_close_input(&fc);
+    }
+
+    PlayerState *ps = calloc(1, sizeof(PlayerState));
+    if (!ps) {
+        SDL_Quit();
+        return 1;
+    }
+    ps->headless    = 1;
+    ps->bench_audio = 1;
+    ps->volume      = 1.00;
+    ps->video_stream_idx = -1;
+    ps->audio_stream_idx = -1;
+    ps->sub_active_idx   = -1;
+
+    printf("bench-audio: %s\n", path);
+    printf("audio tracks=%d  cores=%d  frames/run=%d\n\n",
+           ntracks, SDL_GetNumLogicalCPUCores(), max_frames);
+    printf("%-28s %7s %9s %8s %9s %9s\n",
+           "audio", "frames", "fps", "vs_none", "adec_cpu", "underruns");
+
+    BenchResult base, r;
+    ps->bench_audio_stream = -1;
+    if (bench_run_one(ps, path, 0, 0, max_frames, 0.0, &base) < 0) {
+        fprintf(stderr, "[DSVP] Failed to open: %s\n", path);
+        free(ps);
+        SDL_Quit();
+        return 1;
+    }
+    printf("%-28s %7d %9.1f %7s %9s %9s\n",
+           "none", base.frames, base.fps, "-", "-", "-");
+    fflush(stdout);
+
+    for (int t = 0; t < ntracks; t++) {
+        ps->bench_audio_stream = tracks[t];
+        if (bench_run_one(ps, path, 0, 0, max_frames, 0.0, &r) < 0)
+            continue;
+        char label[80];
+        snprintf(label, sizeof(label), "[%d] %s", tracks[t], names[t]);
+        printf("%-28.28s %7d %9.1f %7.1f%% %8.1f%% %9d\n",
+               label, r.frames, r.fps,
+               base.fps > 0.0 ? 100.0 * (r.fps - base.fps) / base.fps : 0.0,
+               r.adec_pct, r.underruns);
+        fflush(stdout);
+        log_msg("Bench audio: %s fps=%.1f (none: %.1f) adec=%.1f%% underruns=%d",
+                label, r.fps, base.fps, r.adec_pct, r.underruns);
+    }
+
+    free(ps);
+    SDL_Quit();
+    return 0;
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Histogram Microbenchmark (--bench-hist)
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Times every histogram kernel this CPU can run on synthetic 4K luma
+ * planes, 8-bit and 10-bit, for two contents:
+ *   noise — uniform random codes (spread bins, cache-friendly counters)
+ *   flat  — 90% one code + gradient (hot bins, store-to-load stalls)
+ * Each kernel's histogram is checked against the scalar one. The old
+ * 1/16-subsampled scalar scan is timed as the reference cost.
+ */
+
+#define BENCH_HIST_W  3840
+#define BENCH_HIST_H  2160
+
+/* The pre-SIMD loop: every 4th row and column, one counter table. */
+static void bench_hist_subsampled(const uint8_t *data, int stride, int w, int h,
+                                  int is_10bit, uint32_t hist[256])
+{
+    memset(hist, 0, 256 * sizeof(uint32_t));
+    for (int y = 0; y < h; y += 4) {
+        if (is_10bit) {
+            const uint16_t *row = (const uint16_t *)(data + (size_t)y * stride);
+            for (int x = 0; x < w; x += 4) {
+                unsigned bin = row[x] >> 2;
+                hist[bin > 255 ? 255 : bin]++;
+            }
+        } else {
+            const uint8_t *row = data + (size_t)y * stride;
+            for (int x = 0; x < w; x += 4)
+                hist[row[x]]++;
+        }
+    }
+}
+
+/* Fill a plane with `noise` or `flat` content (LCG, deterministic). */
+static void bench_hist_fill(uint8_t *data, int stride, int w, int h,
+                            int is_10bit, int flat)
+{
+    uint32_t seed = 0x12345678u;
+    int max_code = is_10bit ? 1023 : 255;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            int v;
+            if (!flat)
+                v = (int)((seed >> 8) % (uint32_t)(max_code + 1));
+            else if ((seed >> 24) < 230)
+                v = is_10bit ? 64 : 16;            /* black, limited range */
+            else
+                v = (x * max_code) / w;            /* sparse gradient */
+            if (is_10bit)
+                ((uint16_t *)(data + (size_t)y * stride))[x] = (uint16_t)v;
+            else
+                data[(size_t)y * stride + x] = (uint8_t)v;
+        }
+    }
+}
+
+/* Time all kernels on one plane. Returns 0 if every kernel matched. */
+static int bench_hist_plane(const uint8_t *data, int stride, int is_10bit,
+                            const char *content, int iterations)
+{
+    int w = BENCH_HIST_W, h = BENCH_HIST_H;
+    double samples = (double)w * h;
+    uint32_t ref[256], hist[256];
+    int mismatches = 0;
+
+    /* Reference: old subsampled scan (1/16 of the samples) */
+    double t0 = get_time_sec();
+    for (int i = 0; i < iterations; i++)
+        bench_hist_subsampled(data, stride, w, h, is_10bit, hist);
+    double ms = (get_time_sec() - t0) * 1000.0 / iterations;
+    printf("%-6s %-6s %-11s %9.3f %9.2f   (1/16 samples)\n",
+           is_10bit ? "10-bit" : "8-bit", content, "subsampled",
+           ms, samples / 16.0 / (ms * 1e6));
+
+    /* Scalar full-resolution result is the correctness reference */
+    hist_kernel_select(0);
+    if (is_10bit) hist_luma_u10(data, stride, w, h, ref);
+    else          hist_luma_u8(data, stride, w, h, ref);
+
+    for (int k = 0; k < hist_kernel_count(); k++) {
+        if (hist_kernel_select(k) < 0) {
+            printf("%-6s %-6s %-11s %9s\n", is_10bit ? "10-bit" : "8-bit",
+                   content, hist_kernel_name(k), "n/a");
+            continue;
+        }
+        t0 = get_time_sec();
+        for (int i = 0; i < iterations; i++) {
+            if (is_10bit) hist_luma_u10(data, stride, w, h, hist);
+            else          hist_luma_u8(data, stride, w, h, hist);
+        }
+        ms = (get_time_sec() - t0) * 1000.0 / iterations;
+
+        int ok = memcmp(hist, ref, sizeof(ref)) == 0;
+        if (!ok) mismatches++;
+        printf("%-6s %-6s %-11s %9.3f %9.2f   %s\n",
+               is_10bit ? "10-bit" : "8-bit", content, hist_kernel_name(k),
+               ms, samples / (ms * 1e6), ok ? "ok" : "MISMATCH");
+    }
+    fflush(stdout);
+    return mismatches ? -1 : 0;
+}
+
+/* Run the histogram microbenchmark. Returns the process exit code:
+ * 0 if all kernels agree with the scalar reference. */
+int bench_hist_run(int iterations) {
+    if (iterations <= 0) iterations = 50;
+    log_msg("Bench: histogram kernels (%d iterations)", iterations);
+
+    /* Decoder-like padded stride (linesize > width) */
+    int w = BENCH_HIST_W, h = BENCH_HIST_H;
+    int rc = 0;
+
+    printf("histogram kernels: %dx%d plane, %d iterations\n\n",
+           w, h, iterations);
+    printf("%-6s %-6s %-11s %9s %9s\n",
+           "depth", "data", "kernel", "ms/frame", "Gsamp/s");
+
+    for (int is_10bit = 0; is_10bit <= 1; is_10bit++) {
+        int bpp    = is_10bit ? 2 : 1;
+        int stride = FFALIGN(w * bpp, 64) + 64;
+        uint8_t *plane = av_malloc((size_t)stride * h);
+        if (!plane) return 1;
+
+        for (int flat = 0; flat <= 1; flat++) {
+            bench_hist_fill(plane, stride, w, h, is_10bit, flat);
+            if (bench_hist_plane(plane, stride, is_10bit,
+                                 flat ? "flat" : "noise", iterations) < 0)
+                rc = 1;
+        }
+        av_free(plane);
+    }
+
+    hist_kernel_select(-1);
+    return rc;
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Blend Microbenchmark (--bench-blend)
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Times every overlay blend kernel this CPU can run on three synthetic
+ * workloads:
+ *   text   — a 1600×320 subtitle cue (mostly transparent, opaque glyph
+ *            cores, anti-aliased edges) over an empty overlay
+ *   panel  — a full 4K block of partial alpha over a half-opaque panel:
+ *            every pixel takes the mixed path (the worst case)
+ *   scaled — a 1920×1080 bitmap subtitle canvas scaled to 4K, nearest
+ * The scalar kernel is the pre-SIMD loop and is the reference: each
+ * kernel's output is compared with it. x86 kernels match exactly; the
+ * NEON one may differ by one code where the compiler fuses the scalar
+ * multiply-adds.
+ */
+
+#define BENCH_BLEND_W  3840
+#define BENCH_BLEND_H  2160
+
+typedef struct BenchBlendCase {
+    const char *name;
+    int         sw, sh;     /* source size                  */
+    int         dw, dh;     /* destination (blended) size   */
+    int         scaled;     /* 1 = nearest scale sw×sh → dw×dh */
+} BenchBlendCase;
+
+static uint32_t bench_blend_rand(uint32_t *seed) {
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 8;
+}
+
+/* Source and destination contents for one case (LCG, deterministic). */
+static void bench_blend_fill(const BenchBlendCase *c, uint8_t *src, uint8_t *dst) {
+    uint32_t seed = 0x2468ace0u;
+    for (int y = 0; y < c->sh; y++) {
+        for (int x = 0; x < c->sw; x++) {
+            uint8_t *p = src + ((size_t)y * c->sw + x) * 4;
+            uint32_t r = bench_blend_rand(&seed);
+            int a;
+            if (strcmp(c->name, "panel") == 0) {
+                a = 1 + (int)(r % 254);                       /* always mixed */
+            } else {
+                /* Glyph-like: 8-px strokes on a 24-px grid, soft edges */
+                int gx = x % 24, gy = y % 40;
+                int core = gx >= 8 && gx < 16 && gy >= 6 && gy < 34;
+                int edge = (gx == 7 || gx == 16) && gy >= 6 && gy < 34;
+                a = core ? 255 : edge ? (int)(r % 256) : 0;
+            }
+            p[0] = (uint8_t)(r >> 4);
+            p[1] = (uint8_t)(r >> 8);
+            p[2] = (uint8_t)(r >> 12);
+            p[3] = (uint8_t)a;
+        }
+    }
+    int panel = strcmp(c->name, "panel") == 0;
+    for (size_t i = 0; i < (size_t)c->dw * c->dh; i++) {
+        uint8_t *p = dst + i * 4;
+        p[0] = p[1] = p[2] = 0;
+        p[3] = panel ? 180 : 0;
+    }
+}
+
+/* One blit of the case, the way overlay.c drives the kernels. */
+static void bench_blend_once(const BenchBlendCase *c, uint8_t *dst,
+                             const uint8_t *src, const int *xmap)
+{
+    for (int y = 0; y < c->dh; y++) {
+        uint8_t *row = dst + (size_t)y * c->dw * 4;
+        if (c->scaled) {
+            int sy = y * c->sh / c->dh;
+            blend_over_row_scaled(row, src + (size_t)sy * c->sw * 4, xmap, c->dw);
+        } else {
+            blend_over_row(row, src + (size_t)y * c->sw * 4, c->dw);
+        }
+    }
+}
+
+/* Time all kernels on one case. Returns 0 unless a kernel disagreed
+ * with scalar by more than one code. */
+static int bench_blend_case(const BenchBlendCase *c, int iterations) {
+    size_t src_sz = (size_t)c->sw * c->sh * 4;
+    size_t dst_sz = (size_t)c->dw * c->dh * 4;
+    uint8_t *src  = malloc(src_sz);
+    uint8_t *init = malloc(dst_sz);
+    uint8_t *ref  = malloc(dst_sz);
+    uint8_t *dst  = malloc(dst_sz);
+    int     *xmap = malloc((size_t)c->dw * sizeof(int));
+    int rc = 0;
+
+    if (!src || !init || !ref || !dst || !xmap) {
+        rc = -1;
+        goto done;
+    }
+    bench_blend_fill(c, src, init);
+    for (int x = 0; x < c->dw; x++)
+        xmap[x] = c->scaled ? x * c->sw / c->dw : x;
+
+    blend_kernel_select(0);
+    memcpy(ref, init, dst_sz);
+    bench_blend_once(c, ref, src, xmap);
+
+    double pixels = (double)c->dw * c->dh;
+    for (int k = 0; k < blend_kernel_count(); k++) {
+        if (blend_kernel_select(k) < 0) {
+            printf("%-7s %-7s %9s\n", c->name, blend_kernel_name(k), "n/a");
+            continue;
+        }
+        /* Every pass starts from the same destination; only the blend
+         * itself is timed */
+        double sec = 0.0;
+        for (int i = 0; i < iterations; i++) {
+            memcpy(dst, init, dst_sz);
+            double t0 = get_time_sec();
+            bench_blend_once(c, dst, src, xmap);
+            sec += get_time_sec() - t0;
+        }
+        double ms = sec * 1000.0 / iterations;
+
+        int maxd = 0;
+        for (size_t i = 0; i < dst_sz; i++) {
+            int d = abs((int)dst[i] - (int)ref[i]);
+            if (d > maxd) maxd = d;
+        }
+        if (maxd > 1) rc = -1;
+        printf("%-7s %-7s %9.3f %9.1f   %s\n", c->name, blend_kernel_name(k),
+               ms, pixels / (ms * 1e3),
+               maxd == 0 ? "ok" : maxd == 1 ? "ok (±1)" : "MISMATCH");
+    }
+    fflush(stdout);
+
+done:
+    free(src);
+    free(init);
+    free(ref);
+    free(dst);
+    free(xmap);
+    return rc;
+}
+
+/* Run the blend microbenchmark. Returns the process exit code:
+ * 0 if all kernels agree with the scalar reference. */
+int bench_blend_run(int iterations) {
+    if (iterations <= 0) iterations = 20;
+    log_msg("Bench: blend kernels (%d iterations)", iterations);
+
+    static const BenchBlendCase cases[] = {
+        { "text",   1600, 320,  1600, 320,  0 },
+        { "panel",  BENCH_BLEND_W, BENCH_BLEND_H, BENCH_BLEND_W, BENCH_BLEND_H, 0 },
+        { "scaled", 1920, 1080, BENCH_BLEND_W, BENCH_BLEND_H, 1 },
+    };
+    int rc = 0;
+
+    printf("blend kernels: %d iterations\n\n", iterations);
+    printf("%-7s %-7s %9s %9s\n", "data", "kernel", "ms/blit", "Mpix/s");
+
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+        if (bench_blend_case(&cases[i], iterations) < 0)
+            rc = 1;
+
+    blend_kernel_select(-1);
+    return rc;
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Downmix Microbenchmark (--bench-downmix)
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Times every downmix kernel this CPU can run on one second of
+ * synthetic planar float audio (5.1 and 7.1 to stereo, 7.1 to 5.1),
+ * with the matrix audio_convert_frame() builds. The frame count is odd
+ * so every kernel's scalar tail runs too. Two checks per case:
+ *   - each kernel against scalar (accumulation order is the same, so
+ *     only FMA contraction can move the last bit)
+ *   - scalar against swr_convert() with its default rematrix options,
+ *     which the downmix path replaces and must keep matching
+ * swr is timed as the reference cost.
+ */
+
+#define BENCH_MIX_FRAMES  48007
+#define BENCH_MIX_EPS     1e-5f   /* signals stay within ±4 */
+
+typedef struct BenchMixCase {
+    const char *name;
+    uint64_t    in_mask, out_mask;
+} BenchMixCase;
+
+static float bench_mix_maxdiff(const float *a, const float *b, size_t n) {
+    float maxd = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        float d = fabsf(a[i] - b[i]);
+        if (d != d) return INFINITY;
+        if (d > maxd) maxd = d;
+    }
+    return maxd;
+}
+
+/* Time all kernels and swr on one case. Returns 0 if every kernel
+ * matched scalar and scalar matched swr. */
+static int bench_mix_case(const BenchMixCase *c, int iterations) {
+    AVChannelLayout in_l, out_l;
+    av_channel_layout_from_mask(&in_l, c->in_mask);
+    av_channel_layout_from_mask(&out_l, c->out_mask);
+    int in_ch = in_l.nb_channels, out_ch = out_l.nb_channels;
+    int n = BENCH_MIX_FRAMES;
+    size_t out_sz = (size_t)n * out_ch;
+
+    float *in[AUDIO_MAX_IN_CH] = { 0 };
+    float *ref = av_malloc(out_sz * sizeof(float));
+    float *out = av_malloc(out_sz * sizeof(float));
+    SwrContext *swr = NULL;
+    float m[AUDIO_MAX_OUT_CH * AUDIO_MAX_IN_CH];
+    double md[AUDIO_MAX_OUT_CH * AUDIO_MAX_IN_CH];
+    int rc = -1;
+
+    if (!ref || !out) goto fail;
+    for (int ch = 0; ch < in_ch; ch++) {
+        if (!(in[ch] = av_malloc((size_t)n * sizeof(float)))) goto fail;
+        uint32_t seed = 0x13579bdfu + (uint32_t)ch;
+        for (int i = 0; i < n; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            in[ch][i] = (float)(seed >> 8) / (float)(1 << 23) - 1.0f;
+        }
+    }
+
+    /* Same parameters as audio_convert_frame() */
+    if (swr_build_matrix2(&in_l, &out_l, M_SQRT1_2, M_SQRT1_2, 0.0, INT_MAX, 1.0,
+                          md, in_ch, AV_MATRIX_ENCODING_NONE, NULL) < 0)
+        goto fail;
+    for (int i = 0; i < out_ch * in_ch; i++)
+        m[i] = (float)md[i];
+
+    if (swr_alloc_set_opts2(&swr, &out_l, AV_SAMPLE_FMT_FLT, 48000,
+                            &in_l, AV_SAMPLE_FMT_FLTP, 48000, 0, NULL) < 0 ||
+        swr_init(swr) < 0)
+        goto fail;
+
+    double samples = (double)n * in_ch;
+    double t0 = get_time_sec();
+    int got = 0;
+    for (int i = 0; i < iterations; i++) {
+        uint8_t *dst = (uint8_t *)out;
+        got = swr_convert(swr, &dst, n, (const uint8_t **)in, n);
+    }
+    double ms = (get_time_sec() - t0) * 1000.0 / iterations;
+
+    audio_mix_kernel_select(0);
+    audio_mix((const float *const *)in, in_ch, m, out_ch, ref, n);
+
+    rc = 0;
+    float d = got == n ? bench_mix_maxdiff(out, ref, out_sz) : INFINITY;
+    if (!(d <= BENCH_MIX_EPS)) rc = -1;
+    printf("%-8s %-7s %9.3f %9.1f   %s (max %.1e vs scalar)\n",
+           c->name, "swr", ms, samples / (ms * 1e3),
+           d <= BENCH_MIX_EPS ? "ok" : "MISMATCH", (double)d);
+
+    for (int k = 0; k < audio_mix_kernel_count(); k++) {
+        if (audio_mix_kernel_select(k) < 0) {
+            printf("%-8s %-7s %9s\n", c->name, audio_mix_kernel_name(k), "n/a");
+            continue;
+        }
+        t0 = get_time_sec();
+        for (int i = 0; i < iterations; i++)
+            audio_mix((const float *const *)in, in_ch, m, out_ch, out, n);
+        ms = (get_time_sec() - t0) * 1000.0 / iterations;
+
+        d = bench_mix_maxdiff(out, ref, out_sz);
+        if (!(d <= BENCH_MIX_EPS)) rc = -1;
+        printf("%-8s %-7s %9.3f %9.1f   %s\n", c->name, audio_mix_kernel_name(k),
+               ms, samples / (ms * 1e3),
+               d == 0.0f ? "ok" : d <= BENCH_MIX_EPS ? "ok (fma)" : "MISMATCH");
+    }
+    fflush(stdout);
+    goto done;
+
+fail:
+    printf("%-8s setup failed\n", c->name);
+done:
+    swr_free(&swr);
+    for (int ch = 0; ch < in_ch; ch++)
+        av_free(in[ch]);
+    av_free(ref);
+    av_free(out);
+    av_channel_layout_uninit(&in_l);
+    av_channel_layout_uninit(&out_l);
+    return rc;
+}
+
+/* Run the downmix microbenchmark. Returns the process exit code:
+ * 0 if all kernels agree with scalar and scalar agrees with swr. */
+int bench_downmix_run(int iterations) {
+    if (iterations <= 0) iterations = 200;
+    log_msg("Bench: downmix kernels (%d iterations)", iterations);
+
+    static const BenchMixCase cases[] = {
+        { "5.1>2",   AV_CH_LAYOUT_5POINT1,      AV_CH_LAYOUT_STEREO  },
+        { "7.1>2",   AV_CH_LAYOUT_7POINT1,      AV_CH_LAYOUT_STEREO  },
+        { "7.1>5.1", AV_CH_LAYOUT_7POINT1,      AV_CH_LAYOUT_5POINT1 },
+    };
+    int rc = 0;
+
+    printf("downmix kernels: %d frames, %d iterations\n\n",
+           BENCH_MIX_FRAMES, iterations);
+    printf("%-8s %-7s %9s %9s\n", "layout", "kernel", "ms/call", "Msamp/s");
+
+    for (int i = 0; i < (int)(sizeof(cases) / sizeof(cases[0])); i++)
+        if (bench_mix_case(&cases[i], iterations) < 0)
+            rc = 1;
+
+    audio_mix_kernel_select(-1);
+    return rc;
+}
@@ -0,0 +1,378 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * blend.c — SIMD alpha "over" kernels for the overlay blitters
+ *
+ * blit_surface() (text subtitles) and blit_rgba_scaled() (bitmap
+ * subtitles on the CPU fallback) composite straight-alpha RGBA rows
+ * over the overlay buffer, which is straight alpha too (the overlay
+ * pipeline blends with SRC_ALPHA). Per pixel:
+ *
+ *   sa == 0                 keep dst
+ *   sa == 255 or da == 0    copy src
+ *   otherwise               Ao = as + ad·(1 − as)
+ *                           Co = (Cs·as + Cd·ad·(1 − as)) / Ao
+ *
+ * i.e. premultiply both, add, and un-premultiply once. The SIMD kernels
+ * run four (SSE2, NEON) or eight (AVX2) pixels at a time:
+ *
+ *   - Whole blocks are classified from the alpha bytes first. A block
+ *     of transparent source pixels (most of a text cue's box) is
+ *     skipped, a block of copies (glyph interiors, empty destination)
+ *     is one store. Only mixed blocks touch float math.
+ *   - Mixed blocks do the formula above in float with the same
+ *     operations in the same order as the scalar loop, one vector
+ *     divide per pixel, then select keep/copy/blend per lane. On x86
+ *     the output is bit-identical to scalar.
+ *
+ * The scaled variant is nearest-neighbour like the loop it replaces:
+ * the caller maps destination columns to source columns once per blit
+ * (xmap) and each row gathers through it — a hardware gather on AVX2.
+ *
+ * Kernels: scalar (always), SSE2 + AVX2 (x86-64), NEON (ARM64), chosen
+ * at first use from SDL's CPU feature checks like histogram.c;
+ * blend_kernel_select() overrides it for --bench-blend.
+ */
+
+#include "dsvp.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define BLEND_X86 1
+  #include <emmintrin.h>
+  #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define BLEND_NEON 1
+  #include <arm_neon.h>
+#endif
+
+#if defined(BLEND_X86) && (defined(__GNUC__) || defined(__clang__))
+  #define BLEND_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define BLEND_TARGET_AVX2
+#endif
+
+typedef void (*BlendRowFn)(uint8_t *dst, const uint8_t *src, int n);
+typedef void (*BlendScaledFn)(uint8_t *dst, const uint8_t *src, const int *xmap, int n);
+
+typedef struct BlendKernel {
+    const char   *name;
+    BlendRowFn    row;      /* n pixels, src[i] over dst[i]       */
+    BlendScaledFn scaled;   /* n pixels, src[xmap[i]] over dst[i] */
+    int         (*available)(void);
+} BlendKernel;
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Scalar
+ * ═══════════════════════════════════════════════════════════════════ */
+
+static inline void blend_px(uint8_t *dp, const uint8_t *sp) {
+    uint8_t sa = sp[3];
+    if (sa == 0) return;
+    if (sa == 255 || dp[3] == 0) {
+        dp[0] = sp[0]; dp[1] = sp[1]; dp[2] = sp[2]; dp[3] = sa;
+        return;
+    }
+    float sf = sa / 255.0f;
+    float df = dp[3] / 255.0f;
+    float of = sf + df * (1.0f - sf);
+    if (of > 0.0f) {
+        dp[0] = (uint8_t)((sp[0] * sf + dp[0] * df * (1.0f - sf)) / of);
+        dp[1] = (uint8_t)((sp[1] * sf + dp[1] * df * (1.0f - sf)) / of);
+        dp[2] = (uint8_t)((sp[2] * sf + dp[2] * df * (1.0f - sf)) / of);
+        dp[3] = (uint8_t)(of * 255.0f);
+    }
+}
+
+static void blend_row_scalar(uint8_t *dst, const uint8_t *src, int n) {
+    for (int i = 0; i < n; i++)
+        blend_px(dst + i * 4, src + i * 4);
+}
+
+static void blend_scaled_scalar(uint8_t *dst, const uint8_t *src, const int *xmap, int n) {
+    for (int i = 0; i < n; i++)
+        blend_px(dst + i * 4, src + (size_t)xmap[i] * 4);
+}
+
+static int blend_always(void) { return 1; }
+
+/* ═══════════════════════════════════════════════════════════════════
+ * SSE2 / AVX2 (x86-64)
+ * ═══════════════════════════════════════════════════════════════════ */
+
+#ifdef BLEND_X86
+
+static int blend_has_sse2(void) { return SDL_HasSSE2(); }
+static int blend_has_avx2(void) { return SDL_HasAVX2(); }
+
+/* One pixel (R G B A as int32 lanes): the mixed-alpha formula. */
+static inline __m128i blend_mix1_sse2(__m128i s32, __m128i d32) {
+    const __m128 k255  = _mm_set1_ps(255.0f);
+    const __m128 one   = _mm_set1_ps(1.0f);
+    const __m128 amask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+    __m128 s  = _mm_cvtepi32_ps(s32);
+    __m128 d  = _mm_cvtepi32_ps(d32);
+    __m128 sf = _mm_div_ps(_mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3)), k255);
+    __m128 df = _mm_div_ps(_mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 3, 3)), k255);
+    __m128 inv = _mm_sub_ps(one, sf);
+    __m128 of = _mm_add_ps(sf, _mm_mul_ps(df, inv));
+    __m128 c  = _mm_div_ps(_mm_add_ps(_mm_mul_ps(s, sf),
+                                      _mm_mul_ps(_mm_mul_ps(d, df), inv)), of);
+    __m128 a  = _mm_mul_ps(of, k255);
+    return _mm_cvttps_epi32(_mm_or_ps(_mm_andnot_ps(amask, c), _mm_and_ps(amask, a)));
+}
+
+/* Four pixels of src (already loaded or gathered) over dst. */
+static inline void blend_over4_sse2(uint8_t *dst, __m128i s) {
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000u);
+
+    __m128i sa = _mm_and_si128(s, alpha);
+    __m128i keep = _mm_cmpeq_epi32(sa, zero);
+    if (_mm_movemask_epi8(keep) == 0xFFFF)
+        return;                                     /* all transparent */
+
+    __m128i d  = _mm_loadu_si128((const __m128i *)dst);
+    __m128i copy = _mm_or_si128(_mm_cmpeq_epi32(sa, alpha),
+                                _mm_cmpeq_epi32(_mm_and_si128(d, alpha), zero));
+    __m128i out = s;
+    if (_mm_movemask_epi8(_mm_or_si128(keep, copy)) != 0xFFFF) {
+        __m128i s_lo = _mm_unpacklo_epi8(s, zero), s_hi = _mm_unpackhi_epi8(s, zero);
+        __m128i d_lo = _mm_unpacklo_epi8(d, zero), d_hi = _mm_unpackhi_epi8(d, zero);
+        __m128i p0 = blend_mix1_sse2(_mm_unpacklo_epi16(s_lo, zero), _mm_unpacklo_epi16(d_lo, zero));
+        __m128i p1 = blend_mix1_sse2(_mm_unpackhi_epi16(s_lo, zero), _mm_unpackhi_epi16(d_lo, zero));
+        __m128i p2 = blend_mix1_sse2(_mm_unpacklo_epi16(s_hi, zero), _mm_unpacklo_epi16(d_hi, zero));
+        __m128i p3 = blend_mix1_sse2(_mm_unpackhi_epi16(s_hi, zero), _mm_unpackhi_epi16(d_hi, zero));
+        __m128i mix = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+        out = _mm_or_si128(_mm_and_si128(copy, s), _mm_andnot_si128(copy, mix));
+    }
+    out = _mm_or_si128(_mm_and_si128(keep, d), _mm_andnot_si128(keep, out));
+    _mm_storeu_si128((__m128i *)dst, out);
+}
+
+static inline uint32_t blend_ld32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static void blend_row_sse2(uint8_t *dst, const uint8_t *src, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        blend_over4_sse2(dst + i * 4, _mm_loadu_si128((const __m128i *)(src + i * 4)));
+    blend_row_scalar(dst + i * 4, src + i * 4, n - i);
+}
+
+static void blend_scaled_sse2(uint8_t *dst, const uint8_t *src, const int *xmap, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i s = _mm_set_epi32((int)blend_ld32(src + (size_t)xmap[i + 3] * 4),
+                                  (int)blend_ld32(src + (size_t)xmap[i + 2] * 4),
+                                  (int)blend_ld32(src + (size_t)xmap[i + 1] * 4),
+                                  (int)blend_ld32(src + (size_t)xmap[i]     * 4));
+        blend_over4_sse2(dst + i * 4, s);
+    }
+    blend_scaled_scalar(dst + i * 4, src, xmap + i, n - i);
+}
+
+/* Two pixels, one per 128-bit lane (R G B A as int32). */
+BLEND_TARGET_AVX2
+static inline __m256i blend_mix2_avx2(__m256i s32, __m256i d32) {
+    const __m256 k255  = _mm256_set1_ps(255.0f);
+    const __m256 one   = _mm256_set1_ps(1.0f);
+    const __m256 amask = _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0));
+
+    __m256 s  = _mm256_cvtepi32_ps(s32);
+    __m256 d  = _mm256_cvtepi32_ps(d32);
+    __m256 sf = _mm256_div_ps(_mm256_permute_ps(s, 0xFF), k255);
+    __m256 df = _mm256_div_ps(_mm256_permute_ps(d, 0xFF), k255);
+    __m256 inv = _mm256_sub_ps(one, sf);
+    __m256 of = _mm256_add_ps(sf, _mm256_mul_ps(df, inv));
+    __m256 c  = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(s, sf),
+                                            _mm256_mul_ps(_mm256_mul_ps(d, df), inv)), of);
+    __m256 a  = _mm256_mul_ps(of, k255);
+    return _mm256_cvttps_epi32(_mm256_blendv_ps(c, a, amask));
+}
+
+BLEND_TARGET_AVX2
+static inline void blend_over8_avx2(uint8_t *dst, __m256i s) {
+    const __m256i zero  = _mm256_setzero_si256();
+    const __m256i alpha = _mm256_set1_epi32((int)0xFF000000u);
+
+    __m256i sa = _mm256_and_si256(s, alpha);
+    __m256i keep = _mm256_cmpeq_epi32(sa, zero);
+    if (_mm256_movemask_epi8(keep) == -1)
+        return;
+
+    __m256i d  = _mm256_loadu_si256((const __m256i *)dst);
+    __m256i copy = _mm256_or_si256(_mm256_cmpeq_epi32(sa, alpha),
+                                   _mm256_cmpeq_epi32(_mm256_and_si256(d, alpha), zero));
+    __m256i out = s;
+    if (_mm256_movemask_epi8(_mm256_or_si256(keep, copy)) != -1) {
+        uint8_t sb[32], db[32];
+        _mm256_storeu_si256((__m256i *)sb, s);
+        _mm256_storeu_si256((__m256i *)db, d);
+        __m256i p[4];
+        for (int k = 0; k < 4; k++)
+            p[k] = blend_mix2_avx2(
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(sb + k * 8))),
+                _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(db + k * 8))));
+        /* packs work per 128-bit lane: bytes come out as 0 2 4 6 | 1 3 5 7 */
+        __m256i mix = _mm256_packus_epi16(_mm256_packs_epi32(p[0], p[1]),
+                                          _mm256_packs_epi32(p[2], p[3]));
+        mix = _mm256_permutevar8x32_epi32(mix, _mm256_set_epi32(7, 3, 6, 2, 5, 1, 4, 0));
+        out = _mm256_blendv_epi8(mix, s, copy);
+    }
+    _mm256_storeu_si256((__m256i *)dst, _mm256_blendv_epi8(out, d, keep));
+}
+
+BLEND_TARGET_AVX2
+static void blend_row_avx2(uint8_t *dst, const uint8_t *src, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8)
+        blend_over8_avx2(dst + i * 4, _mm256_loadu_si256((const __m256i *)(src + i * 4)));
+    blend_row_sse2(dst + i * 4, src + i * 4, n - i);
+}
+
+BLEND_TARGET_AVX2
+static void blend_scaled_avx2(uint8_t *dst, const uint8_t *src, const int *xmap, int n) {
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i idx = _mm256_loadu_si256((const __m256i *)(xmap + i));
+        blend_over8_avx2(dst + i * 4, _mm256_i32gather_epi32((const int *)src, idx, 4));
+    }
+    blend_scaled_sse2(dst + i * 4, src, xmap + i, n - i);
+}
+
+#endif /* BLEND_X86 */
+
+/* ═══════════════════════════════════════════════════════════════════
+ * NEON (ARM64)
+ * ═══════════════════════════════════════════════════════════════════ */
+
+#ifdef BLEND_NEON
+
+static int blend_has_neon(void) { return SDL_HasNEON(); }
+
+static inline uint32x4_t blend_mix1_neon(uint32x4_t s32, uint32x4_t d32) {
+    const float32x4_t k255  = vdupq_n_f32(255.0f);
+    const float32x4_t one   = vdupq_n_f32(1.0f);
+    const uint32x4_t  amask = { 0, 0, 0, 0xFFFFFFFFu };
+
+    float32x4_t s  = vcvtq_f32_u32(s32);
+    float32x4_t d  = vcvtq_f32_u32(d32);
+    float32x4_t sf = vdivq_f32(vdupq_laneq_f32(s, 3), k255);
+    float32x4_t df = vdivq_f32(vdupq_laneq_f32(d, 3), k255);
+    float32x4_t inv = vsubq_f32(one, sf);
+    float32x4_t of = vaddq_f32(sf, vmulq_f32(df, inv));
+    float32x4_t c  = vdivq_f32(vaddq_f32(vmulq_f32(s, sf),
+                                         vmulq_f32(vmulq_f32(d, df), inv)), of);
+    float32x4_t a  = vmulq_f32(of, k255);
+    return vcvtq_u32_f32(vbslq_f32(amask, a, c));
+}
+
+static inline void blend_over4_neon(uint8_t *dst, uint8x16_t s8) {
+    uint32x4_t s  = vreinterpretq_u32_u8(s8);
+    uint32x4_t sa = vshrq_n_u32(s, 24);
+    uint32x4_t keep = vceqq_u32(sa, vdupq_n_u32(0));
+    if (vminvq_u32(keep) == 0xFFFFFFFFu)
+        return;
+
+    uint8x16_t d8 = vld1q_u8(dst);
+    uint32x4_t d  = vreinterpretq_u32_u8(d8);
+    uint32x4_t copy = vorrq_u32(vceqq_u32(sa, vdupq_n_u32(255)),
+                                vceqq_u32(vshrq_n_u32(d, 24), vdupq_n_u32(0)));
+    uint32x4_t out = s;
+    if (vminvq_u32(vorrq_u32(keep, copy)) != 0xFFFFFFFFu) {
+        uint16x8_t s_lo = vmovl_u8(vget_low_u8(s8)), s_hi = vmovl_u8(vget_high_u8(s8));
+        uint16x8_t d_lo = vmovl_u8(vget_low_u8(d8)), d_hi = vmovl_u8(vget_high_u8(d8));
+        uint32x4_t p0 = blend_mix1_neon(vmovl_u16(vget_low_u16(s_lo)),  vmovl_u16(vget_low_u16(d_lo)));
+        uint32x4_t p1 = blend_mix1_neon(vmovl_u16(vget_high_u16(s_lo)), vmovl_u16(vget_high_u16(d_lo)));
+        uint32x4_t p2 = blend_mix1_neon(vmovl_u16(vget_low_u16(s_hi)),  vmovl_u16(vget_low_u16(d_hi)));
+        uint32x4_t p3 = blend_mix1_neon(vmovl_u16(vget_high_u16(s_hi)), vmovl_u16(vget_high_u16(d_hi)));
+        uint8x8_t  lo = vqmovn_u16(vcombine_u16(vqmovn_u32(p0), vqmovn_u32(p1)));
+        uint8x8_t  hi = vqmovn_u16(vcombine_u16(vqmovn_u32(p2), vqmovn_u32(p3)));
+        out = vbslq_u32(copy, s, vreinterpretq_u32_u8(vcombine_u8(lo, hi)));
+    }
+    vst1q_u8(dst, vreinterpretq_u8_u32(vbslq_u32(keep, d, out)));
+}
+
+static void blend_row_neon(uint8_t *dst, const uint8_t *src, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+        blend_over4_neon(dst + i * 4, vld1q_u8(src + i * 4));
+    blend_row_scalar(dst + i * 4, src + i * 4, n - i);
+}
+
+static void blend_scaled_neon(uint8_t *dst, const uint8_t *src, const int *xmap, int n) {
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32_t px[4];
+        for (int k = 0; k < 4; k++)
+            memcpy(&px[k], src + (size_t)xmap[i + k] * 4, 4);
+        blend_over4_neon(dst + i * 4, vreinterpretq_u8_u32(vld1q_u32(px)));
+    }
+    blend_scaled_scalar(dst + i * 4, src, xmap + i, n - i);
+}
+
+#endif /* BLEND_NEON */
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Dispatch
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Ordered slowest → fastest; auto-select takes the last available. */
+static const BlendKernel s_kernels[] = {
+    { "scalar", blend_row_scalar, blend_scaled_scalar, blend_always   },
+#ifdef BLEND_X86
+    { "sse2",   blend_row_sse2,   blend_scaled_sse2,   blend_has_sse2 },
+    { "avx2",   blend_row_avx2,   blend_scaled_avx2,   blend_has_avx2 },
+#endif
+#ifdef BLEND_NEON
+    { "neon",   blend_row_neon,   blend_scaled_neon,   blend_has_neon },
+#endif
+};
+#define BLEND_NUM_KERNELS ((int)(sizeof(s_kernels) / sizeof(s_kernels[0])))
+
+static const BlendKernel *s_active = NULL;
+
+/* Number of kernels compiled in (not all may run on this CPU). */
+int blend_kernel_count(void) {
+    return BLEND_NUM_KERNELS;
+}
+
+const char *blend_kernel_name(int idx) {
+    if (idx < 0 || idx >= BLEND_NUM_KERNELS) return NULL;
+    return s_kernels[idx].name;
+}
+
+int blend_kernel_available(int idx) {
+    if (idx < 0 || idx >= BLEND_NUM_KERNELS) return 0;
+    return s_kernels[idx].available();
+}
+
+/* Select kernel `idx`, or the fastest available if idx < 0.
+ * Returns the selected index, or -1 if idx is not available here. */
+int blend_kernel_select(int idx) {
+    if (idx < 0) {
+        for (idx = BLEND_NUM_KERNELS - 1; idx > 0; idx--)
+            if (s_kernels[idx].available()) break;
+    } else if (!blend_kernel_available(idx)) {
+        return -1;
+    }
+    if (s_active != &s_kernels[idx])
+        log_msg("Blend: %s kernel", s_kernels[idx].name);
+    s_active = &s_kernels[idx];
+    return idx;
+}
+
+/* n straight-alpha RGBA pixels of src over dst. */
+void blend_over_row(uint8_t *dst, const uint8_t *src, int n) {
+    if (!s_active) blend_kernel_select(-1);
+    s_active->row(dst, src, n);
+}
+
+/* Nearest-neighbour: dst[i] gets src[xmap[i]] composited over it. */
+void blend_over_row_scaled(uint8_t *dst, const uint8_t *src, const int *xmap, int n) {
+    if (!s_active) blend_kernel_select(-1);
+    s_active->scaled(dst, src, xmap, n);
+}
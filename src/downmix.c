@@ -0,0 +1,282 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * downmix.c — SIMD channel downmix and interleave kernels
+ *
+ * When the source has more channels than the output device (7.1 into a
+ * stereo device) and no resampling is needed, audio_decode_frame() skips
+ * swr and mixes the decoder's planar float output directly:
+ *
+ *   out[o][i] = Σc  m[o][c] · in[c][i]
+ *
+ * The coefficients come from swr_build_matrix2(), so the result matches
+ * what swr would produce; only the per-sample matrix work changes.
+ *
+ * Samples are processed a vector at a time: each output channel is
+ * accumulated across the input planes with plain loads (planar input
+ * needs no gathers), then the block is interleaved into the device's
+ * frame order. Stereo — the common case — interleaves in registers.
+ *
+ * audio_interleave() is the same-layout case: planar → interleaved with
+ * no arithmetic at all.
+ *
+ * Kernels: scalar (always), SSE2 + AVX2 (x86-64), NEON (ARM64), chosen
+ * at first use from SDL's CPU feature checks like histogram.c.
+ * audio_mix_kernel_select() overrides it for --bench-downmix.
+ */
+
+#include "dsvp.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define MIX_X86 1
+  #include <emmintrin.h>
+  #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define MIX_NEON 1
+  #include <arm_neon.h>
+#endif
+
+#if defined(MIX_X86) && (defined(__GNUC__) || defined(__clang__))
+  #define MIX_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define MIX_TARGET_AVX2
+#endif
+
+typedef void (*MixFn)(const float *const *in, int in_ch, const float *m,
+                      int out_ch, float *out, int n);
+
+typedef struct MixKernel {
+    const char *name;
+    MixFn       mix;
+    int       (*available)(void);
+} MixKernel;
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Scalar
+ * ═══════════════════════════════════════════════════════════════════ */
+
+static void mix_scalar(const float *const *in, int in_ch, const float *m,
+                       int out_ch, float *out, int n)
+{
+    for (int i = 0; i < n; i++) {
+        for (int o = 0; o < out_ch; o++) {
+            const float *row = m + o * in_ch;
+            float acc = 0.0f;
+            for (int c = 0; c < in_ch; c++)
+                acc += row[c] * in[c][i];
+            out[i * out_ch + o] = acc;
+        }
+    }
+}
+
+static int mix_always(void) { return 1; }
+
+/* Scatter a planar block (tmp[o][0..w)) into interleaved output. */
+static inline void mix_scatter(const float *tmp, int w, int out_ch, float *out) {
+    for (int k = 0; k < w; k++)
+        for (int o = 0; o < out_ch; o++)
+            out[k * out_ch + o] = tmp[o * w + k];
+}
+
+/* ═══════════════════════════════════════════════════════════════════
+ * SSE2 / AVX2 (x86-64)
+ * ═══════════════════════════════════════════════════════════════════ */
+
+#ifdef MIX_X86
+
+static int mix_has_sse2(void) { return SDL_HasSSE2(); }
+static int mix_has_avx2(void) { return SDL_HasAVX2(); }
+
+static void mix_sse2(const float *const *in, int in_ch, const float *m,
+                     int out_ch, float *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc[AUDIO_MAX_OUT_CH];
+        for (int o = 0; o < out_ch; o++) {
+            const float *row = m + o * in_ch;
+            __m128 a = _mm_setzero_ps();
+            for (int c = 0; c < in_ch; c++)
+                a = _mm_add_ps(a, _mm_mul_ps(_mm_set1_ps(row[c]),
+                                             _mm_loadu_ps(in[c] + i)));
+            acc[o] = a;
+        }
+        float *dst = out + (size_t)i * out_ch;
+        if (out_ch == 2) {
+            /* L0 R0 L1 R1 | L2 R2 L3 R3 */
+            _mm_storeu_ps(dst,     _mm_unpacklo_ps(acc[0], acc[1]));
+            _mm_storeu_ps(dst + 4, _mm_unpackhi_ps(acc[0], acc[1]));
+        } else {
+            float tmp[AUDIO_MAX_OUT_CH * 4];
+            for (int o = 0; o < out_ch; o++)
+                _mm_storeu_ps(tmp + o * 4, acc[o]);
+            mix_scatter(tmp, 4, out_ch, dst);
+        }
+    }
+    if (i < n) {
+        const float *tail[AUDIO_MAX_IN_CH];
+        for (int c = 0; c < in_ch; c++) tail[c] = in[c] + i;
+        mix_scalar(tail, in_ch, m, out_ch, out + (size_t)i * out_ch, n - i);
+    }
+}
+
+MIX_TARGET_AVX2
+static void mix_avx2(const float *const *in, int in_ch, const float *m,
+                     int out_ch, float *out, int n)
+{
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc[AUDIO_MAX_OUT_CH];
+        for (int o = 0; o < out_ch; o++) {
+            const float *row = m + o * in_ch;
+            __m256 a = _mm256_setzero_ps();
+            for (int c = 0; c < in_ch; c++)
+                a = _mm256_add_ps(a, _mm256_mul_ps(_mm256_set1_ps(row[c]),
+                                                   _mm256_loadu_ps(in[c] + i)));
+            acc[o] = a;
+        }
+        float *dst = out + (size_t)i * out_ch;
+        if (out_ch == 2) {
+            /* unpack works per 128-bit lane: lo = {0,1 | 4,5}, hi = {2,3 | 6,7};
+             * permute2f128 restores sample order */
+            __m256 lo = _mm256_unpacklo_ps(acc[0], acc[1]);
+            __m256 hi = _mm256_unpackhi_ps(acc[0], acc[1]);
+            _mm256_storeu_ps(dst,     _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        } else {
+            float tmp[AUDIO_MAX_OUT_CH * 8];
+            for (int o = 0; o < out_ch; o++)
+                _mm256_storeu_ps(tmp + o * 8, acc[o]);
+            mix_scatter(tmp, 8, out_ch, dst);
+        }
+    }
+    if (i < n) {
+        const float *tail[AUDIO_MAX_IN_CH];
+        for (int c = 0; c < in_ch; c++) tail[c] = in[c] + i;
+        mix_sse2(tail, in_ch, m, out_ch, out + (size_t)i * out_ch, n - i);
+    }
+}
+
+#endif /* MIX_X86 */
+
+/* ═══════════════════════════════════════════════════════════════════
+ * NEON (ARM64)
+ * ═══════════════════════════════════════════════════════════════════ */
+
+#ifdef MIX_NEON
+
+static int mix_has_neon(void) { return SDL_HasNEON(); }
+
+static void mix_neon(const float *const *in, int in_ch, const float *m,
+                     int out_ch, float *out, int n)
+{
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t acc[AUDIO_MAX_OUT_CH];
+        for (int o = 0; o < out_ch; o++) {
+            const float *row = m + o * in_ch;
+            float32x4_t a = vdupq_n_f32(0.0f);
+            for (int c = 0; c < in_ch; c++)
+                a = vmlaq_n_f32(a, vld1q_f32(in[c] + i), row[c]);
+            acc[o] = a;
+        }
+        float *dst = out + (size_t)i * out_ch;
+        if (out_ch == 2) {
+            float32x4x2_t lr = { { acc[0], acc[1] } };
+            vst2q_f32(dst, lr);          /* interleaving store */
+        } else {
+            float tmp[AUDIO_MAX_OUT_CH * 4];
+            for (int o = 0; o < out_ch; o++)
+                vst1q_f32(tmp + o * 4, acc[o]);
+            mix_scatter(tmp, 4, out_ch, dst);
+        }
+    }
+    if (i < n) {
+        const float *tail[AUDIO_MAX_IN_CH];
+        for (int c = 0; c < in_ch; c++) tail[c] = in[c] + i;
+        mix_scalar(tail, in_ch, m, out_ch, out + (size_t)i * out_ch, n - i);
+    }
+}
+
+#endif /* MIX_NEON */
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Dispatch
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Ordered slowest → fastest; auto-select takes the last available. */
+static const MixKernel s_kernels[] = {
+    { "scalar", mix_scalar, mix_always   },
+#ifdef MIX_X86
+    { "sse2",   mix_sse2,   mix_has_sse2 },
+    { "avx2",   mix_avx2,   mix_has_avx2 },
+#endif
+#ifdef MIX_NEON
+    { "neon",   mix_neon,   mix_has_neon },
+#endif
+};
+#define MIX_NUM_KERNELS ((int)(sizeof(s_kernels) / sizeof(s_kernels[0])))
+
+static const MixKernel *s_active = NULL;
+
+int audio_mix_kernel_count(void) {
+    return MIX_NUM_KERNELS;
+}
+
+/* Name of kernel `idx`; idx < 0 names the active one (the log lines). */
+const char *audio_mix_kernel_name(int idx) {
+    if (idx < 0) {
+        if (!s_active) audio_mix_kernel_select(-1);
+        return s_active->name;
+    }
+    if (idx >= MIX_NUM_KERNELS) return NULL;
+    return s_kernels[idx].name;
+}
+
+int audio_mix_kernel_available(int idx) {
+    if (idx < 0 || idx >= MIX_NUM_KERNELS) return 0;
+    return s_kernels[idx].available();
+}
+
+/* Select kernel `idx`, or the fastest available if idx < 0.
+ * Returns the selected index, or -1 if idx is not available here. */
+int audio_mix_kernel_select(int idx) {
+    if (idx < 0) {
+        for (idx = MIX_NUM_KERNELS - 1; idx > 0; idx--)
+            if (s_kernels[idx].available()) break;
+    } else if (!audio_mix_kernel_available(idx)) {
+        return -1;
+    }
+    if (s_active != &s_kernels[idx])
+        log_msg("Downmix: %s kernel", s_kernels[idx].name);
+    s_active = &s_kernels[idx];
+    return idx;
+}
+
+/* Mix n samples of in_ch planar float channels into n interleaved frames
+ * of out_ch channels. m is out_ch rows of in_ch coefficients.
+ * in_ch ≤ AUDIO_MAX_IN_CH, out_ch ≤ AUDIO_MAX_OUT_CH. */
+void audio_mix(const float *const *in, int in_ch, const float *m,
+               int out_ch, float *out, int n)
+{
+    if (!s_active) audio_mix_kernel_select(-1);
+    s_active->mix(in, in_ch, m, out_ch, out, n);
+}
+
+/* Planar → interleaved, same channels. Pure data movement; the compiler
+ * vectorizes the stereo loop. */
+void audio_interleave(const float *const *in, int ch, float *out, int n) {
+    if (ch == 2) {
+        const float *l = in[0], *r = in[1];
+        for (int i = 0; i < n; i++) {
+            out[2 * i]     = l[i];
+            out[2 * i + 1] = r[i];
+        }
+        return;
+    }
+    for (int c = 0; c < ch; c++) {
+        const float *src = in[c];
+        float *dst = out + c;
+        for (int i = 0; i < n; i++)
+            dst[(size_t)i * ch] = src[i];
+    }
+}
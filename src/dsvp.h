@@ -42,8 +42,33 @@
 #define DSVP_VERSION        "0.2.0-beta"
 #define DSVP_WINDOW_TITLE   "DSVP"
 
-#define PACKET_QUEUE_MAX    256     /* max packets buffered per stream  */
-#define AUDIO_BUF_SIZE      192000  /* max decoded audio buffer bytes   */
+#define PACKET_QUEUE_SLOTS  1024    /* default ring capacity per queue (pow2) */
+
+/* Demux readahead budgets, per stream type. The demuxer keeps reading
+ * until every active queue holds its duration budget; the byte budget
+ * is a hard per-queue memory ceiling that stops reading regardless. */
+#define VIDEO_QUEUE_MAX_SEC     4.0                 /* video readahead  */
+#define VIDEO_QUEUE_MAX_BYTES   (128 * 1024 * 1024) /* ~12s at 80 Mbit/s */
+#define AUDIO_QUEUE_MAX_SEC     4.0                 /* audio readahead  */
+#define AUDIO_QUEUE_MAX_BYTES   (16 * 1024 * 1024)  /* ~10s of 7.1 LPCM */
+#ifndef FRAME_QUEUE_SIZE
+#define FRAME_QUEUE_SIZE    6       /* decoded video frames buffered ahead */
+#endif
+#define FRAME_QUEUE_MAX     16      /* upper bound for FRAME_QUEUE_SIZE  */
+#define AUDIO_BUF_SIZE      768000  /* max decoded audio buffer bytes (8ch F32) */
+#define AUDIO_MAX_OUT_CH    8       /* device channels negotiated (7.1) */
+#define AUDIO_MAX_IN_CH     16      /* widest source the SIMD downmix takes */
+#define AUDIO_RING_MS       300     /* PCM decoded ahead of the device  */
+#define AUDIO_RING_LOSSLESS_MS 1000 /* same, TrueHD / DTS-HD MA (bursty) */
+#define AUDIO_ALT_QUEUE_SEC 6.0     /* inactive tracks: packets kept for switching */
+#define AUDIO_SWITCH_PREROLL 0.25   /* decoder priming before the splice point */
+#define AUDIO_SWITCH_LEAD   0.025   /* old track PCM kept past the ring read position */
+#define AUDIO_SWITCH_FADE   0.005   /* old → new track crossfade at the splice */
+#define AUDIO_XFADE_MAX     1024    /* crossfade frames held (5 ms at 192 kHz) */
+#define AUDIO_RING_TAGS     256     /* PTS tags in flight (1 per frame) */
+#define DS_SPEED_MAX        0.005   /* display sync: max audio speed change (±0.5%) */
+#define DS_RESYNC_SEC       0.100   /* display sync: drift fixed by drop/repeat */
+#define SCHED_HELD_BINS     6       /* cadence histogram: 1..5, 6+ vsyncs */
 #define SEEK_STEP_SEC       5.0     /* arrow key seek increment         */
 #define VOLUME_STEP         0.05    /* arrow key volume increment       */
 
@@ -51,6 +76,20 @@
 #define MAX_AUDIO_STREAMS   16      /* max audio tracks to catalog      */
 #define SUB_TEXT_SIZE       4096    /* max subtitle text buffer         */
 #define MAX_SUB_BITMAPS     4       /* max bitmap rects per subtitle    */
+#define OVERLAY_BAND_ROWS   32      /* overlay damage tracking granularity */
+#define OVERLAY_MAX_REGIONS 16      /* overlay sub-rect uploads per frame  */
+#define SUB_LINE_CACHE      32      /* rasterized subtitle lines kept    */
+
+#define GPU_UPLOAD_RING     3       /* staging buffers in flight        */
+#define SEEK_DISCARD_MAX_SEC 30.0   /* exact seek: max decode-and-discard span */
+#define PREOPEN_SEC         1.0     /* open-ahead: packets buffered per neighbour */
+#define PREOPEN_MAX_BYTES   (32 * 1024 * 1024) /* ... capped at this much */
+#define PREOPEN_DELAY_SEC   0.5     /* open-ahead starts this long after an open */
+#define LATE_ENTER_SEC      0.080   /* video behind audio by this much is late */
+#define LATE_EXIT_SEC       0.020   /* ... and within this much has caught up */
+#define LATE_ESCALATE_SEC   0.5     /* late this long → next skip level */
+#define LATE_RECOVER_SEC    2.0     /* caught up this long → previous level */
+#define HDR_HIST_BINS       1024    /* GPU luma histogram bins (shader) */
 
 /* Default window size when no video is loaded */
 #define DEFAULT_WIN_W       960
@@ -59,20 +98,47 @@
 /* ── Bitstream Audio Types ──────────────────────────────────────────
  *
  * AudioMode controls how audio reaches the output device:
- *   PCM         — always decode to F32 stereo (current default behavior)
+ *   PCM         — always decode to F32 at the device's channel count (default)
  *   AUTO        — probe HDMI sink via EDID; passthrough if supported, else PCM
  *   PASSTHROUGH — force passthrough; falls back to PCM on handshake failure
  *
- * BitstreamCaps is populated by bitstream_probe() (phase 2) from the
+ * BitstreamCaps is populated by bitstream_probe() (bitstream.c) from the
  * EDID Short Audio Descriptors reported by the connected HDMI sink.
  */
 
 typedef enum {
-    AUDIO_MODE_PCM         = 0,   /* decode → swr → F32 stereo (safe default) */
+    AUDIO_MODE_PCM         = 0,   /* decode → F32 PCM (safe default)          */
     AUDIO_MODE_AUTO        = 1,   /* probe sink, passthrough if possible       */
     AUDIO_MODE_PASSTHROUGH = 2    /* force passthrough, fallback on failure    */
 } AudioMode;
 
+/* What paces video. AUDIO: frame_timer chases the audio clock (drops
+ * and catch-up bursts absorb drift). DISPLAY: each frame is shown for a
+ * whole number of measured vsyncs and the audio is resampled by up to
+ * DS_SPEED_MAX to follow video. */
+typedef enum {
+    SYNC_AUDIO   = 0,             /* audio master, frame_timer pacing          */
+    SYNC_DISPLAY = 1              /* vsync master, audio speed slaved to video */
+} SyncMode;
+
+/* How hard the video decoder cuts corners when it falls behind the
+ * audio clock (video_late_update). Each level includes the previous. */
+typedef enum {
+    LATE_NONE    = 0,             /* decode everything                         */
+    LATE_NONREF  = 1,             /* skip_frame: drop non-reference frames     */
+    LATE_NOLOOP  = 2,             /* skip_loop_filter on all but keyframes     */
+    LATE_KEYONLY = 3              /* only keyframe packets reach the decoder   */
+} LateLevel;
+
+/* How decoded PCM reaches the device format (audio_decode_frame). swr
+ * only runs when resampling or a non-float source format requires it. */
+typedef enum {
+    AUDIO_PATH_SWR        = 0,    /* swr: resample and/or format convert      */
+    AUDIO_PATH_DIRECT     = 1,    /* packed float, layout matches: copy        */
+    AUDIO_PATH_INTERLEAVE = 2,    /* planar float, layout matches: interleave  */
+    AUDIO_PATH_DOWNMIX    = 3     /* planar float, fewer device channels: SIMD */
+} AudioPath;
+
 typedef struct BitstreamCaps {
     int  support_ac3;      /* sink decodes AC-3 (Dolby Digital)         */
     int  support_eac3;     /* sink decodes E-AC-3 (DD+)                */
@@ -82,29 +148,240 @@ typedef struct BitstreamCaps {
     int  hbr_capable;      /* HDMI supports High Bit Rate (TrueHD req) */
     int  max_channels;     /* max channel count reported by sink       */
     int  probed;           /* 1 = caps have been queried this session   */
+    int  hbr_device;       /* output carries HBR: 1 yes, -1 no, 0 unchecked */
 } BitstreamCaps;
 
+/* IEC 61937 burst writer: libavformat's "spdif" muxer with an AVIO
+ * callback that appends to a caller-supplied buffer instead of a file.
+ * The bursts are S16LE PCM on the carrier described by rate/channels. */
+typedef struct SpdifMuxer {
+    AVFormatContext *fmt;          /* "spdif" muxer, pb = memory AVIO      */
+    uint8_t         *out;          /* burst destination for this write     */
+    int              out_len;      /* bytes appended to out                */
+    int              out_cap;
+    int              rate;         /* carrier sample rate (Hz)             */
+    int              channels;     /* 2, or 8 for HBR (TrueHD / DTS-HD MA) */
+    double           pending_pts;  /* PTS of the first packet not yet emitted */
+    int              pending;      /* 1 = pending_pts is set               */
+} SpdifMuxer;
+
 /* ── Packet Queue ───────────────────────────────────────────────────
  *
- * Thread-safe FIFO queue for AVPackets. The demux thread pushes packets,
- * and the video/audio decode paths pop them. Uses SDL mutex + condvar
- * because SDL's threading is cross-platform (no need for pthreads).
+ * Lock-free single-producer/single-consumer ring of AVPackets. The demux
+ * thread is the only producer; each queue has exactly one consumer at a
+ * time (video decode thread, audio decode thread, or main thread for subs).
+ * Slots are allocated once in pq_init, so put/get are a packet ref move
+ * plus an atomic index store — no heap traffic, no lock. The ring holds
+ * PACKET_QUEUE_SLOTS packets unless pq_init_sized asked for more (audio
+ * queues of high packet rate codecs, see audio_queue_slots).
+ *
+ * head/tail are free-running counters; the slot is (index & mask).
+ * Byte accounting is split into producer-only and consumer-only totals
+ * so neither side needs a read-modify-write on shared state.
+ *
+ * The mutex/condvar are only touched when a consumer waits on an empty
+ * queue (pq_get with block=1, pq_wait). SDL atomics keep it portable.
+ *
+ * Throttled queues also point at the demux thread's DemuxWait. When the
+ * demuxer is parked because its readahead budget is met, each pop wakes
+ * it instead of the demuxer sleep-polling for space.
  */
 
-typedef struct PacketNode {
-    AVPacket           *pkt;
-    struct PacketNode  *next;
-} PacketNode;
+typedef struct DemuxWait {
+    SDL_Mutex      *mutex;
+    SDL_Condition  *cond;
+    SDL_AtomicInt   waiting;      /* 1 = demux parked on cond            */
+} DemuxWait;
 
 typedef struct PacketQueue {
-    PacketNode  *first;
-    PacketNode  *last;
-    int          nb_packets;
-    int          size;          /* total byte size of queued packet data */
+    AVPacket      **slots;        /* capacity preallocated               */
+    unsigned        capacity;     /* ring slots (pow2)                   */
+    SDL_AtomicInt   head;         /* next slot to write (producer)       */
+    SDL_AtomicInt   tail;         /* next slot to read (consumer)        */
+    SDL_AtomicInt   bytes_in;     /* total bytes pushed (producer)       */
+    SDL_AtomicInt   bytes_out;    /* total bytes popped (consumer)       */
+    SDL_AtomicInt   dur_in;       /* total µs pushed (producer)          */
+    SDL_AtomicInt   dur_out;      /* total µs popped (consumer)          */
+    SDL_AtomicInt   waiting;      /* 1 = consumer sleeping on cond       */
+    SDL_Mutex      *mutex;        /* blocking wait path only             */
+    SDL_Condition  *cond;
+    int             abort_request; /* signal threads to stop blocking    */
+
+    /* Readahead budget (0 = unlimited) and the demux wakeup to signal
+     * when a pop frees budget. Set after pq_init for throttled queues. */
+    int             max_bytes;
+    int64_t         max_duration; /* µs (AV_TIME_BASE units)             */
+    DemuxWait      *space_wait;
+    int             dropped;      /* packets refused on a full ring (producer) */
+} PacketQueue;
+
+/* ── Frame Queue ────────────────────────────────────────────────────
+ *
+ * Bounded ring of decoded video frames between the video decode thread
+ * and the render loop. Each slot holds a full AVFrame reference, so HDR
+ * mastering and Dolby Vision RPU side data travel with the pixels.
+ *
+ * serial is bumped on every seek flush. The decode thread tags each frame
+ * with the serial it was decoded under; frames from an older serial are
+ * dropped on push so pre-seek pictures never reach the screen.
+ */
+
+typedef struct FrameSlot {
+    AVFrame     *frame;
+    double       pts;           /* presentation time in seconds     */
+} FrameSlot;
+
+typedef struct FrameQueue {
+    FrameSlot    slots[FRAME_QUEUE_MAX];
+    int          capacity;      /* active ring size (<= FRAME_QUEUE_MAX) */
+    int          rindex;        /* next slot to pop                 */
+    int          windex;        /* next slot to fill                */
+    int          count;         /* filled slots                     */
+    int          serial;        /* seek generation, bumped by flush */
     SDL_Mutex   *mutex;
     SDL_Condition *cond;
-    int          abort_request; /* signal threads to stop blocking      */
-} PacketQueue;
+    int          abort_request; /* signal decode thread to stop     */
+} FrameQueue;
+
+/* ── Seek Index ────────────────────────────────────────────────────
+ *
+ * Sorted keyframe table for the video stream, built once per file by a
+ * background thread (seekindex.c). ts/pos are written before `ready`
+ * is set and never change afterwards, so lookups take no lock.
+ */
+
+typedef struct SeekIndex {
+    int64_t        *ts;          /* keyframe PTS, stream time base, sorted */
+    int64_t        *pos;         /* keyframe packet byte offset, -1 = unknown */
+    int             count;
+    int             by_byte;     /* 1 = seek by byte offset (no container index) */
+    AVRational      time_base;
+    double          build_sec;   /* time taken to build (diagnostics) */
+    int             stream_idx;
+    char           *path;
+    SDL_Thread     *thread;
+    SDL_AtomicInt   ready;       /* 1 = table published */
+    SDL_AtomicInt   abort;       /* 1 = stop scanning (player_close) */
+} SeekIndex;
+
+/* ── Audio PCM Ring ────────────────────────────────────────────────
+ *
+ * Lock-free single-producer/single-consumer ring of resampled float
+ * PCM between the audio decode thread and the SDL audio callback, so
+ * the callback never decodes, resamples or touches a packet queue.
+ * In passthrough it carries IEC 61937 bursts (S16LE) instead; `align`
+ * keeps post-seek skips on burst boundaries.
+ *
+ * wpos/rpos are free-running frame counters; the slot is (pos & mask).
+ * Each decoded frame pushes a PTS tag {ring position, PTS}; the callback
+ * derives the PTS of whatever it is about to play from the latest tag
+ * at or before rpos, independent of how far decode has run ahead.
+ *
+ * Reset (seek, track switch) happens with the producer excluded by
+ * adec_mutex and the callback excluded by the audio stream lock.
+ */
+
+typedef struct AudioRingTag {
+    unsigned        pos;         /* ring frame position of the first sample */
+    double          pts;         /* its PTS in seconds */
+} AudioRingTag;
+
+typedef struct AudioRing {
+    uint8_t        *buf;         /* capacity * frame_bytes interleaved samples */
+    unsigned        capacity;    /* frames, power of two */
+    unsigned        mask;
+    int             frame_bytes; /* 8 (F32 stereo), 4/16 (IEC 61937 S16) */
+    int             freq;
+    unsigned        align;       /* skip granularity in frames (burst length) */
+    SDL_AtomicInt   wpos;        /* frames written (producer) */
+    SDL_AtomicInt   rpos;        /* frames played (callback) */
+    AudioRingTag    tags[AUDIO_RING_TAGS];
+    SDL_AtomicInt   tag_w;       /* tags written (producer) */
+    SDL_AtomicInt   tag_r;       /* oldest tag still in use (callback) */
+    double          floor;       /* post-seek/switch: callback drops PCM before this PTS */
+    double          floor_slack; /* tolerance below floor that still plays */
+} AudioRing;
+
+/* ── Presentation Scheduler ─────────────────────────────────────────
+ *
+ * Owned by the main thread (sched.c). Measures the vsync period from
+ * render-loop ticks, plans how many vsyncs each frame should stay up
+ * (3:2 for 24p on 60 Hz, 5:5 on 120 Hz, 1:1 at matching rates) and
+ * scores what was actually shown against that plan, in either sync
+ * mode. In display sync it also drives presentation.
+ *
+ * `owed` is the cadence phase: content time minus screen time, in
+ * vsyncs. An ideal cadence keeps it within ±0.5.
+ */
+
+typedef struct PresentSched {
+    double          vsync;          /* measured vsync period (secs)          */
+    double          vsync_nominal;  /* display mode's period, for reference  */
+    double          last_tick;      /* time of the previous render tick      */
+    double          shown_pts;      /* video_clock of the frame on screen    */
+
+    /* ── Planning (display sync) ── */
+    double          phase;          /* vsyncs owed to the next frame         */
+    int             ticks_left;     /* vsyncs the current frame stays up     */
+
+    /* ── Scoring (both modes) ── */
+    int             frame_ticks;    /* vsyncs the frame on screen has been up */
+    int             scoring;        /* 0 until a frame after a reset is up   */
+    double          owed;           /* content − screen time (vsyncs)        */
+    int             frames;         /* frames scored                         */
+    int             off_cadence;    /* frames that pushed |owed| past 0.5    */
+    double          err_max;        /* worst |owed| (vsyncs)                 */
+    double          err_sum;        /* Σ|owed|, for the mean                 */
+    int             held[SCHED_HELD_BINS]; /* frames up 1, 2, … , N+ vsyncs  */
+} PresentSched;
+
+/* ── Playlist Open-Ahead ─────────────────────────────────────────────
+ *
+ * A neighbouring playlist file opened on a background thread
+ * (preopen.c): container probed, video decoder opened with its first
+ * frame decoded, and about PREOPEN_SEC of packets read in demux order.
+ * player_open() adopts it instead of starting cold. `fed` marks video
+ * packets the primed decoder has already consumed.
+ */
+
+typedef struct PreOpenPkt {
+    AVPacket       *pkt;
+    int             fed;
+} PreOpenPkt;
+
+typedef struct PreOpen {
+    char           *path;           /* NULL = empty slot                     */
+    SDL_Thread     *thread;         /* worker, until joined                  */
+    SDL_AtomicInt   abort;          /* main → worker: give up                */
+    int             ok;             /* worker succeeded (valid once joined)  */
+    double          open_sec;       /* worker time, for the log              */
+
+    AVFormatContext *fmt_ctx;       /* opened and probed                     */
+    int             video_idx;      /* av_find_best_stream() result          */
+    AVCodecContext *video_ctx;      /* primed decoder, NULL if none          */
+    int             calibrated;     /* its thread config came from the cache */
+    int             primed;         /* decoder adopted: skip `fed` packets   */
+    AVFrame        *first;          /* first decoded frame                   */
+    double          first_pts;      /* its PTS (seconds)                     */
+    PreOpenPkt     *pkts;           /* read ahead, demux order               */
+    int             npkts, cap;
+    int64_t         bytes;
+} PreOpen;
+
+/* ── GPU Upload Ring ────────────────────────────────────────────────
+ *
+ * One staging transfer buffer per slot holding the Y, U and V planes back
+ * to back. Slots rotate per displayed frame; each remembers the fence of
+ * the command buffer that last read it, so the CPU copy into slot N+1
+ * overlaps the GPU copy pass still reading slot N.
+ */
+
+typedef struct GPUUploadSlot {
+    SDL_GPUTransferBuffer *xfer;   /* Y | U | V staging                   */
+    SDL_GPUFence          *fence;  /* last submit reading this slot, or NULL */
+    SDL_GPUTransferBuffer *hist_rb;      /* HDR percentile readback (download) */
+    int                    hist_pending; /* 1 = hist_rb written by last submit */
+} GPUUploadSlot;
 
 /* ── GPU Uniform Data ──────────────────────────────────────────────
  *
@@ -168,21 +445,36 @@ typedef struct PlayerState {
     uint8_t            *audio_buf;        /* resampled audio buffer     */
     unsigned int        audio_buf_size;   /* bytes of valid data in buf */
     unsigned int        audio_buf_index;  /* read cursor into buf       */
+    double              audio_buf_pts;    /* PTS of the first sample in buf */
+    AVChannelLayout     audio_out_layout; /* negotiated with the device (SDL order) */
+    AVChannelLayout     audio_mix_in;     /* source layout audio_mix_matrix is for */
+    float               audio_mix_matrix[AUDIO_MAX_OUT_CH * AUDIO_MAX_IN_CH];
+    AudioPath           audio_path;       /* conversion used for the last frame */
+    AudioRing           audio_ring;       /* decode thread → callback   */
 
     /* ── Bitstream passthrough ── */
     AudioMode           audio_mode;       /* PCM / Auto / Passthrough   */
     BitstreamCaps       bitstream_caps;   /* HDMI sink capabilities     */
     int                 bitstream_active; /* 1 = currently passing through */
+    SpdifMuxer          spdif;            /* packets → IEC 61937 bursts */
 
     /* ── Packet queues ── */
     PacketQueue         video_pq;
     PacketQueue         audio_pq;
+    FrameQueue          video_fq;         /* decoded frames awaiting display */
 
     /* ── Audio stream catalog ── */
     int                 aud_stream_indices[MAX_AUDIO_STREAMS];
     char                aud_stream_names[MAX_AUDIO_STREAMS][128];
     int                 aud_count;          /* number of audio streams      */
     int                 aud_selection;      /* 0-based index into catalog   */
+    PacketQueue         aud_alt_pqs[MAX_AUDIO_STREAMS]; /* inactive tracks (demux-owned) */
+
+    /* Instant track switch: main thread opens the decoder, demux splices */
+    AVCodecContext     *aud_switch_ctx;     /* new decoder; old one after swap */
+    int                 aud_switch_sel;     /* catalog index to switch to   */
+    double              aud_switch_time;    /* get_time_sec() of the key press */
+    SDL_AtomicInt       aud_switch_request; /* 1 = splice pending in demux  */
 
     /* Audio track change OSD */
     char                aud_osd[256];
@@ -198,18 +490,27 @@ typedef struct PlayerState {
     SDL_GPUGraphicsPipeline    *gpu_pipeline_yuv;   /* planar YUV420P   */
     SDL_GPUSampler             *gpu_sampler;         /* linear filtering */
     SDL_GPUSampler             *gpu_sampler_nearest; /* nearest for overlay */
+    SDL_GPUTextureFormat        gpu_target_format;   /* swapchain, or RGBA8 headless */
+    SDL_GPUComputePipeline     *gpu_pipeline_hist;   /* HDR luma histogram (NULL = CPU scan) */
+    SDL_GPUComputePipeline     *gpu_pipeline_hist_reduce; /* histogram → percentile bin */
+    SDL_GPUBuffer              *gpu_hist_bins;       /* HDR_HIST_BINS × uint32 */
+    SDL_GPUBuffer              *gpu_hist_result;     /* [0]=percentile bin, [1]=total */
 
     /* ── SDL_GPU handles (lifetime: per-file, created/destroyed in player_open/close) ── */
     SDL_GPUTexture             *gpu_tex_y;           /* Y plane          */
     SDL_GPUTexture             *gpu_tex_u;           /* U plane          */
     SDL_GPUTexture             *gpu_tex_v;           /* V plane          */
     SDL_GPUTexture         *gpu_tex_noise;           /* 64×64 blue noise dither (app lifetime) */
-    SDL_GPUTransferBuffer      *gpu_xfer_y;          /* CPU→GPU staging  */
-    SDL_GPUTransferBuffer      *gpu_xfer_u;
-    SDL_GPUTransferBuffer      *gpu_xfer_v;
+    GPUUploadSlot               gpu_upload[GPU_UPLOAD_RING]; /* CPU→GPU staging ring */
+    int                         gpu_upload_idx;      /* next slot to fill */
+    Uint32                      gpu_upload_pitch_y;  /* max row bytes per plane in a slot */
+    Uint32                      gpu_upload_pitch_uv;
+    Uint32                      gpu_upload_off_u;    /* plane offsets within a slot */
+    Uint32                      gpu_upload_off_v;
     GPUUniforms                 gpu_uniforms;         /* current color params */
 
-    /* ── HDR dynamic peak detection (Layer 1: CPU scan) ── */
+    /* ── HDR dynamic peak detection (GPU histogram, CPU scan fallback) ── */
+    int                         gpu_hist_dispatch;    /* 1 = record histogram this frame */
     float                       hdr_smoothed_peak;    /* temporally smoothed peak (nits) */
     float                       hdr_prev_frame_peak;  /* raw peak from previous frame    */
     float                       hdr_static_peak;      /* metadata peak (fallback ceiling) */
@@ -218,11 +519,30 @@ typedef struct PlayerState {
 
     /* ── Overlay GPU handles (lifetime: application, resized as needed) ── */
     SDL_GPUGraphicsPipeline    *gpu_pipeline_overlay; /* RGBA + alpha blend */
+    SDL_GPUGraphicsPipeline    *gpu_pipeline_sub;     /* premultiplied RGBA (subtitle layer) */
     SDL_GPUTexture             *gpu_overlay_tex;      /* RGBA8888 overlay  */
     SDL_GPUTransferBuffer      *gpu_overlay_xfer;     /* CPU→GPU staging   */
     int                         overlay_tex_w;         /* current texture dimensions */
     int                         overlay_tex_h;
     int                         overlay_dirty;         /* 1 = need re-upload */
+    int                         overlay_full;          /* 1 = texture is new, send it whole */
+    SDL_Rect                    overlay_regions[OVERLAY_MAX_REGIONS]; /* staged, not yet copied */
+    int                         overlay_nregions;
+    int                         overlay_copy_bytes;    /* last copy pass (debug panel) */
+    int                         overlay_copy_regions;
+
+    /* ── Subtitle GPU layer: bitmap cues as their own textures, drawn as
+     *    scaled quads after the overlay (lifetime: application) ── */
+    SDL_GPUTexture             *gpu_sub_tex[MAX_SUB_BITMAPS]; /* RGBA8888, one per rect */
+    int                         gpu_sub_tex_w[MAX_SUB_BITMAPS];
+    int                         gpu_sub_tex_h[MAX_SUB_BITMAPS];
+    SDL_GPUTransferBuffer      *gpu_sub_xfer;          /* CPU→GPU staging, all rects */
+    Uint32                      gpu_sub_xfer_size;
+    int                         gpu_sub_count;         /* rects in the uploaded cue */
+    int                         gpu_sub_serial;        /* sub_bitmap_serial uploaded */
+    int                         gpu_sub_dirty;         /* 1 = copy pass pending */
+    int                         sub_layer_active;      /* 1 = draw the quads this frame */
+    SDL_FRect                   sub_layer_dst[MAX_SUB_BITMAPS]; /* quads, physical px */
 
     /* ── Timing / A/V sync ── */
     double              audio_clock;      /* current audio PTS in secs (audio thread internal) */
@@ -230,19 +550,42 @@ typedef struct PlayerState {
     double              av_bias;          /* adaptive A/V offset (EMA of av_diff) */
     int                 av_bias_samples;  /* warmup counter (apply after 60)     */
     double              audio_pts_floor;  /* post-seek: discard audio frames with PTS below this */
+    double              audio_splice_pts; /* track switch: new decoder's PCM starts here (0 = none) */
+    float               audio_xfade[AUDIO_XFADE_MAX * AUDIO_MAX_OUT_CH]; /* old track past the splice */
+    int                 audio_xfade_len;  /* frames in audio_xfade (0 = hard splice) */
     double              video_clock;      /* current video PTS in secs  */
     double              frame_timer;      /* when we last showed a frame*/
     double              frame_last_delay; /* last frame display duration*/
     double              frame_last_pts;   /* PTS of last displayed frame*/
+    SyncMode            sync_mode;        /* audio master or display sync */
+    PresentSched        sched;            /* vsync measurement, cadence (sched.c) */
+    double              ds_audio_speed;   /* display sync: audio rate, main → audio thread */
+    double              ds_drift_i;       /* display sync: integral of A/V drift */
     int64_t             seek_target;      /* seek target in AV_TIME_BASE*/
     int                 seek_request;     /* 1 = seek pending           */
     int                 seek_flags;
     int                 seek_recovering;  /* 1 = waiting for first displayed frame post-seek */
+    double              seek_discard_until; /* exact seek: drop frames before this PTS, <0 = off */
+    int                 seek_skip_hints;    /* skip_frame=NONREF set on video codec */
+    SDL_AtomicInt       late_level;       /* LateLevel wanted, main → vdecode  */
+    int                 late_applied;     /* LateLevel on the codec (vdecode)  */
+    double              late_changed;     /* time of the last level change     */
+    double              late_bad_since;   /* lag above LATE_ENTER_SEC since (0 = not) */
+    double              late_ok_since;    /* lag below LATE_EXIT_SEC since (0 = not) */
+    SeekIndex           seek_index;       /* background keyframe table */
 
     /* ── Threads ── */
     SDL_Thread         *demux_thread;
-    SDL_Mutex          *seek_mutex;    /* protects codec flush vs decode  */
-    int                 seeking;       /* 1 = flush in progress, skip decode */
+    DemuxWait           demux_wait;    /* readahead full / EOF parking    */
+    SDL_Thread         *video_thread;  /* video decode → video_fq         */
+    SDL_Thread         *audio_thread;  /* audio decode → audio_ring       */
+    SDL_Semaphore      *audio_space;   /* callback → audio thread: ring read */
+    SDL_Mutex          *seek_mutex;    /* seek vs subtitle drain, track swap */
+    SDL_Mutex          *vdec_mutex;    /* video codec: decode vs flush    */
+    SDL_Mutex          *adec_mutex;    /* audio codec + PCM producer state */
+    int                 seeking;       /* 1 = seek in progress            */
+    int                 video_draining; /* 1 = NULL packet sent at EOF     */
+    int                 video_eof;     /* 1 = decoder fully drained       */
 
     /* ── Playback state ── */
     int                 playing;          /* 1 = file is loaded/playing */
@@ -252,6 +595,12 @@ typedef struct PlayerState {
     int                 fullscreen;
     int                 eof;              /* demuxer hit end of file    */
     int                 video_ready;      /* 1 after first frame uploaded — gates reblit */
+    int                 headless;         /* 1 = no window/audio (--headless) */
+    int                 bench_audio;      /* 1 = keep audio when headless (--bench-audio) */
+    int                 bench_audio_stream; /* --bench-audio: stream to decode, -1 = none */
+    int                 vdec_threads;     /* decoder thread_count override */
+    int                 vdec_thread_type; /* FF_THREAD_* override, 0 = default caps */
+    int                 vdec_calibrated;  /* thread config from the calibration cache */
 
     /* ── Window geometry ── */
     int                 win_w, win_h;     /* current window size        */
@@ -291,6 +640,7 @@ typedef struct PlayerState {
     int                 sub_bitmap_h[MAX_SUB_BITMAPS];
     SDL_Rect            sub_bitmap_rects[MAX_SUB_BITMAPS];
     int                 sub_bitmap_count;
+    int                 sub_bitmap_serial;  /* bumped whenever they change  */
 
     /* Track change OSD */
     char                sub_osd[256];       /* "Subtitles: English" etc.    */
@@ -305,8 +655,16 @@ typedef struct PlayerState {
     int                 diag_frames_displayed; /* total frames shown       */
     int                 diag_frames_decoded;   /* total frames decoded     */
     int                 diag_frames_dropped;   /* frames decoded but not shown */
+    int                 diag_frames_repeated;  /* display sync: vsyncs a frame was held late */
     int                 diag_multi_decodes;    /* ticks with >1 decode     */
     int                 diag_timer_snaps;      /* frame_timer snap-forwards*/
+    int                 diag_seek_discarded;   /* frames dropped decoding to a seek target */
+    int                 diag_late_skipped;     /* packets not decoded (keyframes only) */
+    int                 diag_late_changes;     /* late policy level transitions */
+    int                 diag_audio_underruns;  /* callbacks the PCM ring could not fill */
+    int                 diag_audio_switches;   /* fast-path audio track switches */
+    int                 diag_audio_switch_seeks; /* ... of which fell back to a seek */
+    double              diag_audio_decode_sec; /* time in audio decode + resample */
     double              diag_max_av_drift;     /* worst A/V drift (signed) */
     double              diag_last_report;      /* time of last periodic log*/
 
@@ -314,25 +672,51 @@ typedef struct PlayerState {
     char              **playlist_files;      /* sorted full paths          */
     int                 playlist_count;      /* number of playable files   */
     int                 playlist_index;      /* current file's index (-1)  */
+    PreOpen             preopen[2];          /* open-ahead: neighbours (preopen.c) */
+    PreOpen             preopen_adopted;     /* taken by player_open, until replayed */
+    double              preopen_after;       /* open-ahead waits until this time */
 
 } PlayerState;
 
 /* ── Packet Queue API ─────────────────────────────────────────────── */
 
 void  pq_init(PacketQueue *q);
+void  pq_init_sized(PacketQueue *q, unsigned slots);
 void  pq_destroy(PacketQueue *q);
 int   pq_put(PacketQueue *q, AVPacket *pkt);
 int   pq_get(PacketQueue *q, AVPacket *pkt, int block);
 void  pq_flush(PacketQueue *q);
+int   pq_wait(PacketQueue *q, int timeout_ms);
+void  pq_abort(PacketQueue *q);
+
+/* ── Frame Queue API (player.c) ───────────────────────────────────── */
+
+int   fq_init(FrameQueue *q, int capacity);
+void  fq_destroy(FrameQueue *q);
+int   fq_push(FrameQueue *q, AVFrame *frame, double pts, int serial);
+int   fq_pop(FrameQueue *q, AVFrame *dst, double *pts);
+void  fq_flush(FrameQueue *q);
+void  fq_abort(FrameQueue *q);
 
 /* ── Player API (player.c) ────────────────────────────────────────── */
 
 int   player_open(PlayerState *ps, const char *filename);
 void  player_close(PlayerState *ps);
 int   demux_thread_func(void *arg);
-int   video_decode_frame(PlayerState *ps);
+void  demux_wake(PlayerState *ps);
+void  demux_route_packet(PlayerState *ps, AVPacket *pkt);
+int   video_decode_thread_func(void *arg);
+AVCodecContext *video_decoder_open(AVFormatContext *fc, int vidx, const char *path,
+                                   int threads, int type, int measure, int *calibrated);
+int   video_decode_frame(PlayerState *ps, AVFrame *frame, double *pts, int *serial);
+int   video_next_frame(PlayerState *ps);
+void  video_late_update(PlayerState *ps, double lag, double now);
+void  video_late_reset(PlayerState *ps);
 void  video_display(PlayerState *ps);
 void  video_reblit(PlayerState *ps);
+int   video_render_offscreen(PlayerState *ps, SDL_GPUTexture *target,
+                             SDL_GPUTransferBuffer *readback,
+                             double timings[3], uint64_t *hash);
 void  player_seek(PlayerState *ps, double incr);
 void  player_build_media_info(PlayerState *ps);
 void  player_build_debug_info(PlayerState *ps);
@@ -346,11 +730,14 @@ void  gpu_destroy_pipelines(PlayerState *ps);
 /* ── Overlay GPU (player.c) ──────────────────────────────────────── */
 
 int   gpu_overlay_ensure(PlayerState *ps, int width, int height);
-void  gpu_overlay_upload(PlayerState *ps, const uint8_t *rgba, int width, int height);
+void  gpu_overlay_upload(PlayerState *ps, const uint8_t *rgba, int width, int height,
+                         const SDL_Rect *regions, int nregions);
 void  gpu_overlay_copy_cmd(SDL_GPUCommandBuffer *cmd, PlayerState *ps);
 void  gpu_overlay_draw(SDL_GPURenderPass *pass, SDL_GPUCommandBuffer *cmd,
                         PlayerState *ps, Uint32 sc_w, Uint32 sc_h);
 void  gpu_overlay_destroy(PlayerState *ps);
+void  gpu_sub_upload(PlayerState *ps);
+void  gpu_sub_destroy(PlayerState *ps);
 
 /* ── Audio API (audio.c) ──────────────────────────────────────────── */
 
@@ -359,9 +746,51 @@ void  audio_close(PlayerState *ps);
 void  SDLCALL audio_callback(void *userdata, SDL_AudioStream *stream,
                               int additional_amount, int total_amount);
 int   audio_decode_frame(PlayerState *ps);
+int   audio_decode_thread_func(void *arg);
+void  audio_ring_reset(PlayerState *ps);
+int   audio_ring_cut(PlayerState *ps, double lead, double *pts, double *heard);
+unsigned audio_queue_slots(const AVCodecParameters *par, double sec);
 void  audio_find_streams(PlayerState *ps);
 void  audio_cycle(PlayerState *ps);
 
+/* ── Downmix API (downmix.c) ─────────────────────────────────────── */
+
+void  audio_mix(const float *const *in, int in_ch, const float *m,
+                int out_ch, float *out, int n);
+void  audio_interleave(const float *const *in, int ch, float *out, int n);
+int   audio_mix_kernel_count(void);
+const char *audio_mix_kernel_name(int idx);
+int   audio_mix_kernel_available(int idx);
+int   audio_mix_kernel_select(int idx);
+
+/* ── Presentation Scheduler API (sched.c) ─────────────────────────── */
+
+void  sched_reset(PlayerState *ps, int stats);
+void  sched_vsync(PlayerState *ps, double now);
+int   sched_tick(PlayerState *ps);
+void  sched_frame_shown(PlayerState *ps);
+int   sched_debug_info(PlayerState *ps, char *buf, int sz);
+
+/* ── Playlist Open-Ahead API (preopen.c) ─────────────────────────── */
+
+void  preopen_poll(PlayerState *ps, double now);
+int   preopen_take(PlayerState *ps, const char *path, PreOpen *out);
+AVCodecContext *preopen_take_decoder(PreOpen *po, int vidx, int *calibrated);
+void  preopen_replay(PlayerState *ps, PreOpen *po);
+void  preopen_free(PreOpen *po);
+void  preopen_clear(PlayerState *ps);
+
+/* ── Bitstream API (bitstream.c) ─────────────────────────────────── */
+
+void  bitstream_probe(PlayerState *ps);
+int   bitstream_wanted(PlayerState *ps, int sel);
+int   bitstream_open(PlayerState *ps);
+int   bitstream_pin_channels(SDL_AudioStream *stream);
+void  bitstream_close(PlayerState *ps);
+void  bitstream_flush(PlayerState *ps);
+int   bitstream_fill(PlayerState *ps);
+int   bitstream_dump_run(const char *path, const char *out_path);
+
 /* ── Subtitle API (subtitle.c) ───────────────────────────────────── */
 
 void  sub_find_streams(PlayerState *ps);
@@ -382,6 +811,46 @@ void  overlay_render(PlayerState *ps);
 void  overlay_render_idle(PlayerState *ps);
 void  overlay_cleanup(void);
 
+/* ── Seek Index API (seekindex.c) ────────────────────────────────── */
+
+void  seek_index_start(PlayerState *ps);
+void  seek_index_stop(PlayerState *ps);
+int   seek_index_lookup(SeekIndex *ix, int64_t target, int64_t *ts, int64_t *pos);
+
+/* ── Histogram API (histogram.c) ─────────────────────────────────── */
+
+void  hist_luma_u8(const uint8_t *data, int stride, int w, int h, uint32_t hist[256]);
+void  hist_luma_u10(const uint8_t *data, int stride, int w, int h, uint32_t hist[256]);
+int   hist_kernel_count(void);
+const char *hist_kernel_name(int idx);
+int   hist_kernel_available(int idx);
+int   hist_kernel_select(int idx);
+
+/* ── Blend API (blend.c) ─────────────────────────────────────────── */
+
+void  blend_over_row(uint8_t *dst, const uint8_t *src, int n);
+void  blend_over_row_scaled(uint8_t *dst, const uint8_t *src, const int *xmap, int n);
+int   blend_kernel_count(void);
+const char *blend_kernel_name(int idx);
+int   blend_kernel_available(int idx);
+int   blend_kernel_select(int idx);
+
+/* ── Headless API (headless.c) ──────────────────────────────────── */
+int   headless_run(const char *path, int max_frames);
+
+/* ── Benchmark API (bench.c) ─────────────────────────────────────── */
+int   bench_decode_run(const char *path, int max_frames);
+int   bench_hist_run(int iterations);
+int   bench_blend_run(int iterations);
+int   bench_downmix_run(int iterations);
+int   bench_audio_run(const char *path, int max_frames);
+int   bench_calibrate_run(const char *path);
+int   calib_decoder_threads(AVFormatContext *fc, int vidx, const char *path, int measure,
+                            int *threads, int *type);
+void  calib_queue(AVFormatContext *fc, int vidx, const char *path);
+void  calib_poll(int idle, double now);
+void  calib_shutdown(void);
+
 /* ── Logging API (log.c) ───────────────────────────────────────────── */
 
 void  log_init(void);
@@ -390,6 +859,23 @@ void  log_msg(const char *fmt, ...);
 
 /* ── Utility ──────────────────────────────────────────────────────── */
 
+/* Queue occupancy. Safe from any thread; may be one packet stale. */
+static inline int pq_nb_packets(PacketQueue *q) {
+    return (int)((unsigned)SDL_GetAtomicInt(&q->head)
+               - (unsigned)SDL_GetAtomicInt(&q->tail));
+}
+
+static inline int pq_size(PacketQueue *q) {
+    return (int)((unsigned)SDL_GetAtomicInt(&q->bytes_in)
+               - (unsigned)SDL_GetAtomicInt(&q->bytes_out));
+}
+
+/* Queued duration in µs, from packet durations. */
+static inline int64_t pq_duration(PacketQueue *q) {
+    return (int64_t)((unsigned)SDL_GetAtomicInt(&q->dur_in)
+                   - (unsigned)SDL_GetAtomicInt(&q->dur_out));
+}
+
 static inline double get_time_sec(void) {
     return (double)av_gettime_relative() / 1000000.0;
 }
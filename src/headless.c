@@ -0,0 +1,186 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * headless.c — Offscreen render mode (--headless)
+ *
+ * Runs the normal decode pipeline (demux thread, video decode thread,
+ * frame queue) and the real YUV shader, but with no window, no audio
+ * device and no A/V clock: every decoded frame is rendered into an
+ * offscreen RGBA8 texture as fast as the pipeline allows, read back,
+ * and hashed. One line per frame goes to stdout:
+ *
+ *   frame 42 pts=1.752 hash=9f0c3a1be2d4476e upload=1.84ms draw=0.61ms readback=2.10ms
+ *
+ * followed by a summary line with peak throughput. Diagnostics still go
+ * to dsvp.log / stderr, so stdout stays machine-parseable.
+ *
+ * Intended for CI: with SDL's offscreen video driver and a software
+ * Vulkan ICD (lavapipe / SwiftShader) it needs no GPU and no display.
+ */
+
+#include "dsvp.h"
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Headless Run
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Render every frame of `path` offscreen (or the first `max_frames` if
+ * max_frames > 0). Returns the process exit code: 0 on success. */
+int headless_run(const char *path, int max_frames) {
+    log_msg("Headless: %s (max frames: %d)", path, max_frames);
+
+    /* No display needed — the offscreen driver satisfies SDL_INIT_VIDEO */
+    SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen");
+    if (!SDL_Init(SDL_INIT_VIDEO)) {
+        fprintf(stderr, "[DSVP] SDL_Init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (!SDL_ShaderCross_Init()) {
+        fprintf(stderr, "[DSVP] SDL_ShaderCross_Init failed: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+#ifdef DSVP_DEBUG
+    av_log_set_level(AV_LOG_VERBOSE);
+#else
+    av_log_set_level(AV_LOG_ERROR);
+#endif
+
+    /* Same backend choice as windowed mode, so hashes and timings are
+     * comparable with what the player actually renders. */
+#ifdef __APPLE__
+    SDL_SetHint(SDL_HINT_GPU_DRIVER, "metal");
+#else
+    SDL_SetHint(SDL_HINT_GPU_DRIVER, "vulkan");
+#endif
+
+#ifdef DSVP_DEBUG
+    bool gpu_debug = true;
+#else
+    bool gpu_debug = false;
+#endif
+    SDL_GPUDevice *gpu_device = SDL_CreateGPUDevice(
+        SDL_ShaderCross_GetSPIRVShaderFormats(), gpu_debug, NULL);
+    if (!gpu_device) {
+        fprintf(stderr, "[DSVP] Cannot create GPU device: %s\n", SDL_GetError());
+        SDL_ShaderCross_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    log_msg("Headless: GPU device created (driver: %s)",
+            SDL_GetGPUDeviceDriver(gpu_device));
+
+    /* PlayerState is large (subtitle rings, queues) — keep it off the stack */
+    PlayerState *ps = calloc(1, sizeof(PlayerState));
+    if (!ps) {
+        SDL_DestroyGPUDevice(gpu_device);
+        SDL_ShaderCross_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    ps->headless   = 1;
+    ps->gpu_device = gpu_device;
+    ps->volume     = 1.00;
+    ps->video_stream_idx = -1;
+    ps->audio_stream_idx = -1;
+    ps->sub_active_idx   = -1;
+    ps->hdr_target_idx = 0;
+    ps->gpu_uniforms.hdr_target_nits = 203.0f;
+    ps->gpu_uniforms.hdr_midtone_gain = 1.3f;
+
+    int rc = 1;
+    SDL_GPUTexture        *target   = NULL;
+    SDL_GPUTransferBuffer *readback = NULL;
+
+    if (gpu_create_pipelines(ps) < 0) {
+        fprintf(stderr, "[DSVP] GPU pipeline creation failed\n");
+        goto done;
+    }
+
+    if (player_open(ps, path) != 0) {
+        fprintf(stderr, "[DSVP] Failed to open: %s\n", path);
+        goto done;
+    }
+
+    /* ── Offscreen target + readback buffer (video resolution) ── */
+    {
+        SDL_GPUTextureCreateInfo ti;
+        SDL_zero(ti);
+        ti.type                 = SDL_GPU_TEXTURETYPE_2D;
+        ti.format               = ps->gpu_target_format;
+        ti.usage                = SDL_GPU_TEXTUREUSAGE_COLOR_TARGET;
+        ti.width                = ps->vid_w;
+        ti.height               = ps->vid_h;
+        ti.layer_count_or_depth = 1;
+        ti.num_levels           = 1;
+        target = SDL_CreateGPUTexture(gpu_device, &ti);
+
+        SDL_GPUTransferBufferCreateInfo bi;
+        SDL_zero(bi);
+        bi.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+        bi.size  = (Uint32)ps->vid_w * ps->vid_h * 4;
+        readback = SDL_CreateGPUTransferBuffer(gpu_device, &bi);
+
+        if (!target || !readback) {
+            fprintf(stderr, "[DSVP] Cannot create offscreen target: %s\n",
+                    SDL_GetError());
+            goto close;
+        }
+    }
+
+    /* ── Render loop: pull frames as fast as decode delivers them ── */
+    int    frames = 0;
+    double sum[3] = { 0.0, 0.0, 0.0 };
+    double t_start = get_time_sec();
+
+    while (max_frames <= 0 || frames < max_frames) {
+        if (!video_next_frame(ps)) {
+            if (ps->eof && ps->video_eof && ps->video_fq.count == 0 &&
+                pq_nb_packets(&ps->video_pq) == 0)
+                break;
+            SDL_Delay(1);
+            continue;
+        }
+
+        double   timings[3];
+        uint64_t hash;
+        if (video_render_offscreen(ps, target, readback, timings, &hash) < 0) {
+            fprintf(stderr, "[DSVP] Offscreen render failed at frame %d: %s\n",
+                    frames, SDL_GetError());
+            goto close;
+        }
+
+        printf("frame %d pts=%.3f hash=%016llx upload=%.2fms draw=%.2fms readback=%.2fms\n",
+               frames, ps->video_clock, (unsigned long long)hash,
+               timings[0], timings[1], timings[2]);
+
+        for (int i = 0; i < 3; i++) sum[i] += timings[i];
+        frames++;
+        ps->diag_frames_displayed++;
+    }
+
+    double wall = get_time_sec() - t_start;
+    printf("summary frames=%d wall=%.3fs fps=%.2f "
+           "avg_upload=%.2fms avg_draw=%.2fms avg_readback=%.2fms\n",
+           frames, wall, wall > 0.0 ? frames / wall : 0.0,
+           frames ? sum[0] / frames : 0.0,
+           frames ? sum[1] / frames : 0.0,
+           frames ? sum[2] / frames : 0.0);
+    fflush(stdout);
+    log_msg("Headless: %d frames in %.3fs (%.2f fps)",
+            frames, wall, wall > 0.0 ? frames / wall : 0.0);
+    rc = 0;
+
+close:
+    player_close(ps);
+done:
+    if (readback) SDL_ReleaseGPUTransferBuffer(gpu_device, readback);
+    if (target)   SDL_ReleaseGPUTexture(gpu_device, target);
+    gpu_destroy_pipelines(ps);
+    free(ps);
+    SDL_DestroyGPUDevice(gpu_device);
+    SDL_ShaderCross_Quit();
+    SDL_Quit();
+    return rc;
+}
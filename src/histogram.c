@@ -0,0 +1,279 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * histogram.c — SIMD luma histogram kernels (CPU HDR peak fallback)
+ *
+ * Builds a 256-bin histogram of a full-resolution luma plane for
+ * hdr_compute_scene_peak() when the GPU compute histogram is not
+ * available.
+ *
+ * Two tricks keep the scalar increment loop off the critical path:
+ *
+ *   - Four sub-histograms. Consecutive samples go to different tables,
+ *     so a run of identical values (flat black, letterbox bars) does not
+ *     serialize on a store-to-load dependency through one counter.
+ *     The tables are summed once per plane.
+ *
+ *   - Gather-free bin extraction. Samples are loaded a vector at a time;
+ *     10-bit samples are shifted to 8 bits and packed with unsigned
+ *     saturation (out-of-range codes clamp to bin 255 for free). The
+ *     packed bytes then move to general registers 64 bits at a time and
+ *     are peeled off with shifts — no per-sample loads or gathers.
+ *
+ * Kernels: scalar (always), SSE2 + AVX2 (x86-64), NEON (ARM64). The best
+ * available one is picked at first use from SDL's CPU feature checks;
+ * hist_kernel_select() overrides it for --bench-hist.
+ */
+
+#include "dsvp.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define HIST_X86 1
+  #include <emmintrin.h>
+  #include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define HIST_NEON 1
+  #include <arm_neon.h>
+#endif
+
+/* GCC/Clang: compile AVX2 kernels without raising the global -march */
+#if defined(HIST_X86) && (defined(__GNUC__) || defined(__clang__))
+  #define HIST_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+  #define HIST_TARGET_AVX2
+#endif
+
+typedef uint32_t HistSub[4][256];
+
+typedef void (*HistRowFn)(const uint8_t *src, int n, HistSub sub);
+
+typedef struct HistKernel {
+    const char *name;
+    HistRowFn   row_u8;     /* n uint8 samples            */
+    HistRowFn   row_u10;    /* n uint16 samples (10-bit)  */
+    int       (*available)(void);
+} HistKernel;
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Scalar
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Count the 8 bins packed in `b` across the four sub-histograms. */
+static inline void hist_bytes8(uint64_t b, HistSub sub) {
+    sub[0][ b        & 0xff]++;
+    sub[1][(b >>  8) & 0xff]++;
+    sub[2][(b >> 16) & 0xff]++;
+    sub[3][(b >> 24) & 0xff]++;
+    sub[0][(b >> 32) & 0xff]++;
+    sub[1][(b >> 40) & 0xff]++;
+    sub[2][(b >> 48) & 0xff]++;
+    sub[3][ b >> 56        ]++;
+}
+
+static inline unsigned hist_bin10(uint16_t v) {
+    unsigned bin = v >> 2;
+    return bin > 255 ? 255 : bin;
+}
+
+static void hist_row_u8_scalar(const uint8_t *src, int n, HistSub sub) {
+    int x = 0;
+    for (; x + 4 <= n; x += 4) {
+        sub[0][src[x    ]]++;
+        sub[1][src[x + 1]]++;
+        sub[2][src[x + 2]]++;
+        sub[3][src[x + 3]]++;
+    }
+    for (; x < n; x++)
+        sub[0][src[x]]++;
+}
+
+static void hist_row_u10_scalar(const uint8_t *src8, int n, HistSub sub) {
+    const uint16_t *src = (const uint16_t *)src8;
+    int x = 0;
+    for (; x + 4 <= n; x += 4) {
+        sub[0][hist_bin10(src[x    ])]++;
+        sub[1][hist_bin10(src[x + 1])]++;
+        sub[2][hist_bin10(src[x + 2])]++;
+        sub[3][hist_bin10(src[x + 3])]++;
+    }
+    for (; x < n; x++)
+        sub[0][hist_bin10(src[x])]++;
+}
+
+static int hist_always(void) { return 1; }
+
+/* ═══════════════════════════════════════════════════════════════════
+ * SSE2 / AVX2 (x86-64)
+ * ═══════════════════════════════════════════════════════════════════ */
+
+#ifdef HIST_X86
+
+static int hist_has_sse2(void) { return SDL_HasSSE2(); }
+static int hist_has_avx2(void) { return SDL_HasAVX2(); }
+
+static void hist_row_u8_sse2(const uint8_t *src, int n, HistSub sub) {
+    int x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + x));
+        hist_bytes8((uint64_t)_mm_cvtsi128_si64(v), sub);
+        hist_bytes8((uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)), sub);
+    }
+    hist_row_u8_scalar(src + x, n - x, sub);
+}
+
+static void hist_row_u10_sse2(const uint8_t *src8, int n, HistSub sub) {
+    const uint16_t *src = (const uint16_t *)src8;
+    int x = 0;
+    for (; x + 16 <= n; x += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + x));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + x + 8));
+        /* 10 → 8 bits; packus saturates anything above 1023 to 255 */
+        __m128i v = _mm_packus_epi16(_mm_srli_epi16(a, 2), _mm_srli_epi16(b, 2));
+        hist_bytes8((uint64_t)_mm_cvtsi128_si64(v), sub);
+        hist_bytes8((uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v)), sub);
+    }
+    hist_row_u10_scalar((const uint8_t *)(src + x), n - x, sub);
+}
+
+HIST_TARGET_AVX2
+static void hist_row_u8_avx2(const uint8_t *src, int n, HistSub sub) {
+    int x = 0;
+    for (; x + 32 <= n; x += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + x));
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 0), sub);
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 1), sub);
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 2), sub);
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 3), sub);
+    }
+    hist_row_u8_scalar(src + x, n - x, sub);
+}
+
+HIST_TARGET_AVX2
+static void hist_row_u10_avx2(const uint8_t *src8, int n, HistSub sub) {
+    const uint16_t *src = (const uint16_t *)src8;
+    int x = 0;
+    for (; x + 32 <= n; x += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + x + 16));
+        /* packus works per 128-bit lane, so bytes come out interleaved —
+         * irrelevant for a histogram, no permute needed. */
+        __m256i v = _mm256_packus_epi16(_mm256_srli_epi16(a, 2),
+                                        _mm256_srli_epi16(b, 2));
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 0), sub);
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 1), sub);
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 2), sub);
+        hist_bytes8((uint64_t)_mm256_extract_epi64(v, 3), sub);
+    }
+    hist_row_u10_scalar((const uint8_t *)(src + x), n - x, sub);
+}
+
+#endif /* HIST_X86 */
+
+/* ═══════════════════════════════════════════════════════════════════
+ * NEON (ARM64)
+ * ═══════════════════════════════════════════════════════════════════ */
+
+#ifdef HIST_NEON
+
+static int hist_has_neon(void) { return SDL_HasNEON(); }
+
+static void hist_row_u8_neon(const uint8_t *src, int n, HistSub sub) {
+    int x = 0;
+    for (; x + 16 <= n; x += 16) {
+        uint64x2_t v = vreinterpretq_u64_u8(vld1q_u8(src + x));
+        hist_bytes8(vgetq_lane_u64(v, 0), sub);
+        hist_bytes8(vgetq_lane_u64(v, 1), sub);
+    }
+    hist_row_u8_scalar(src + x, n - x, sub);
+}
+
+static void hist_row_u10_neon(const uint8_t *src8, int n, HistSub sub) {
+    const uint16_t *src = (const uint16_t *)src8;
+    int x = 0;
+    for (; x + 16 <= n; x += 16) {
+        /* 10 → 8 bits with saturating narrow (clamps >1023 to 255) */
+        uint8x8_t a = vqmovn_u16(vshrq_n_u16(vld1q_u16(src + x), 2));
+        uint8x8_t b = vqmovn_u16(vshrq_n_u16(vld1q_u16(src + x + 8), 2));
+        hist_bytes8(vget_lane_u64(vreinterpret_u64_u8(a), 0), sub);
+        hist_bytes8(vget_lane_u64(vreinterpret_u64_u8(b), 0), sub);
+    }
+    hist_row_u10_scalar((const uint8_t *)(src + x), n - x, sub);
+}
+
+#endif /* HIST_NEON */
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Dispatch
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Ordered slowest → fastest; auto-select takes the last available. */
+static const HistKernel s_kernels[] = {
+    { "scalar", hist_row_u8_scalar, hist_row_u10_scalar, hist_always   },
+#ifdef HIST_X86
+    { "sse2",   hist_row_u8_sse2,   hist_row_u10_sse2,   hist_has_sse2 },
+    { "avx2",   hist_row_u8_avx2,   hist_row_u10_avx2,   hist_has_avx2 },
+#endif
+#ifdef HIST_NEON
+    { "neon",   hist_row_u8_neon,   hist_row_u10_neon,   hist_has_neon },
+#endif
+};
+#define HIST_NUM_KERNELS ((int)(sizeof(s_kernels) / sizeof(s_kernels[0])))
+
+static const HistKernel *s_active = NULL;
+
+/* Number of kernels compiled in (not all may run on this CPU). */
+int hist_kernel_count(void) {
+    return HIST_NUM_KERNELS;
+}
+
+const char *hist_kernel_name(int idx) {
+    if (idx < 0 || idx >= HIST_NUM_KERNELS) return NULL;
+    return s_kernels[idx].name;
+}
+
+int hist_kernel_available(int idx) {
+    if (idx < 0 || idx >= HIST_NUM_KERNELS) return 0;
+    return s_kernels[idx].available();
+}
+
+/* Select kernel `idx`, or the fastest available if idx < 0.
+ * Returns the selected index, or -1 if idx is not available here. */
+int hist_kernel_select(int idx) {
+    if (idx < 0) {
+        for (idx = HIST_NUM_KERNELS - 1; idx > 0; idx--)
+            if (s_kernels[idx].available()) break;
+    } else if (!hist_kernel_available(idx)) {
+        return -1;
+    }
+    if (s_active != &s_kernels[idx])
+        log_msg("Histogram: %s kernel", s_kernels[idx].name);
+    s_active = &s_kernels[idx];
+    return idx;
+}
+
+/* Run `row` over every row of the plane and merge the sub-histograms. */
+static void hist_plane(HistRowFn row, const uint8_t *data, int stride,
+                       int w, int h, uint32_t hist[256])
+{
+    HistSub sub;
+    memset(sub, 0, sizeof(sub));
+    for (int y = 0; y < h; y++)
+        row(data + (size_t)y * stride, w, sub);
+    for (int i = 0; i < 256; i++)
+        hist[i] = sub[0][i] + sub[1][i] + sub[2][i] + sub[3][i];
+}
+
+/* 8-bit luma plane → 256 bins (bin = sample value). */
+void hist_luma_u8(const uint8_t *data, int stride, int w, int h,
+                  uint32_t hist[256])
+{
+    if (!s_active) hist_kernel_select(-1);
+    hist_plane(s_active->row_u8, data, stride, w, h, hist);
+}
+
+/* 10-bit luma plane (uint16, LSB-aligned) → 256 bins (bin = code >> 2). */
+void hist_luma_u10(const uint8_t *data, int stride, int w, int h,
+                   uint32_t hist[256])
+{
+    if (!s_active) hist_kernel_select(-1);
+    hist_plane(s_active->row_u10, data, stride, w, h, hist);
+}
@@ -350,9 +350,6 @@ static void gpu_draw_idle(PlayerState *ps) {
     SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
     if (!cmd) return;
 
-    /* Upload overlay texture if dirty */
-    gpu_overlay_copy_cmd(cmd, ps);
-
     SDL_GPUTexture *swapchain_tex = NULL;
     Uint32 sc_w, sc_h;
     if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmd, ps->window,
@@ -365,6 +362,10 @@ static void gpu_draw_idle(PlayerState *ps) {
         return;
     }
 
+    /* Upload overlay texture if dirty (after the acquire: a cancelled
+     * command buffer would drop the partial upload) */
+    gpu_overlay_copy_cmd(cmd, ps);
+
     /* Dark background — same color as old idle screen (24, 24, 28) */
     SDL_GPUColorTargetInfo color_target;
     SDL_zero(color_target);
@@ -401,20 +402,145 @@ int main(int argc, char *argv[]) {
      * non-ASCII characters (accents, CJK, fullwidth punctuation).
      * Use GetCommandLineW → CommandLineToArgvW → UTF-8 conversion. */
     char *open_path = NULL;
+    int   headless  = 0;      /* --headless <file> [--frames N] */
+    int   bench     = 0;      /* --bench-decode <file> [--frames N] */
+    int   bench_hist = 0;     /* --bench-hist [--frames N] */
+    int   bench_blend = 0;    /* --bench-blend [--frames N] */
+    int   bench_downmix = 0;  /* --bench-downmix [--frames N] */
+    int   bench_audio = 0;    /* --bench-audio <file> [--frames N] */
+    int   calibrate = 0;      /* --calibrate <file> */
+    int   max_frames = 0;
+    char *spdif_out  = NULL;  /* --spdif-dump <out> <file> */
+    AudioMode audio_mode = AUDIO_MODE_PCM;  /* --audio-mode pcm|auto|passthrough */
+    SyncMode  sync_mode  = SYNC_AUDIO;      /* --sync audio|display */
 #ifdef _WIN32
     {
         int wargc = 0;
         LPWSTR *wargv = CommandLineToArgvW(GetCommandLineW(), &wargc);
-        if (wargv && wargc > 1) {
-            open_path = win_wide_to_utf8(wargv[1]);
+        for (int i = 1; wargv && i < wargc; i++) {
+            if (wcscmp(wargv[i], L"--headless") == 0) {
+                headless = 1;
+            } else if (wcscmp(wargv[i], L"--bench-decode") == 0) {
+                bench = 1;
+            } else if (wcscmp(wargv[i], L"--bench-hist") == 0) {
+                bench_hist = 1;
+            } else if (wcscmp(wargv[i], L"--bench-blend") == 0) {
+                bench_blend = 1;
+            } else if (wcscmp(wargv[i], L"--bench-downmix") == 0) {
+                bench_downmix = 1;
+            } else if (wcscmp(wargv[i], L"--bench-audio") == 0) {
+                bench_audio = 1;
+            } else if (wcscmp(wargv[i], L"--calibrate") == 0) {
+                calibrate = 1;
+            } else if (wcscmp(wargv[i], L"--frames") == 0 && i + 1 < wargc) {
+                max_frames = _wtoi(wargv[++i]);
+            } else if (wcscmp(wargv[i], L"--spdif-dump") == 0 && i + 1 < wargc) {
+                spdif_out = win_wide_to_utf8(wargv[++i]);
+            } else if (wcscmp(wargv[i], L"--audio-mode") == 0 && i + 1 < wargc) {
+                i++;
+                audio_mode = wcscmp(wargv[i], L"passthrough") == 0 ? AUDIO_MODE_PASSTHROUGH
+                           : wcscmp(wargv[i], L"auto") == 0        ? AUDIO_MODE_AUTO
+                                                                   : AUDIO_MODE_PCM;
+            } else if (wcscmp(wargv[i], L"--sync") == 0 && i + 1 < wargc) {
+                sync_mode = wcscmp(wargv[++i], L"display") == 0 ? SYNC_DISPLAY : SYNC_AUDIO;
+            } else if (!open_path) {
+                open_path = win_wide_to_utf8(wargv[i]);
+            }
         }
         if (wargv) LocalFree(wargv);
     }
 #else
-    if (argc > 1)
-        open_path = strdup(argv[1]);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            headless = 1;
+        } else if (strcmp(argv[i], "--bench-decode") == 0) {
+            bench = 1;
+        } else if (strcmp(argv[i], "--bench-hist") == 0) {
+            bench_hist = 1;
+        } else if (strcmp(argv[i], "--bench-blend") == 0) {
+            bench_blend = 1;
+        } else if (strcmp(argv[i], "--bench-downmix") == 0) {
+            bench_downmix = 1;
+        } else if (strcmp(argv[i], "--bench-audio") == 0) {
+            bench_audio = 1;
+        } else if (strcmp(argv[i], "--calibrate") == 0) {
+            calibrate = 1;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            max_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--spdif-dump") == 0 && i + 1 < argc) {
+            spdif_out = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--audio-mode") == 0 && i + 1 < argc) {
+            i++;
+            audio_mode = strcmp(argv[i], "passthrough") == 0 ? AUDIO_MODE_PASSTHROUGH
+                       : strcmp(argv[i], "auto") == 0        ? AUDIO_MODE_AUTO
+                                                             : AUDIO_MODE_PCM;
+        } else if (strcmp(argv[i], "--sync") == 0 && i + 1 < argc) {
+            sync_mode = strcmp(argv[++i], "display") == 0 ? SYNC_DISPLAY : SYNC_AUDIO;
+        } else if (!open_path) {
+            open_path = strdup(argv[i]);
+        }
+    }
 #endif
 
+    /* ── Histogram kernel microbenchmark (no file, --frames = iterations) ── */
+    if (bench_hist) {
+        int rc = bench_hist_run(max_frames);
+        free(open_path);
+        log_close();
+        return rc;
+    }
+
+    /* ── Overlay blend kernel microbenchmark (same conventions) ── */
+    if (bench_blend) {
+        int rc = bench_blend_run(max_frames);
+        free(open_path);
+        log_close();
+        return rc;
+    }
+
+    /* ── Downmix kernel microbenchmark (same conventions) ── */
+    if (bench_downmix) {
+        int rc = bench_downmix_run(max_frames);
+        free(open_path);
+        log_close();
+        return rc;
+    }
+
+    /* ── IEC 61937 burst dump (no SDL at all) ── */
+    if (spdif_out) {
+        int rc = 1;
+        if (open_path)
+            rc = bitstream_dump_run(open_path, spdif_out);
+        else
+            fprintf(stderr, "usage: dsvp --spdif-dump <out> <file>\n");
+        free(spdif_out);
+        free(open_path);
+        log_close();
+        return rc;
+    }
+
+    /* ── Headless modes (no window, no audio) ──
+     * --headless renders offscreen; --bench-decode stops at the decoder;
+     * --bench-audio adds each audio track's decode load to it;
+     * --calibrate re-measures the file's decoder thread class. */
+    if (headless || bench || bench_audio || calibrate) {
+        if (!open_path) {
+            fprintf(stderr, "usage: dsvp --headless <file> [--frames N]\n"
+                            "       dsvp --bench-decode <file> [--frames N]\n"
+                            "       dsvp --bench-audio <file> [--frames N]\n"
+                            "       dsvp --calibrate <file>\n");
+            log_close();
+            return 1;
+        }
+        int rc = calibrate   ? bench_calibrate_run(open_path)
+               : bench_audio ? bench_audio_run(open_path, max_frames)
+               : bench       ? bench_decode_run(open_path, max_frames)
+                             : headless_run(open_path, max_frames);
+        free(open_path);
+        log_close();
+        return rc;
+    }
+
     /* ── Initialize SDL ── */
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO)) {
         fprintf(stderr, "[DSVP] SDL_Init failed: %s\n", SDL_GetError());
@@ -525,6 +651,9 @@ int main(int argc, char *argv[]) {
     ps.window     = window;
     ps.gpu_device = gpu_device;
     ps.volume     = 1.00;
+    ps.audio_mode = audio_mode;
+    ps.sync_mode  = sync_mode;
+    ps.ds_audio_speed = 1.0;
     ps.video_stream_idx = -1;
     ps.audio_stream_idx = -1;
     ps.sub_active_idx   = -1;
@@ -687,6 +816,22 @@ int main(int argc, char *argv[]) {
                     }
                     break;
 
+                case SDLK_V:  /* Toggle audio-master / display-sync pacing */
+                    if (ps.sync_mode == SYNC_DISPLAY) {
+                        ps.sync_mode      = SYNC_AUDIO;
+                        ps.ds_audio_speed = 1.0;
+                        ps.frame_timer    = get_time_sec();
+                    } else {
+                        ps.sync_mode = SYNC_DISPLAY;
+                        sched_reset(&ps, 0);
+                    }
+                    snprintf(ps.aud_osd, sizeof(ps.aud_osd), "Sync: %s",
+                             ps.sync_mode == SYNC_DISPLAY ? "display" : "audio");
+                    ps.aud_osd_until = get_time_sec() + 2.0;
+                    log_msg("Sync: switched to %s master",
+                            ps.sync_mode == SYNC_DISPLAY ? "display" : "audio");
+                    break;
+
                 case SDLK_G:
                     if (ps.playing && ps.gpu_uniforms.is_hdr > 0.0f) {
                         static const float gains[] = { 1.0f, 1.1f, 1.2f, 1.3f, 1.35f, 1.4f };
@@ -719,7 +864,7 @@ int main(int argc, char *argv[]) {
                 case SDLK_UP:
                     ps.volume += VOLUME_STEP;
                     if (ps.volume > 1.0) ps.volume = 1.0;
-                    if (ps.audio_stream)
+                    if (ps.audio_stream && !ps.bitstream_active)
                         SDL_SetAudioStreamGain(ps.audio_stream, ps.volume);
                     ps.show_seekbar = 1;
                     ps.seekbar_hide_time = get_time_sec() + 1.5;
@@ -728,7 +873,7 @@ int main(int argc, char *argv[]) {
                 case SDLK_DOWN:
                     ps.volume -= VOLUME_STEP;
                     if (ps.volume < 0.0) ps.volume = 0.0;
-                    if (ps.audio_stream)
+                    if (ps.audio_stream && !ps.bitstream_active)
                         SDL_SetAudioStreamGain(ps.audio_stream, ps.volume);
                     ps.show_seekbar = 1;
                     ps.seekbar_hide_time = get_time_sec() + 1.5;
@@ -885,13 +1030,23 @@ int main(int argc, char *argv[]) {
             if (!ps.show_seekbar && !ps.show_debug && !ps.show_info)
                 SDL_HideCursor();
 
-            /* ── Video decode and A/V sync ──
+            /* ── Frame selection and A/V sync ──
+             *
+             * Decoding happens on the video decode thread, which keeps
+             * video_fq topped up. This loop only pops the next frame(s)
+             * when frame_timer says one is due, so an expensive I-frame
+             * no longer blocks event handling or presentation.
              *
              * Two-tier pacing (unchanged from SDL_Renderer version):
              *   1. frame_timer governs WHEN to show a new frame based
              *      on content frame rate.
              *   2. VSync (via GPU swapchain) governs render loop rate.
              *
+             * With --sync display (V), frame_timer is bypassed: frames
+             * advance on whole vsyncs and audio follows video (see
+             * sched.c). In both modes the scheduler scores each shown
+             * frame against the ideal cadence.
+             *
              * video_display() handles the full GPU submission:
              *   copy pass (upload planes) → render pass (shader draw) → submit.
              * video_reblit() re-draws the last frame without uploading. */
@@ -899,182 +1054,208 @@ int main(int argc, char *argv[]) {
             int new_frame = 0;
             int decoded_this_tick = 0;
 
-            /* max_catchup caps burst decodes per VSync tick.
-             * Kept at 4 for all content: at 1:1 (60fps on 60Hz), the
-             * natural (2,0) rhythm self-corrects with max_catchup=4.
-             * For heavy content (4K H.264), the decoder occasionally
-             * needs bursts of 3-4 to recover after expensive I-frames.
-             * max_catchup=2 prevented this, causing accumulated drift
-             * that triggered 100+ snap-forwards and multi-second A/V
-             * desync. max_catchup=4 is the stall recovery safety cap. */
-            int max_catchup = 4;
-            while (now >= ps.frame_timer && max_catchup-- > 0) {
-                int vret = video_decode_frame(&ps);
-                if (vret > 0) {
-                    decoded_this_tick++;
-                    ps.diag_frames_decoded++;
-
-                    /* Compute inter-frame delay from PTS */
-                    double pts_delay = ps.video_clock - ps.frame_last_pts;
-                    if (pts_delay <= 0.0 || pts_delay >= 1.0)
-                        pts_delay = ps.frame_last_delay;
-                    ps.frame_last_pts   = ps.video_clock;
-                    ps.frame_last_delay = pts_delay;
-
-                    /* A/V sync adjustment */
-                    double delay = pts_delay;
-                    double av_diff = 0.0;
-                    double av_diff_c = 0.0;
-                    int one_to_one = 0;
-                    if (ps.audio_stream_idx >= 0) {
-                        av_diff = ps.video_clock - ps.audio_clock_sync;
-
-                        /* Adaptive bias correction: EMA of av_diff
-                         * absorbs systematic OS audio pipeline latency.
-                         * Only the catch-up (negative) branch uses the
-                         * corrected value — the slow-down (positive)
-                         * branch uses raw av_diff to avoid overcorrection. */
-                        if (!ps.seek_recovering) {
-                            ps.av_bias = ps.av_bias * 0.95 + av_diff * 0.05;
-                            ps.av_bias_samples++;
-                        }
-                        av_diff_c = av_diff;
-                        if (ps.av_bias_samples >= 60) {
-                            double bias = ps.av_bias;
-                            if (bias < -0.200) bias = -0.200;
-                            if (bias >  0.200) bias =  0.200;
-                            av_diff_c = av_diff - bias;
-                        }
+            sched_vsync(&ps, now);
 
-                        /* 1:1 VSync pacing: when content frame rate
-                         * matches display refresh (~50-60fps), VSync
-                         * alone provides the pacing heartbeat. Full
-                         * A/V delay correction at 1:1 causes oscillation
-                         * because any jitter triggers multi-decode
-                         * bunching.
-                         *
-                         * Instead, once the bias EMA has converged
-                         * (~2s of playback), apply a micro-correction:
-                         * 2% of the converged bias per frame.  At 50ms
-                         * bias this is ~1ms/frame on a 16.67ms period —
-                         * too small to cause a tick skip, converges in
-                         * ~1 second. */
-                        one_to_one = (pts_delay > 0.001
-                                      && pts_delay < 0.020);
-
-                        double threshold = fmax(pts_delay, 0.01);
-                        if (!one_to_one) {
-                            if (av_diff > threshold) {
-                                delay = pts_delay + av_diff;
-                            } else if (av_diff_c < -threshold) {
-                                delay = 0.0;
+            if (ps.sync_mode == SYNC_DISPLAY) {
+                int ds = sched_tick(&ps);
+                if (ds > 0) {
+                    new_frame = 1;
+                    decoded_this_tick = 1;
+                } else if (ds < 0 && ps.eof && ps.video_eof
+                        && pq_nb_packets(&ps.video_pq) == 0
+                        && ps.video_fq.count == 0
+                        && pq_nb_packets(&ps.audio_pq) == 0) {
+                    log_msg("Playback finished, returning to idle");
+                    player_close(&ps);
+                    ps.quit = 0;
+                }
+            } else {
+                /* max_catchup caps frames consumed per VSync tick.
+                 * Kept at 4 for all content: at 1:1 (60fps on 60Hz), the
+                 * natural (2,0) rhythm self-corrects with max_catchup=4.
+                 * When the decode thread falls behind (4K H.264/HEVC after
+                 * an expensive I-frame), the ring refills and the loop
+                 * consumes a burst of 3-4 ready frames to catch up — cheap
+                 * now, since popping is a pointer move, not a decode.
+                 * max_catchup=4 is the stall recovery safety cap. */
+                int max_catchup = 4;
+                while (now >= ps.frame_timer && max_catchup-- > 0) {
+                    int vret = video_next_frame(&ps);
+                    if (vret > 0) {
+                        decoded_this_tick++;
+                        ps.diag_frames_decoded++;
+
+                        /* Compute inter-frame delay from PTS */
+                        double pts_delay = ps.video_clock - ps.frame_last_pts;
+                        if (pts_delay <= 0.0 || pts_delay >= 1.0)
+                            pts_delay = ps.frame_last_delay;
+                        ps.frame_last_pts   = ps.video_clock;
+                        ps.frame_last_delay = pts_delay;
+
+                        /* A/V sync adjustment */
+                        double delay = pts_delay;
+                        double av_diff = 0.0;
+                        double av_diff_c = 0.0;
+                        int one_to_one = 0;
+                        if (ps.audio_stream_idx >= 0) {
+                            av_diff = ps.video_clock - ps.audio_clock_sync;
+
+                            /* Adaptive bias correction: EMA of av_diff
+                             * absorbs systematic OS audio pipeline latency.
+                             * Only the catch-up (negative) branch uses the
+                             * corrected value — the slow-down (positive)
+                             * branch uses raw av_diff to avoid overcorrection. */
+                            if (!ps.seek_recovering) {
+                                ps.av_bias = ps.av_bias * 0.95 + av_diff * 0.05;
+                                ps.av_bias_samples++;
                             }
-                        } else if (ps.av_bias_samples >= 120) {
-                            /* Micro-correction: nudge frame_timer toward
-                             * audio clock without triggering oscillation */
-                            double bias = ps.av_bias;
-                            if (bias < -0.200) bias = -0.200;
-                            if (bias >  0.200) bias =  0.200;
-                            delay = pts_delay + bias * 0.02;
+                            av_diff_c = av_diff;
+                            if (ps.av_bias_samples >= 60) {
+                                double bias = ps.av_bias;
+                                if (bias < -0.200) bias = -0.200;
+                                if (bias >  0.200) bias =  0.200;
+                                av_diff_c = av_diff - bias;
+                            }
+
+                            /* 1:1 VSync pacing: when content frame rate
+                             * matches display refresh (~50-60fps), VSync
+                             * alone provides the pacing heartbeat. Full
+                             * A/V delay correction at 1:1 causes oscillation
+                             * because any jitter triggers multi-decode
+                             * bunching.
+                             *
+                             * Instead, once the bias EMA has converged
+                             * (~2s of playback), apply a micro-correction:
+                             * 2% of the converged bias per frame.  At 50ms
+                             * bias this is ~1ms/frame on a 16.67ms period —
+                             * too small to cause a tick skip, converges in
+                             * ~1 second. */
+                            one_to_one = (pts_delay > 0.001
+                                          && pts_delay < 0.020);
+
+                            double threshold = fmax(pts_delay, 0.01);
+                            if (!one_to_one) {
+                                if (av_diff > threshold) {
+                                    delay = pts_delay + av_diff;
+                                } else if (av_diff_c < -threshold) {
+                                    delay = 0.0;
+                                }
+                            } else if (ps.av_bias_samples >= 120) {
+                                /* Micro-correction: nudge frame_timer toward
+                                 * audio clock without triggering oscillation */
+                                double bias = ps.av_bias;
+                                if (bias < -0.200) bias = -0.200;
+                                if (bias >  0.200) bias =  0.200;
+                                delay = pts_delay + bias * 0.02;
+                            }
+
+                            if (!ps.seek_recovering
+                                    && ps.av_bias_samples >= 30
+                                    && fabs(av_diff) > fabs(ps.diag_max_av_drift))
+                                ps.diag_max_av_drift = av_diff;
+
+                            /* Falling behind: shed decode work before
+                             * the drops below have to (player.c) */
+                            if (!ps.seek_recovering && ps.av_bias_samples >= 60)
+                                video_late_update(&ps, -av_diff_c, now);
                         }
 
-                        if (!ps.seek_recovering
-                                && ps.av_bias_samples >= 30
-                                && fabs(av_diff) > fabs(ps.diag_max_av_drift))
-                            ps.diag_max_av_drift = av_diff;
-                    }
+                        /* Minimum delay floor */
+                        double min_delay = ps.frame_last_delay * 0.5;
+                        if (delay < min_delay)
+                            delay = min_delay;
 
-                    /* Minimum delay floor */
-                    double min_delay = ps.frame_last_delay * 0.5;
-                    if (delay < min_delay)
-                        delay = min_delay;
+                        ps.frame_timer += delay;
+                        new_frame = 1;
 
-                    ps.frame_timer += delay;
-                    new_frame = 1;
+                        /* Cap: never let frame_timer get more than 100ms ahead
+                         * of wall time.  Post-seek rapid frame consumption
+                         * (catch-up drops with delay≈0) can accumulate
+                         * frame_timer seconds ahead, causing a prolonged
+                         * stall when the burst ends. */
+                        if (ps.frame_timer > now + 0.1)
+                            ps.frame_timer = now + 0.1;
 
-                    /* Cap: never let frame_timer get more than 100ms ahead
-                     * of wall time.  Post-seek rapid frame consumption
-                     * (catch-up drops with delay≈0) can accumulate
-                     * frame_timer seconds ahead, causing a prolonged
-                     * stall when the burst ends. */
-                    if (ps.frame_timer > now + 0.1)
-                        ps.frame_timer = now + 0.1;
-
-                    /* Drop frame if video is genuinely behind audio.
-                     *
-                     * At 1:1 (content fps ≈ display refresh), drops are
-                     * DISABLED. VSync provides the pacing heartbeat and
-                     * the snap-forward handles genuine stalls. The raw
-                     * av_diff at 1:1 includes a fixed pipeline offset
-                     * (decode latency + OS audio buffering) that isn't
-                     * growing drift — the decoder IS keeping up. Dropping
-                     * on that offset replaces smooth 60fps video with a
-                     * frozen frame, which is far worse than the offset.
-                     *
-                     * For non-1:1 content (e.g. 24fps on 60Hz), the
-                     * accumulator-based timing needs active correction,
-                     * so bias-corrected drops still apply at -50ms.
-                     *
-                     * Gate on bias convergence (60 samples ≈ 1–2s):
-                     * before the EMA stabilizes, av_diff is unreliable
-                     * and containers with audio PTS lead (MPEG-PS) would
-                     * trigger spurious drops. Modern containers have
-                     * near-zero av_diff at startup so this gate is a
-                     * no-op for them. */
-                    if (!one_to_one && ps.audio_stream_idx >= 0
-                            && !ps.seek_recovering
-                            && ps.av_bias_samples >= 60) {
-                        double drop_diff = av_diff_c;
-                        if (drop_diff < -0.05) {
-                            new_frame = 0;
-                            ps.diag_frames_dropped++;
-                            log_msg("DIAG: frame dropped at %.3fs "
-                                    "(A/V drift: %.1fms)",
-                                    ps.video_clock, av_diff * 1000.0);
+                        /* Drop frame if video is genuinely behind audio.
+                         *
+                         * At 1:1 (content fps ≈ display refresh), drops are
+                         * DISABLED. VSync provides the pacing heartbeat and
+                         * the snap-forward handles genuine stalls. The raw
+                         * av_diff at 1:1 includes a fixed pipeline offset
+                         * (decode latency + OS audio buffering) that isn't
+                         * growing drift — the decoder IS keeping up. Dropping
+                         * on that offset replaces smooth 60fps video with a
+                         * frozen frame, which is far worse than the offset.
+                         *
+                         * For non-1:1 content (e.g. 24fps on 60Hz), the
+                         * accumulator-based timing needs active correction,
+                         * so bias-corrected drops still apply at -50ms.
+                         *
+                         * Gate on bias convergence (60 samples ≈ 1–2s):
+                         * before the EMA stabilizes, av_diff is unreliable
+                         * and containers with audio PTS lead (MPEG-PS) would
+                         * trigger spurious drops. Modern containers have
+                         * near-zero av_diff at startup so this gate is a
+                         * no-op for them. */
+                        if (!one_to_one && ps.audio_stream_idx >= 0
+                                && !ps.seek_recovering
+                                && ps.av_bias_samples >= 60) {
+                            double drop_diff = av_diff_c;
+                            if (drop_diff < -0.05) {
+                                new_frame = 0;
+                                ps.diag_frames_dropped++;
+                                log_msg("DIAG: frame dropped at %.3fs "
+                                        "(A/V drift: %.1fms)",
+                                        ps.video_clock, av_diff * 1000.0);
+                            }
                         }
+                    } else {
+                        /* Ring empty. At EOF, finish only once the decoder
+                         * has drained its delayed frames into the ring. */
+                        if (ps.eof && ps.video_eof
+                                && pq_nb_packets(&ps.video_pq) == 0
+                                && ps.video_fq.count == 0
+                                && pq_nb_packets(&ps.audio_pq) == 0) {
+                            log_msg("Playback finished, returning to idle");
+                            player_close(&ps);
+                            ps.quit = 0;
+                        }
+                        break;
                     }
-                } else {
-                    if (vret < 0) {
-                        log_msg("Video decode error at clock=%.3f",
-                                ps.video_clock);
-                    } else if (ps.eof && ps.video_pq.nb_packets == 0
-                                    && ps.audio_pq.nb_packets == 0) {
-                        log_msg("Playback finished, returning to idle");
-                        player_close(&ps);
-                        ps.quit = 0;
-                    }
-                    break;
                 }
-            }
 
-            if (decoded_this_tick > 1) {
-                ps.diag_multi_decodes++;
-            }
+                if (decoded_this_tick > 1) {
+                    ps.diag_multi_decodes++;
+                }
 
-            /* Snap forward on extreme stall — but only when the decoder
-             * actually produced frames this tick.  If the queue is empty
-             * (e.g. EOF drain or demux lag), snapping is pointless and
-             * would fire every tick until player_close runs. */
-            if (decoded_this_tick > 0
-                    && ps.frame_timer < now - 0.1) {
-                ps.frame_timer = now;
-                ps.diag_timer_snaps++;
-                log_msg("DIAG: frame_timer snapped forward "
-                        "(stall recovery at %.3fs)", ps.video_clock);
+                /* Snap forward on extreme stall — but only when the decoder
+                 * actually produced frames this tick.  If the queue is empty
+                 * (e.g. EOF drain or demux lag), snapping is pointless and
+                 * would fire every tick until player_close runs. */
+                if (decoded_this_tick > 0
+                        && ps.frame_timer < now - 0.1) {
+                    ps.frame_timer = now;
+                    ps.diag_timer_snaps++;
+                    log_msg("DIAG: frame_timer snapped forward "
+                            "(stall recovery at %.3fs)", ps.video_clock);
+                }
             }
 
             /* Display the last decoded frame via GPU */
             if (new_frame) {
                 video_display(&ps);
                 ps.diag_frames_displayed++;
+                sched_frame_shown(&ps);
 
                 /* Resume from seek: first displayed frame post-seek.
                  *
                  * CRITICAL: re-sync audio clocks to video_clock here.
-                 * av_seek_frame lands on a keyframe that may be seconds
-                 * away from the seek target. The demux thread pre-sets
-                 * both clocks to the target, but the first decoded frame
-                 * overwrites video_clock to the actual keyframe PTS.
+                 * The decode thread drops frames short of the seek target,
+                 * but the first frame shown can still differ from it
+                 * (half a frame of slack, or a gap beyond the discard
+                 * window). The demux thread pre-sets both clocks to the
+                 * target, but the first decoded frame overwrites
+                 * video_clock to its actual PTS.
                  * Without this re-sync:
                  *   Forward seek: video_clock > audio_clock → A/V sync
                  *     computes multi-second delay, freezing the main loop.
@@ -1089,10 +1270,14 @@ int main(int argc, char *argv[]) {
                     ps.audio_clock      = ps.video_clock;
                     ps.audio_clock_sync = ps.video_clock;
                     ps.audio_pts_floor  = ps.video_clock;
+                    ps.audio_ring.floor = ps.video_clock;
+                    ps.audio_ring.floor_slack = 0.05;
                     ps.av_bias          = 0.0;
                     ps.av_bias_samples  = 0;
                     ps.frame_last_pts   = ps.video_clock;
                     ps.diag_max_av_drift = 0.0;
+                    sched_reset(&ps, 0);
+                    video_late_reset(&ps);
 
                     /* Flush stale audio and resume */
                     if (ps.audio_stream) {
@@ -1110,18 +1295,37 @@ int main(int argc, char *argv[]) {
             if (ps.playing && now - ps.diag_last_report >= 10.0) {
                 double av_now = (ps.audio_stream_idx >= 0)
                     ? ps.video_clock - ps.audio_clock_sync : 0.0;
-                log_msg("DIAG: [%.0fs] decoded=%d displayed=%d "
-                        "dropped=%d multi_ticks=%d snaps=%d "
-                        "A/V=%.1fms peak=%.1fms bias=%.1fms",
-                        ps.video_clock,
-                        ps.diag_frames_decoded,
-                        ps.diag_frames_displayed,
-                        ps.diag_frames_dropped,
-                        ps.diag_multi_decodes,
-                        ps.diag_timer_snaps,
-                        av_now * 1000.0,
-                        ps.diag_max_av_drift * 1000.0,
-                        ps.av_bias * 1000.0);
+                if (ps.sync_mode == SYNC_DISPLAY)
+                    log_msg("DIAG: [%.0fs] display sync: decoded=%d displayed=%d "
+                            "dropped=%d repeated=%d off_cadence=%d/%d "
+                            "vsync=%.3fms speed=%.4f A/V=%.1fms peak=%.1fms",
+                            ps.video_clock,
+                            ps.diag_frames_decoded,
+                            ps.diag_frames_displayed,
+                            ps.diag_frames_dropped,
+                            ps.diag_frames_repeated,
+                            ps.sched.off_cadence,
+                            ps.sched.frames,
+                            ps.sched.vsync * 1000.0,
+                            ps.ds_audio_speed,
+                            av_now * 1000.0,
+                            ps.diag_max_av_drift * 1000.0);
+                else
+                    log_msg("DIAG: [%.0fs] decoded=%d displayed=%d "
+                            "dropped=%d multi_ticks=%d snaps=%d "
+                            "off_cadence=%d/%d "
+                            "A/V=%.1fms peak=%.1fms bias=%.1fms",
+                            ps.video_clock,
+                            ps.diag_frames_decoded,
+                            ps.diag_frames_displayed,
+                            ps.diag_frames_dropped,
+                            ps.diag_multi_decodes,
+                            ps.diag_timer_snaps,
+                            ps.sched.off_cadence,
+                            ps.sched.frames,
+                            av_now * 1000.0,
+                            ps.diag_max_av_drift * 1000.0,
+                            ps.av_bias * 1000.0);
                 ps.diag_last_report = now;
             }
 
@@ -1156,6 +1360,12 @@ int main(int argc, char *argv[]) {
             SDL_ShowCursor();
         }
 
+        /* Keep the playlist neighbours opened ahead (N/B) */
+        preopen_poll(&ps, get_time_sec());
+
+        /* Measure a newly met decoder class while nothing is playing */
+        calib_poll(!ps.playing || ps.paused, get_time_sec());
+
         /* Don't burn CPU when idle or paused */
         if (!ps.playing || ps.paused) {
             SDL_Delay(16); /* ~60fps idle */
@@ -1165,6 +1375,8 @@ int main(int argc, char *argv[]) {
     /* ── Cleanup ── */
     log_msg("Shutting down");
     if (ps.playing) player_close(&ps);
+    calib_shutdown();
+    preopen_clear(&ps);
     playlist_free(&ps);
     overlay_cleanup();
     sub_close_font();
@@ -15,6 +15,10 @@
  *   - Pause indicator
  *   - Track-change / volume OSD
  *   - Subtitles (SDL_ttf rendered)
+ *
+ * Bitmap subtitles (PGS, VobSub, DVB) are not drawn here: they are
+ * handed to the GPU subtitle layer in player.c and drawn as scaled
+ * quads on top of this texture.
  */
 
 #include "dsvp.h"
@@ -142,6 +146,143 @@ static int       s_dirty_y1 = 0;  /* last dirty row (exclusive)  */
 static int       s_frame_y0 = 0;  /* current frame accumulator   */
 static int       s_frame_y1 = 0;
 
+/* Damage bands for the GPU upload: the buffer is split into bands of
+ * OVERLAY_BAND_ROWS rows. A band can only change if it was painted this
+ * frame or last frame (then it was cleared), and of those only bands
+ * whose content hash moved are sent to the GPU. With just the seek bar
+ * up at 4K that is a few bands (~1-2 MB) instead of 33 MB, and nothing
+ * at all on frames where the overlay looks the same. */
+#define BAND_PAINTED   1          /* painted this frame           */
+#define BAND_PREV      2          /* painted last frame (cleared) */
+static uint8_t  *s_band_paint  = NULL;
+static uint64_t *s_band_hash   = NULL;   /* content as last uploaded */
+static int       s_nbands      = 0;
+static int       s_bands_valid = 0;      /* 0 = GPU content unknown  */
+
+/* Record rows [y0, y1) as painted this frame (clear + upload tracking). */
+static void mark_rows(int y0, int y1) {
+    if (y1 <= y0) return;
+    if (y0 < s_frame_y0) s_frame_y0 = y0;
+    if (y1 > s_frame_y1) s_frame_y1 = y1;
+    int b1 = (y1 - 1) / OVERLAY_BAND_ROWS;
+    if (b1 >= s_nbands) b1 = s_nbands - 1;
+    for (int b = y0 / OVERLAY_BAND_ROWS; b <= b1; b++)
+        s_band_paint[b] |= BAND_PAINTED;
+}
+
+/* 64-bit FNV-1a over 8-byte words, chained from h (HASH_SEED to start).
+ * Each step is a bijection of the running state, so a single changed
+ * word always changes the result. Used for damage bands and layer keys. */
+#define HASH_SEED 1469598103934665603ULL
+static uint64_t hash_bytes(uint64_t h, const void *data, size_t bytes) {
+    const uint8_t *p = data;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, 8);
+        h = (h ^ v) * 1099511628211ULL;
+    }
+    for (; i < bytes; i++)
+        h = (h ^ p[i]) * 1099511628211ULL;
+    return h;
+}
+
+static uint64_t hash_str(uint64_t h, const char *s) {
+    return hash_bytes(h, s, strlen(s) + 1);
+}
+
+
+/* Retained layers: each UI element (seek bar, menu bar, debug and info
+ * panels, pause box, OSD) keeps its own RGBA raster covering just its
+ * rectangle, with a key hashed from everything it shows (time string,
+ * volume, panel text, geometry). An element is re-rasterized only when
+ * its key moves; overlay_render() then composites the visible layers
+ * in draw order. When no key moved the buffer and the GPU texture are
+ * already right and the frame does no pixel work at all. */
+typedef struct OverlayLayer {
+    uint64_t  key;          /* content hash of px                */
+    uint8_t  *px;           /* RGBA w×h, alpha 0 where untouched */
+    size_t    cap;          /* px allocation (bytes)             */
+    int       x, y, w, h;   /* rectangle in overlay pixels       */
+} OverlayLayer;
+
+enum { LAYER_SEEKBAR, LAYER_MENUBAR, LAYER_DEBUG, LAYER_INFO,
+       LAYER_PAUSE, LAYER_OSD, LAYER_COUNT };
+
+static OverlayLayer  s_layers[LAYER_COUNT];
+static OverlayLayer *s_target    = NULL;  /* layer being rasterized   */
+static uint64_t      s_frame_key = 0;     /* what s_pixels holds (0 = unknown) */
+
+/* While a layer is being rasterized the primitives draw into it: overlay
+ * coordinates are shifted into the layer and clipped to its size. */
+static inline void target_layer(int *bw, int *bh, int *x, int *y) {
+    if (!s_target) return;
+    *x -= s_target->x;
+    *y -= s_target->y;
+    *bw = s_target->w;
+    *bh = s_target->h;
+}
+
+/* Start rasterizing l at rect (x, y, w, h) for content key. Returns 0
+ * if the layer already holds exactly that (nothing to draw). */
+static int layer_begin(OverlayLayer *l, uint64_t key, int x, int y, int w, int h) {
+    if (w < 0) w = 0;
+    if (h < 0) h = 0;
+    if (l->key == key && l->x == x && l->y == y && l->w == w && l->h == h)
+        return 0;
+
+    size_t bytes = (size_t)w * h * 4;
+    if (bytes > l->cap) {
+        free(l->px);
+        l->px  = malloc(bytes);
+        l->cap = l->px ? bytes : 0;
+    }
+    if (!l->px || bytes == 0) {
+        l->key = 0;
+        l->w = l->h = 0;
+        return 0;
+    }
+    memset(l->px, 0, bytes);
+    l->key = key;
+    l->x = x; l->y = y; l->w = w; l->h = h;
+    s_target = l;
+    return 1;
+}
+
+static void layer_end(void) {
+    s_target = NULL;
+}
+
+/* Copy a layer into the overlay buffer. Pixels the layer drew replace
+ * what is below — the same overwrite fill_rect and draw_char did when
+ * they painted the buffer directly. */
+static void layer_composite(const OverlayLayer *l, uint8_t *buf, int bw, int bh) {
+    if (!l->px || l->w <= 0 || l->h <= 0) return;
+
+    int x0 = (l->x < 0) ? 0 : l->x;
+    int y0 = (l->y < 0) ? 0 : l->y;
+    int x1 = (l->x + l->w > bw) ? bw : l->x + l->w;
+    int y1 = (l->y + l->h > bh) ? bh : l->y + l->h;
+    if (x1 <= x0 || y1 <= y0) return;
+    mark_rows(y0, y1);
+
+    for (int y = y0; y < y1; y++) {
+        const uint8_t *sp = l->px + ((size_t)(y - l->y) * l->w + (x0 - l->x)) * 4;
+        uint8_t *dp = buf + ((size_t)y * bw + x0) * 4;
+        for (int x = x0; x < x1; x++, sp += 4, dp += 4)
+            if (sp[3]) memcpy(dp, sp, 4);
+    }
+}
+
+static void layers_free(void) {
+    for (int i = 0; i < LAYER_COUNT; i++) {
+        free(s_layers[i].px);
+        memset(&s_layers[i], 0, sizeof(s_layers[i]));
+    }
+    s_target    = NULL;
+    s_frame_key = 0;
+}
+
 
 /* ═══════════════════════════════════════════════════════════════════
  * Pixel Drawing Primitives
@@ -156,13 +297,13 @@ static int       s_frame_y1 = 0;
 static void fill_rect(uint8_t *buf, int bw, int bh,
                       int rx, int ry, int rw, int rh,
                       uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    target_layer(&bw, &bh, &rx, &ry);
     int x1 = (rx < 0) ? 0 : rx;
     int y1 = (ry < 0) ? 0 : ry;
     int x2 = (rx + rw > bw) ? bw : rx + rw;
     int y2 = (ry + rh > bh) ? bh : ry + rh;
 
-    if (y1 < s_frame_y0) s_frame_y0 = y1;
-    if (y2 > s_frame_y1) s_frame_y1 = y2;
+    if (!s_target) mark_rows(y1, y2);
 
     int stride = bw * 4;
     for (int py = y1; py < y2; py++) {
@@ -186,9 +327,9 @@ static void draw_char(uint8_t *buf, int bw, int bh,
     if (ch < FONT_FIRST || ch > FONT_LAST) return;
     const uint8_t *glyph = font_5x7[ch - FONT_FIRST];
 
+    target_layer(&bw, &bh, &x, &y);
     int y_end = y + FONT_H * scale;
-    if (y < s_frame_y0) s_frame_y0 = (y < 0) ? 0 : y;
-    if (y_end > s_frame_y1) s_frame_y1 = (y_end > bh) ? bh : y_end;
+    if (!s_target) mark_rows((y < 0) ? 0 : y, (y_end > bh) ? bh : y_end);
 
     int stride = bw * 4;
     for (int row = 0; row < FONT_H; row++) {
@@ -265,67 +406,91 @@ static int text_height(const char *text, int scale) {
  * SDL_Surface Blit (for TTF subtitle rendering)
  * ═══════════════════════════════════════════════════════════════════ */
 
+/* Alpha-composite an RGBA32 block over an RGBA32 buffer at (x, y),
+ * clipped to the buffer. Straight (non-premultiplied) alpha on both;
+ * the per-row work is blend_over_row() (blend.c). */
+static void blend_rgba(uint8_t *dst, int dw, int dh, int dpitch,
+                       const uint8_t *src, int sw, int sh, int spitch,
+                       int x, int y) {
+    int x0 = (x < 0) ? 0 : x;
+    int x1 = (x + sw > dw) ? dw : x + sw;
+    if (x1 <= x0) return;
+
+    for (int sy = 0; sy < sh; sy++) {
+        int dy = y + sy;
+        if (dy < 0 || dy >= dh) continue;
+        blend_over_row(dst + (size_t)dy * dpitch + x0 * 4,
+                       src + (size_t)sy * spitch + (x0 - x) * 4, x1 - x0);
+    }
+}
+
+
+/* Composite one SDL_Surface over another RGBA32 surface (no dirty
+ * tracking — used to build cached subtitle images). */
+static void surface_over(SDL_Surface *dst, SDL_Surface *src, int x, int y) {
+    if (!dst || !src) return;
+    SDL_Surface *rgba = (src->format == SDL_PIXELFORMAT_RGBA32)
+        ? src : SDL_ConvertSurface(src, SDL_PIXELFORMAT_RGBA32);
+    if (!rgba) return;
+    blend_rgba(dst->pixels, dst->w, dst->h, dst->pitch,
+               rgba->pixels, rgba->w, rgba->h, rgba->pitch, x, y);
+    if (rgba != src) SDL_DestroySurface(rgba);
+}
+
+
 /* Blit an SDL_Surface onto the overlay pixel buffer with alpha blending.
- * Used for TTF-rendered subtitle text. */
+ * Used for TTF-rendered subtitle text. RGBA32 surfaces (the subtitle
+ * cache) go straight through; anything else is converted first. */
 static void blit_surface(uint8_t *buf, int bw, int bh,
                          SDL_Surface *surf, int dst_x, int dst_y) {
     if (!surf) return;
 
-    /* Convert to our RGBA byte order */
-    SDL_Surface *rgba = SDL_ConvertSurface(surf, SDL_PIXELFORMAT_RGBA32);
+    SDL_Surface *rgba = (surf->format == SDL_PIXELFORMAT_RGBA32)
+        ? surf : SDL_ConvertSurface(surf, SDL_PIXELFORMAT_RGBA32);
     if (!rgba) return;
 
     int y0 = (dst_y < 0) ? 0 : dst_y;
     int y1 = dst_y + rgba->h;
     if (y1 > bh) y1 = bh;
-    if (y0 < s_frame_y0) s_frame_y0 = y0;
-    if (y1 > s_frame_y1) s_frame_y1 = y1;
+    mark_rows(y0, y1);
 
-    int stride = bw * 4;
-    for (int sy = 0; sy < rgba->h; sy++) {
-        int dy = dst_y + sy;
-        if (dy < 0 || dy >= bh) continue;
-        uint8_t *src_row = (uint8_t *)rgba->pixels + sy * rgba->pitch;
-        uint8_t *dst_row = buf + dy * stride;
-        for (int sx = 0; sx < rgba->w; sx++) {
-            int dx = dst_x + sx;
-            if (dx < 0 || dx >= bw) continue;
-            uint8_t *sp = src_row + sx * 4;
-            uint8_t sa = sp[3];
-            if (sa == 0) continue;
-            uint8_t *dp = dst_row + dx * 4;
-            if (sa == 255 || dp[3] == 0) {
-                dp[0] = sp[0]; dp[1] = sp[1]; dp[2] = sp[2]; dp[3] = sa;
-            } else {
-                /* Alpha compositing */
-                float sf = sa / 255.0f;
-                float df = dp[3] / 255.0f;
-                float of = sf + df * (1.0f - sf);
-                if (of > 0.0f) {
-                    dp[0] = (uint8_t)((sp[0] * sf + dp[0] * df * (1.0f - sf)) / of);
-                    dp[1] = (uint8_t)((sp[1] * sf + dp[1] * df * (1.0f - sf)) / of);
-                    dp[2] = (uint8_t)((sp[2] * sf + dp[2] * df * (1.0f - sf)) / of);
-                    dp[3] = (uint8_t)(of * 255.0f);
-                }
-            }
-        }
-    }
-    SDL_DestroySurface(rgba);
+    blend_rgba(buf, bw, bh, bw * 4, rgba->pixels, rgba->w, rgba->h, rgba->pitch,
+               dst_x, dst_y);
+    if (rgba != surf) SDL_DestroySurface(rgba);
 }
 
 
 /* Blit raw RGBA pixel data with nearest-neighbor scaling + alpha blend.
- * Used for bitmap subtitle compositing (PGS, VobSub, DVB). */
+ * Used for bitmap subtitle compositing (PGS, VobSub, DVB). Source
+ * columns are mapped once per blit; each row is one
+ * blend_over_row_scaled() call through that map. */
+static int   *s_xmap     = NULL;
+static int    s_xmap_cap = 0;
+
 static void blit_rgba_scaled(uint8_t *buf, int bw, int bh,
                               const uint8_t *src, int sw, int sh,
                               int dst_x, int dst_y, int dst_w, int dst_h) {
     if (!src || sw <= 0 || sh <= 0 || dst_w <= 0 || dst_h <= 0) return;
 
+    int dx0 = (dst_x < 0) ? -dst_x : 0;
+    int dx1 = (dst_x + dst_w > bw) ? bw - dst_x : dst_w;
+    if (dx1 <= dx0) return;
+
+    if (dx1 - dx0 > s_xmap_cap) {
+        int *grown = realloc(s_xmap, (size_t)(dx1 - dx0) * sizeof(*grown));
+        if (!grown) return;
+        s_xmap     = grown;
+        s_xmap_cap = dx1 - dx0;
+    }
+    for (int dx = dx0; dx < dx1; dx++) {
+        int sx = (int)((int64_t)dx * sw / dst_w);
+        s_xmap[dx - dx0] = (sx >= sw) ? sw - 1 : sx;
+    }
+
     int y0 = (dst_y < 0) ? 0 : dst_y;
     int y1 = dst_y + dst_h;
     if (y1 > bh) y1 = bh;
-    if (y0 < s_frame_y0) s_frame_y0 = y0;
-    if (y1 > s_frame_y1) s_frame_y1 = y1;
+    mark_rows(y0, y1);
 
     int stride = bw * 4;
     for (int dy = 0; dy < dst_h; dy++) {
@@ -333,31 +498,8 @@ static void blit_rgba_scaled(uint8_t *buf, int bw, int bh,
         if (py < 0 || py >= bh) continue;
         int sy = dy * sh / dst_h;
         if (sy >= sh) sy = sh - 1;
-        const uint8_t *src_row = src + sy * sw * 4;
-        uint8_t *dst_row = buf + py * stride;
-        for (int dx = 0; dx < dst_w; dx++) {
-            int px = dst_x + dx;
-            if (px < 0 || px >= bw) continue;
-            int sx_val = dx * sw / dst_w;
-            if (sx_val >= sw) sx_val = sw - 1;
-            const uint8_t *sp = src_row + sx_val * 4;
-            uint8_t sa = sp[3];
-            if (sa == 0) continue;
-            uint8_t *dp = dst_row + px * 4;
-            if (sa == 255 || dp[3] == 0) {
-                dp[0] = sp[0]; dp[1] = sp[1]; dp[2] = sp[2]; dp[3] = sa;
-            } else {
-                float sf = sa / 255.0f;
-                float df = dp[3] / 255.0f;
-                float of = sf + df * (1.0f - sf);
-                if (of > 0.0f) {
-                    dp[0] = (uint8_t)((sp[0]*sf + dp[0]*df*(1.0f-sf)) / of);
-                    dp[1] = (uint8_t)((sp[1]*sf + dp[1]*df*(1.0f-sf)) / of);
-                    dp[2] = (uint8_t)((sp[2]*sf + dp[2]*df*(1.0f-sf)) / of);
-                    dp[3] = (uint8_t)(of * 255.0f);
-                }
-            }
-        }
+        blend_over_row_scaled(buf + (size_t)py * stride + (dst_x + dx0) * 4,
+                              src + (size_t)sy * sw * 4, s_xmap, dx1 - dx0);
     }
 }
 
@@ -376,8 +518,11 @@ static int s_ui_scale = 1;
  *
  * Dark semi-transparent bar at bottom of screen.
  * Layout: [time] [==progress track==] [separator] [volume]
- * The progress track is shortened to give volume its own area. */
-static void draw_seekbar(uint8_t *buf, int bw, int bh, PlayerState *ps) {
+ * The progress track is shortened to give volume its own area.
+ * Layout is worked out every frame (the click handler needs the track
+ * geometry); the pixels are redrawn only when the time string, volume,
+ * playhead position or button states change. */
+static void draw_seekbar(int bw, int bh, PlayerState *ps) {
     double duration = (ps->fmt_ctx && ps->fmt_ctx->duration != AV_NOPTS_VALUE)
         ? (double)ps->fmt_ctx->duration / AV_TIME_BASE : 0.0;
     double pos = ps->video_clock;
@@ -389,10 +534,6 @@ static void draw_seekbar(uint8_t *buf, int bw, int bh, PlayerState *ps) {
     int margin = 20 * s_ui_scale;
     int sc = s_ui_scale;  /* shorthand for text scale */
 
-    /* Background bar */
-    fill_rect(buf, bw, bh, 0, bar_y, bw, bar_h, 0, 0, 0, 160);
-
-    /* ── Prev/Next buttons (far left, before time) ── */
     int btn_x = 8 * sc;
     int btn_sz = 8 * sc;         /* triangle bounding box */
     int btn_gap = 10 * sc;       /* gap between buttons */
@@ -401,6 +542,54 @@ static void draw_seekbar(uint8_t *buf, int bw, int bh, PlayerState *ps) {
     int has_next = (ps->playlist_count > 0 &&
                     ps->playlist_index >= 0 &&
                     ps->playlist_index < ps->playlist_count - 1);
+    int btn2_x = btn_x + btn_sz + btn_gap;
+
+    /* Content starts after buttons */
+    int content_x = btn2_x + btn_sz + btn_gap;
+
+    /* Volume area (right side) */
+    char vol_str[16];
+    snprintf(vol_str, sizeof(vol_str), "Vol: %.0f%%", ps->volume * 100.0);
+    int vol_tw = text_width(vol_str, sc);
+    int vol_area_w = vol_tw + margin;  /* right margin included */
+    int vol_x = bw - margin - vol_tw;
+    int sep_x = bw - vol_area_w - 12 * sc;
+
+    /* Time text (after buttons) */
+    int p_h = (int)pos / 3600, p_m = ((int)pos % 3600) / 60, p_s = (int)pos % 60;
+    int d_h = (int)duration / 3600, d_m = ((int)duration % 3600) / 60, d_s = (int)duration % 60;
+
+    char time_str[64];
+    if (d_h > 0 || p_h > 0)
+        snprintf(time_str, sizeof(time_str), "%d:%02d:%02d / %d:%02d:%02d",
+                 p_h, p_m, p_s, d_h, d_m, d_s);
+    else
+        snprintf(time_str, sizeof(time_str), "%d:%02d / %d:%02d",
+                 p_m, p_s, d_m, d_s);
+    int time_tw = text_width(time_str, sc);
+
+    /* Progress track (between time and separator) */
+    int track_x = content_x + time_tw + 12 * sc;
+    int track_w = sep_x - track_x - 12 * sc;
+    int track_y = bar_y + bar_h / 2 - 2 * sc;
+    int track_h = 4 * sc;
+    int fill_w  = (duration > 0.0) ? (int)(track_w * (pos / duration)) : -1;
+
+    /* Export geometry for click handler in main.c */
+    ps->seekbar_track_x = track_x;
+    ps->seekbar_track_w = track_w;
+
+    int state[5] = { sc, has_prev, has_next, fill_w, track_w };
+    uint64_t key = hash_bytes(HASH_SEED, state, sizeof(state));
+    key = hash_str(key, vol_str);
+    key = hash_str(key, time_str);
+
+    OverlayLayer *l = &s_layers[LAYER_SEEKBAR];
+    if (!layer_begin(l, key, 0, bar_y, bw, bar_h)) return;
+    uint8_t *buf = l->px;
+
+    /* Background bar */
+    fill_rect(buf, bw, bh, 0, bar_y, bw, bar_h, 0, 0, 0, 160);
 
     /* Prev button: left-pointing triangle */
     {
@@ -419,7 +608,6 @@ static void draw_seekbar(uint8_t *buf, int bw, int bh, PlayerState *ps) {
     }
 
     /* Next button: right-pointing triangle */
-    int btn2_x = btn_x + btn_sz + btn_gap;
     {
         uint8_t br = has_next ? 200 : 80;
         uint8_t bg = has_next ? 200 : 80;
@@ -434,56 +622,20 @@ static void draw_seekbar(uint8_t *buf, int bw, int bh, PlayerState *ps) {
         }
     }
 
-    /* Content starts after buttons */
-    int content_x = btn2_x + btn_sz + btn_gap;
-
-    /* ── Volume area (right side) ── */
-    char vol_str[16];
-    snprintf(vol_str, sizeof(vol_str), "Vol: %.0f%%", ps->volume * 100.0);
-    int vol_tw = text_width(vol_str, sc);
-    int vol_area_w = vol_tw + margin;  /* right margin included */
-    int vol_x = bw - margin - vol_tw;
-
     /* Separator line */
-    int sep_x = bw - vol_area_w - 12 * sc;
     fill_rect(buf, bw, bh, sep_x, bar_y + 6 * sc, 1 * sc, bar_h - 12 * sc, 100, 100, 100, 160);
 
     draw_text(buf, bw, bh, vol_x, bar_y + (bar_h - FONT_H * sc) / 2,
               vol_str, sc, 180, 180, 180);
 
-    /* ── Time text (after buttons) ── */
-    int p_h = (int)pos / 3600, p_m = ((int)pos % 3600) / 60, p_s = (int)pos % 60;
-    int d_h = (int)duration / 3600, d_m = ((int)duration % 3600) / 60, d_s = (int)duration % 60;
-
-    char time_str[64];
-    if (d_h > 0 || p_h > 0)
-        snprintf(time_str, sizeof(time_str), "%d:%02d:%02d / %d:%02d:%02d",
-                 p_h, p_m, p_s, d_h, d_m, d_s);
-    else
-        snprintf(time_str, sizeof(time_str), "%d:%02d / %d:%02d",
-                 p_m, p_s, d_m, d_s);
-
-    int time_tw = text_width(time_str, sc);
     draw_text(buf, bw, bh, content_x, bar_y + (bar_h - FONT_H * sc) / 2,
               time_str, sc, 200, 200, 200);
 
-    /* ── Progress track (between time and separator) ── */
-    int track_x = content_x + time_tw + 12 * sc;
-    int track_w = sep_x - track_x - 12 * sc;
-    int track_y = bar_y + bar_h / 2 - 2 * sc;
-    int track_h = 4 * sc;
-
-    /* Export geometry for click handler in main.c */
-    ps->seekbar_track_x = track_x;
-    ps->seekbar_track_w = track_w;
-
     if (track_w > 20) {
         fill_rect(buf, bw, bh, track_x, track_y, track_w, track_h, 80, 80, 80, 200);
 
         /* Progress fill */
-        if (duration > 0.0) {
-            double frac = pos / duration;
-            int fill_w = (int)(track_w * frac);
+        if (fill_w >= 0) {
             fill_rect(buf, bw, bh, track_x, track_y, fill_w, track_h,
                       200, 200, 200, 240);
 
@@ -494,21 +646,32 @@ static void draw_seekbar(uint8_t *buf, int bw, int bh, PlayerState *ps) {
             fill_rect(buf, bw, bh, dot_x, dot_y, dot_sz, dot_sz, 240, 240, 240, 255);
         }
     }
+    layer_end();
 }
 
 
 /* ── Debug / Info Overlay ──
  *
  * Multi-line text panel with semi-transparent background box.
- * Both use the same rendering — just different content. */
-static void draw_text_panel(uint8_t *buf, int bw, int bh,
+ * Both use the same rendering — just different content. The debug
+ * text is rebuilt every frame, but most of it is stable between
+ * updates, so the panel only re-rasterizes when the text moves. */
+static void draw_text_panel(OverlayLayer *l, int bw, int bh,
                             const char *text, int x, int y, int scale) {
-    if (!text || !text[0]) return;
+    if (!text || !text[0]) {
+        l->w = l->h = 0;
+        l->key = 0;
+        return;
+    }
 
     int pad = 8;
     int tw = text_width(text, scale);
     int th = text_height(text, scale);
 
+    uint64_t key = hash_str(hash_bytes(HASH_SEED, &scale, sizeof(scale)), text);
+    if (!layer_begin(l, key, x - pad, y - pad, tw + pad * 2, th + pad * 2)) return;
+    uint8_t *buf = l->px;
+
     /* Background box */
     fill_rect(buf, bw, bh,
               x - pad, y - pad,
@@ -517,11 +680,12 @@ static void draw_text_panel(uint8_t *buf, int bw, int bh,
 
     /* Text */
     draw_text(buf, bw, bh, x, y, text, scale, 220, 220, 220);
+    layer_end();
 }
 
 
 /* ── Pause Indicator ── */
-static void draw_pause(uint8_t *buf, int bw, int bh) {
+static void draw_pause(int bw, int bh) {
     const char *msg = "PAUSED";
     int scale = 3;
     int tw = text_width(msg, scale);
@@ -529,18 +693,28 @@ static void draw_pause(uint8_t *buf, int bw, int bh) {
     int x = (bw - tw) / 2;
     int y = (bh - th) / 2;
 
+    OverlayLayer *l = &s_layers[LAYER_PAUSE];
+    if (!layer_begin(l, HASH_SEED, x - 16, y - 12, tw + 32, th + 24)) return;
+    uint8_t *buf = l->px;
+
     fill_rect(buf, bw, bh,
               x - 16, y - 12, tw + 32, th + 24,
               0, 0, 0, 140);
     draw_text(buf, bw, bh, x, y, msg, scale, 200, 200, 200);
+    layer_end();
 }
 
 
 /* ── Track-Change / Volume OSD ──
  *
  * Brief notification centered at top of screen. */
-static void draw_osd(uint8_t *buf, int bw, int bh, const char *text) {
-    if (!text || !text[0]) return;
+static void draw_osd(int bw, int bh, const char *text) {
+    OverlayLayer *l = &s_layers[LAYER_OSD];
+    if (!text || !text[0]) {
+        l->w = l->h = 0;
+        l->key = 0;
+        return;
+    }
 
     int scale = 2;
     int tw = text_width(text, scale);
@@ -548,21 +722,32 @@ static void draw_osd(uint8_t *buf, int bw, int bh, const char *text) {
     int x = (bw - tw) / 2;
     int y = 30;
 
+    if (!layer_begin(l, hash_str(HASH_SEED, text), x - 12, y - 8, tw + 24, th + 16))
+        return;
+    uint8_t *buf = l->px;
+
     fill_rect(buf, bw, bh,
               x - 12, y - 8, tw + 24, th + 16,
               0, 0, 0, 160);
     draw_text(buf, bw, bh, x, y, text, scale, 255, 223, 0);
+    layer_end();
 }
 
 
 /* ── Menu Bar (top) ──
  *
  * Semi-transparent bar at top of screen showing key bindings.
- * Appears with the seek bar, auto-hides together. */
-static void draw_menubar(uint8_t *buf, int bw, int bh) {
+ * Appears with the seek bar, auto-hides together. Fixed content: it
+ * only re-rasterizes on a width or UI scale change. */
+static void draw_menubar(int bw, int bh) {
     int sc = s_ui_scale;
     int bar_h = 22 * sc;
 
+    OverlayLayer *l = &s_layers[LAYER_MENUBAR];
+    if (!layer_begin(l, hash_bytes(HASH_SEED, &sc, sizeof(sc)), 0, 0, bw, bar_h))
+        return;
+    uint8_t *buf = l->px;
+
     /* Background bar */
     fill_rect(buf, bw, bh, 0, 0, bw, bar_h, 0, 0, 0, 140);
 
@@ -601,21 +786,180 @@ static void draw_menubar(uint8_t *buf, int bw, int bh) {
         }
         x += gap;
     }
+    layer_end();
+}
+
+
+/* ── Subtitle cache ──
+ *
+ * A text cue used to be rasterized from scratch every overlay frame:
+ * two TTF_RenderText_Blended calls per line (outline, then fill), each
+ * converted and blended into the overlay. Now the work happens once per
+ * cue:
+ *
+ *   line cache   one RGBA32 surface per line with the outline and fill
+ *                already composited, keyed by (text, size, outline) and
+ *                evicted LRU. Repeated lines (karaoke, rolling captions,
+ *                a cue re-sent after a seek) never hit SDL_ttf again.
+ *   cue image    the whole cue laid out from cached lines. The overlay
+ *                blits just this, once per frame, with no TTF calls.
+ *
+ * Shaping stays with SDL_ttf at line granularity so kerning and the CJK
+ * fallback font come out exactly as before. */
+typedef struct SubLine {
+    char        *text;
+    int          size;       /* font size (pt)                   */
+    int          outline;    /* outline width (px)               */
+    SDL_Surface *surf;       /* outline + fill, RGBA32           */
+    unsigned     used;       /* LRU stamp                        */
+} SubLine;
+
+static SubLine      s_lines[SUB_LINE_CACHE];
+static unsigned     s_line_clock = 0;
+static int          s_font_size  = 0;    /* size last set on the fonts */
+
+static SDL_Surface *s_cue      = NULL;   /* composited cue, RGBA32     */
+static char         s_cue_text[SUB_TEXT_SIZE];
+static int          s_cue_size = 0;      /* 0 = no cue built           */
+static int          s_cue_tw   = 0;      /* widest line (fill px)      */
+static int          s_cue_th   = 0;      /* lines × line skip          */
+static int          s_cue_pad  = 0;      /* outline margin on each side */
+
+static void sub_line_free(SubLine *l) {
+    free(l->text);
+    if (l->surf) SDL_DestroySurface(l->surf);
+    memset(l, 0, sizeof(*l));
+}
+
+/* Rasterize one line: outline at (0,0), fill on top at (oo,oo). */
+static SDL_Surface *sub_line_render(TTF_Font *font, TTF_Font *outline_font,
+                                    const char *text, int oo) {
+    SDL_Color fg      = { 255, 223, 0, 255 };   /* golden yellow */
+    SDL_Color outline = { 0, 0, 0, 255 };
+
+    SDL_Surface *tsurf = TTF_RenderText_Blended(font, text, 0, fg);
+    if (!tsurf) return NULL;
+    SDL_Surface *osurf = outline_font
+        ? TTF_RenderText_Blended(outline_font, text, 0, outline) : NULL;
+
+    int w = oo + tsurf->w, h = oo + tsurf->h;
+    if (osurf && osurf->w > w) w = osurf->w;
+    if (osurf && osurf->h > h) h = osurf->h;
+
+    SDL_Surface *line = SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGBA32);
+    if (line) {
+        SDL_ClearSurface(line, 0.0f, 0.0f, 0.0f, 0.0f);
+        surface_over(line, osurf, 0, 0);
+        surface_over(line, tsurf, oo, oo);
+    }
+    if (osurf) SDL_DestroySurface(osurf);
+    SDL_DestroySurface(tsurf);
+    return line;
+}
+
+static SDL_Surface *sub_line_get(TTF_Font *font, TTF_Font *outline_font,
+                                 const char *text, int size, int oo) {
+    SubLine *victim = &s_lines[0];
+    for (int i = 0; i < SUB_LINE_CACHE; i++) {
+        SubLine *l = &s_lines[i];
+        if (l->text && l->size == size && l->outline == oo &&
+            strcmp(l->text, text) == 0) {
+            l->used = ++s_line_clock;
+            return l->surf;
+        }
+        if (victim->text && (!l->text || l->used < victim->used))
+            victim = l;
+    }
+
+    sub_line_free(victim);
+    victim->surf = sub_line_render(font, outline_font, text, oo);
+    if (!victim->surf) return NULL;
+    victim->text    = strdup(text);
+    victim->size    = size;
+    victim->outline = oo;
+    victim->used    = ++s_line_clock;
+    if (!victim->text) { sub_line_free(victim); return NULL; }
+    return victim->surf;
+}
+
+/* Lay out a cue at font_size into s_cue. Lines are
+ * centred on the widest one, line_skip apart, like the direct path. */
+static void sub_cue_build(const char *text, int font_size) {
+    if (s_cue) { SDL_DestroySurface(s_cue); s_cue = NULL; }
+    snprintf(s_cue_text, sizeof(s_cue_text), "%s", text);
+    s_cue_size = font_size;
+
+    TTF_Font *font = sub_get_font();
+    TTF_Font *outline_font = sub_get_outline_font();
+    if (!font) return;
+
+    if (font_size != s_font_size) {
+        TTF_SetFontSize(font, font_size);
+        if (outline_font)
+            TTF_SetFontSize(outline_font, font_size);
+        s_font_size = font_size;
+    }
+    int oo = outline_font ? TTF_GetFontOutline(outline_font) : 0;
+
+    /* Split text into lines */
+    char text_buf[SUB_TEXT_SIZE];
+    snprintf(text_buf, sizeof(text_buf), "%s", text);
+
+    char *lines[64];
+    int   widths[64];
+    int nlines = 0, max_w = 0;
+    char *tok = strtok(text_buf, "\n");
+    while (tok && nlines < 64) {
+        if (tok[0] != '\0') {
+            int tw = 0, th = 0;
+            TTF_GetStringSize(font, tok, 0, &tw, &th);
+            if (tw > max_w) max_w = tw;
+            widths[nlines] = tw;
+            lines[nlines++] = tok;
+        }
+        tok = strtok(NULL, "\n");
+    }
+    if (nlines == 0 || max_w <= 0) return;
+
+    int line_height = TTF_GetFontLineSkip(font);
+    s_cue_tw  = max_w;
+    s_cue_th  = nlines * line_height;
+    s_cue_pad = oo;
+
+    s_cue = SDL_CreateSurface(max_w + 2 * oo, s_cue_th + 2 * oo,
+                              SDL_PIXELFORMAT_RGBA32);
+    if (!s_cue) return;
+    SDL_ClearSurface(s_cue, 0.0f, 0.0f, 0.0f, 0.0f);
+
+    for (int i = 0; i < nlines; i++) {
+        SDL_Surface *ls = sub_line_get(font, outline_font, lines[i], font_size, oo);
+        surface_over(s_cue, ls, (max_w - widths[i]) / 2, i * line_height);
+    }
+}
+
+static void sub_cache_free(void) {
+    for (int i = 0; i < SUB_LINE_CACHE; i++)
+        sub_line_free(&s_lines[i]);
+    if (s_cue) { SDL_DestroySurface(s_cue); s_cue = NULL; }
+    s_cue_size  = 0;
+    s_font_size = 0;
 }
 
 
 /* ── Subtitles ──
  *
- * Rendered via SDL_ttf for proper Unicode support. The TTF surfaces
- * are blitted onto the overlay pixel buffer. Outline is drawn first
- * (black), then the main text (golden yellow) on top. */
+ * Text cues are rendered via SDL_ttf for proper Unicode support and
+ * cached (see above): black outline and golden-yellow fill composited
+ * once per cue, then one blit per frame. Bitmap cues normally go to the
+ * GPU subtitle layer (sub_layer_update); they are scaled into the pixel
+ * buffer here only if that layer could not take the cue. */
 static void draw_subtitles(uint8_t *buf, int bw, int bh, PlayerState *ps) {
     if (!ps->sub_valid || ps->sub_selection == 0) return;
 
     double now = (ps->audio_stream_idx >= 0) ? ps->audio_clock_sync : ps->video_clock;
     if (now < ps->sub_start_pts || now > ps->sub_end_pts) return;
 
-    /* Bitmap subtitles — scale from canvas coords to overlay pixel buffer */
+    /* Bitmap subtitles (fallback) — scale from canvas coords to overlay pixel buffer */
     if (ps->sub_is_bitmap && ps->sub_bitmap_count > 0) {
         int canvas_w = (ps->sub_codec_ctx && ps->sub_codec_ctx->width > 0)
             ? ps->sub_codec_ctx->width : ps->vid_w;
@@ -646,62 +990,79 @@ static void draw_subtitles(uint8_t *buf, int bw, int bh, PlayerState *ps) {
     }
 
     /* Text subtitles — need the font */
-    TTF_Font *font = sub_get_font();
-    TTF_Font *outline_font = sub_get_outline_font();
-    if (!font || !ps->sub_text[0]) return;
+    if (!sub_get_font() || !ps->sub_text[0]) return;
 
     /* Set font size relative to window height */
     int font_size = bh / 24;
     if (font_size < 14) font_size = 14;
     if (font_size > 54) font_size = 54;
-    TTF_SetFontSize(font, font_size);
-    if (outline_font)
-        TTF_SetFontSize(outline_font, font_size);
 
-    /* Split text into lines */
-    char text_buf[SUB_TEXT_SIZE];
-    snprintf(text_buf, sizeof(text_buf), "%s", ps->sub_text);
+    if (s_cue_size != font_size || strcmp(s_cue_text, ps->sub_text) != 0)
+        sub_cue_build(ps->sub_text, font_size);
+    if (!s_cue) return;
 
-    char *lines[64];
-    int nlines = 0;
-    char *tok = strtok(text_buf, "\n");
-    while (tok && nlines < 64) {
-        if (tok[0] != '\0')
-            lines[nlines++] = tok;
-        tok = strtok(NULL, "\n");
-    }
+    blit_surface(buf, bw, bh, s_cue,
+                 (bw - s_cue_tw) / 2 - s_cue_pad,
+                 bh - 60 - s_cue_th - s_cue_pad);
+}
 
-    int line_height = TTF_GetFontLineSkip(font);
-    int total_h = nlines * line_height;
-    int y_base = bh - 60 - total_h;
+/* Everything draw_subtitles() output depends on, hashed; 0 when it
+ * would draw nothing. */
+static uint64_t sub_key(PlayerState *ps, int bw, int bh) {
+    if (!ps->sub_valid || ps->sub_selection == 0) return 0;
 
-    SDL_Color fg      = { 255, 223, 0, 255 };   /* golden yellow */
-    SDL_Color outline  = { 0, 0, 0, 255 };
+    double now = (ps->audio_stream_idx >= 0) ? ps->audio_clock_sync : ps->video_clock;
+    if (now < ps->sub_start_pts || now > ps->sub_end_pts) return 0;
+
+    int state[8] = { bw, bh, ps->win_w, ps->win_h, ps->sub_is_bitmap,
+                     ps->sub_bitmap_serial, ps->sub_bitmap_count,
+                     sub_get_font() != NULL };
+    uint64_t key = hash_bytes(HASH_SEED, state, sizeof(state));
+    key = hash_bytes(key, &ps->display_rect, sizeof(ps->display_rect));
+    return ps->sub_is_bitmap ? key : hash_str(key, ps->sub_text);
+}
 
-    for (int i = 0; i < nlines; i++) {
-        int tw = 0, th = 0;
-        TTF_GetStringSize(font, lines[i], 0, &tw, &th);
-        int x = (bw - tw) / 2;
-        int y = y_base + i * line_height;
-
-        /* Outline (rendered first, behind main text) */
-        if (outline_font) {
-            SDL_Surface *osurf = TTF_RenderText_Blended(
-                outline_font, lines[i], 0, outline);
-            if (osurf) {
-                int oo = TTF_GetFontOutline(outline_font);
-                blit_surface(buf, bw, bh, osurf, x - oo, y - oo);
-                SDL_DestroySurface(osurf);
-            }
-        }
 
-        /* Main text */
-        SDL_Surface *tsurf = TTF_RenderText_Blended(font, lines[i], 0, fg);
-        if (tsurf) {
-            blit_surface(buf, bw, bh, tsurf, x, y);
-            SDL_DestroySurface(tsurf);
-        }
+/* Bitmap subtitles on the GPU subtitle layer: upload when the cue
+ * changes, then map each rect from canvas coords to physical pixels
+ * for gpu_overlay_draw(). Nothing touches the pixel buffer. Returns 1
+ * if the layer is showing the current cue. */
+static int sub_layer_update(PlayerState *ps, int bw, int bh) {
+    ps->sub_layer_active = 0;
+    if (!ps->sub_valid || ps->sub_selection == 0 ||
+        !ps->sub_is_bitmap || ps->sub_bitmap_count <= 0)
+        return 0;
+
+    if (ps->gpu_sub_serial != ps->sub_bitmap_serial)
+        gpu_sub_upload(ps);
+    if (ps->gpu_sub_count <= 0)
+        return 0;   /* upload failed: CPU path draws this cue */
+
+    double now = (ps->audio_stream_idx >= 0) ? ps->audio_clock_sync : ps->video_clock;
+    if (now < ps->sub_start_pts || now > ps->sub_end_pts)
+        return 1;   /* ours, just not visible yet / any more */
+
+    int canvas_w = (ps->sub_codec_ctx && ps->sub_codec_ctx->width > 0)
+        ? ps->sub_codec_ctx->width : ps->vid_w;
+    int canvas_h = (ps->sub_codec_ctx && ps->sub_codec_ctx->height > 0)
+        ? ps->sub_codec_ctx->height : ps->vid_h;
+
+    /* Map display_rect from logical window coords to physical pixels */
+    double px_sx = (ps->win_w > 0) ? (double)bw / ps->win_w : 1.0;
+    double px_sy = (ps->win_h > 0) ? (double)bh / ps->win_h : 1.0;
+    double dr_x = ps->display_rect.x * px_sx;
+    double dr_y = ps->display_rect.y * px_sy;
+    double sx = (canvas_w > 0) ? ps->display_rect.w * px_sx / canvas_w : 1.0;
+    double sy = (canvas_h > 0) ? ps->display_rect.h * px_sy / canvas_h : 1.0;
+
+    for (int i = 0; i < ps->gpu_sub_count; i++) {
+        const SDL_Rect *r = &ps->sub_bitmap_rects[i];
+        ps->sub_layer_dst[i] = (SDL_FRect){
+            (float)(dr_x + r->x * sx), (float)(dr_y + r->y * sy),
+            (float)(r->w * sx),        (float)(r->h * sy) };
     }
+    ps->sub_layer_active = 1;
+    return 1;
 }
 
 
@@ -712,6 +1073,49 @@ static int       s_pix_w  = 0;
 static int       s_pix_h  = 0;
 
 
+/* Size the damage bands for h rows. What the GPU texture holds is
+ * unknown afterwards, so the next collect sends every band. */
+static int bands_resize(int h) {
+    int n = (h + OVERLAY_BAND_ROWS - 1) / OVERLAY_BAND_ROWS;
+    free(s_band_paint);
+    free(s_band_hash);
+    s_band_paint  = calloc(n, sizeof(*s_band_paint));
+    s_band_hash   = calloc(n, sizeof(*s_band_hash));
+    s_nbands      = (s_band_paint && s_band_hash) ? n : 0;
+    s_bands_valid = 0;
+    return s_nbands ? 0 : -1;
+}
+
+/* Gather the bands whose content differs from what was last uploaded
+ * into row spans for gpu_overlay_upload(), and roll the painted flags
+ * over to the next frame. Returns the span count (0 = GPU is current). */
+static int bands_collect(int w, int h, SDL_Rect *regions) {
+    size_t stride = (size_t)w * 4;
+    int n = 0;
+
+    for (int b = 0; b < s_nbands; b++) {
+        uint8_t paint = s_band_paint[b];
+        s_band_paint[b] = (paint & BAND_PAINTED) ? BAND_PREV : 0;
+        if (s_bands_valid && !paint) continue;
+
+        int y0 = b * OVERLAY_BAND_ROWS;
+        int y1 = (y0 + OVERLAY_BAND_ROWS < h) ? y0 + OVERLAY_BAND_ROWS : h;
+        uint64_t hash = hash_bytes(HASH_SEED, s_pixels + y0 * stride, (y1 - y0) * stride);
+        if (s_bands_valid && hash == s_band_hash[b]) continue;
+        s_band_hash[b] = hash;
+
+        if (n > 0 && regions[n - 1].y + regions[n - 1].h == y0)
+            regions[n - 1].h += y1 - y0;                /* extend the span */
+        else if (n < OVERLAY_MAX_REGIONS)
+            regions[n++] = (SDL_Rect){ 0, y0, w, y1 - y0 };
+        else
+            regions[n - 1].h = y1 - regions[n - 1].y;   /* out of spans: widen the last */
+    }
+    s_bands_valid = 1;
+    return n;
+}
+
+
 /* ═══════════════════════════════════════════════════════════════════
  * Idle Screen — shown when no media is loaded
  * ═══════════════════════════════════════════════════════════════════
@@ -727,6 +1131,7 @@ void overlay_render_idle(PlayerState *ps) {
     if (w <= 0 || h <= 0) return;
 
     s_ui_scale = ps->fullscreen ? 2 : 1;
+    ps->sub_layer_active = 0;
 
     if (gpu_overlay_ensure(ps, w, h) < 0) {
         ps->overlay_active = 0;
@@ -737,13 +1142,21 @@ void overlay_render_idle(PlayerState *ps) {
     if (s_pix_w != w || s_pix_h != h) {
         free(s_pixels);
         s_pixels = malloc(buf_size);
-        if (!s_pixels) { ps->overlay_active = 0; return; }
+        if (!s_pixels || bands_resize(h) < 0) {
+            free(s_pixels);
+            s_pixels = NULL;
+            s_pix_w = s_pix_h = 0;
+            ps->overlay_active = 0;
+            return;
+        }
         s_pix_w = w;
         s_pix_h = h;
     }
     memset(s_pixels, 0, buf_size);
     s_dirty_y0 = 0;
     s_dirty_y1 = h;
+    memset(s_band_paint, BAND_PAINTED, s_nbands);  /* whole buffer rewritten */
+    s_frame_key = 0;
 
     /* ── Title: "DSVP" in large bitmap font ── */
     int S = s_ui_scale;
@@ -815,7 +1228,10 @@ void overlay_render_idle(PlayerState *ps) {
                   keys[i][1], key_scale, 130, 130, 140);
     }
 
-    gpu_overlay_upload(ps, s_pixels, w, h);
+    /* The idle screen is static: after the first frame no band changes */
+    SDL_Rect regions[OVERLAY_MAX_REGIONS];
+    int nregions = bands_collect(w, h, regions);
+    gpu_overlay_upload(ps, s_pixels, w, h, regions, nregions);
     ps->overlay_active = 1;
 }
 
@@ -836,7 +1252,8 @@ void overlay_render(PlayerState *ps) {
     int w = (ps->sc_w > 0) ? ps->sc_w : ps->win_w;
     int h = (ps->sc_h > 0) ? ps->sc_h : ps->win_h;
     if (w <= 0 || h <= 0 || !ps->playing) {
-        ps->overlay_active = 0;
+        ps->overlay_active   = 0;
+        ps->sub_layer_active = 0;
         return;
     }
 
@@ -854,7 +1271,10 @@ void overlay_render(PlayerState *ps) {
     int need_debug   = ps->show_debug;
     int need_info    = ps->show_info;
     int need_pause   = ps->paused;
-    int need_sub     = (ps->sub_valid && ps->sub_selection > 0);
+    /* Bitmap subtitles live on their own GPU layer; only text cues (or
+     * a bitmap cue the layer could not take) need the pixel buffer */
+    int need_sub     = (ps->sub_valid && ps->sub_selection > 0 &&
+                        !sub_layer_update(ps, w, h));
 
     /* OSD: audio or subtitle track change */
     const char *osd_text = NULL;
@@ -887,44 +1307,93 @@ void overlay_render(PlayerState *ps) {
     if (s_pix_w != w || s_pix_h != h) {
         free(s_pixels);
         s_pixels = malloc(buf_size);
-        if (!s_pixels) { ps->overlay_active = 0; return; }
+        if (!s_pixels || bands_resize(h) < 0) {
+            free(s_pixels);
+            s_pixels = NULL;
+            s_pix_w = s_pix_h = 0;
+            ps->overlay_active = 0;
+            return;
+        }
         s_pix_w = w;
         s_pix_h = h;
         /* Full clear on resize — no valid dirty tracking yet */
         memset(s_pixels, 0, buf_size);
         s_dirty_y0 = 0;
         s_dirty_y1 = 0;
-    } else if (s_dirty_y0 < s_dirty_y1) {
-        /* Clear only the rows that were painted last frame */
-        int stride = w * 4;
-        memset(s_pixels + s_dirty_y0 * stride, 0,
-               (s_dirty_y1 - s_dirty_y0) * stride);
+        s_frame_key = 0;
     }
 
-    /* Reset per-frame dirty accumulator */
-    s_frame_y0 = h;
-    s_frame_y1 = 0;
-
-    /* ── Draw overlays (back to front) ── */
+    /* ── Bring the visible layers up to date (back to front) ──
+     * Each re-rasterizes only if its content key moved. The frame key
+     * folds in which layers are shown, their keys and rects, and the
+     * subtitle state: unchanged, s_pixels already holds this frame. */
+    OverlayLayer *shown[LAYER_COUNT];
+    int nshown = 0;
 
     if (need_seekbar) {
-        draw_seekbar(s_pixels, w, h, ps);
-        draw_menubar(s_pixels, w, h);
+        draw_seekbar(w, h, ps);
+        draw_menubar(w, h);
+        shown[nshown++] = &s_layers[LAYER_SEEKBAR];
+        shown[nshown++] = &s_layers[LAYER_MENUBAR];
     }
 
     if (need_debug) {
         player_build_debug_info(ps);  /* refresh live data */
-        draw_text_panel(s_pixels, w, h, ps->debug_info, 10, 40, 2);
+        draw_text_panel(&s_layers[LAYER_DEBUG], w, h, ps->debug_info, 10, 40, 2);
+        shown[nshown++] = &s_layers[LAYER_DEBUG];
     }
 
-    if (need_info)
-        draw_text_panel(s_pixels, w, h, ps->media_info, 10, 40, 2);
+    if (need_info) {
+        draw_text_panel(&s_layers[LAYER_INFO], w, h, ps->media_info, 10, 40, 2);
+        shown[nshown++] = &s_layers[LAYER_INFO];
+    }
 
-    if (need_pause)
-        draw_pause(s_pixels, w, h);
+    if (need_pause) {
+        draw_pause(w, h);
+        shown[nshown++] = &s_layers[LAYER_PAUSE];
+    }
+
+    if (need_osd) {
+        draw_osd(w, h, osd_text);
+        shown[nshown++] = &s_layers[LAYER_OSD];
+    }
+
+    int dims[2] = { w, h };
+    uint64_t frame_key = hash_bytes(HASH_SEED, dims, sizeof(dims));
+    for (int i = 0; i < nshown; i++) {
+        int rect[5] = { (int)(shown[i] - s_layers), shown[i]->x, shown[i]->y,
+                        shown[i]->w, shown[i]->h };
+        frame_key = hash_bytes(frame_key, rect, sizeof(rect));
+        frame_key = hash_bytes(frame_key, &shown[i]->key, sizeof(shown[i]->key));
+    }
+    uint64_t skey = need_sub ? sub_key(ps, w, h) : 0;
+    frame_key = hash_bytes(frame_key, &skey, sizeof(skey));
+    if (frame_key == 0) frame_key = 1;   /* 0 means "unknown" */
+
+    SDL_Rect regions[OVERLAY_MAX_REGIONS];
+    if (frame_key == s_frame_key) {
+        /* Nothing moved: no clear, no composite, no band hashing. The
+         * upload still runs so a recreated texture gets refilled. */
+        gpu_overlay_upload(ps, s_pixels, w, h, regions, 0);
+        ps->overlay_active = 1;
+        return;
+    }
+    s_frame_key = frame_key;
+
+    if (s_dirty_y0 < s_dirty_y1) {
+        /* Clear only the rows that were painted last frame */
+        int stride = w * 4;
+        memset(s_pixels + s_dirty_y0 * stride, 0,
+               (s_dirty_y1 - s_dirty_y0) * stride);
+    }
+
+    /* Reset per-frame dirty accumulator */
+    s_frame_y0 = h;
+    s_frame_y1 = 0;
 
-    if (need_osd)
-        draw_osd(s_pixels, w, h, osd_text);
+    /* ── Composite (back to front) ── */
+    for (int i = 0; i < nshown; i++)
+        layer_composite(shown[i], s_pixels, w, h);
 
     if (need_sub)
         draw_subtitles(s_pixels, w, h, ps);
@@ -933,8 +1402,9 @@ void overlay_render(PlayerState *ps) {
     s_dirty_y0 = s_frame_y0;
     s_dirty_y1 = s_frame_y1;
 
-    /* ── Upload to GPU ── */
-    gpu_overlay_upload(ps, s_pixels, w, h);
+    /* ── Upload to GPU: only bands whose pixels changed ── */
+    int nregions = bands_collect(w, h, regions);
+    gpu_overlay_upload(ps, s_pixels, w, h, regions, nregions);
     ps->overlay_active = 1;
 }
 
@@ -947,4 +1417,14 @@ void overlay_cleanup(void) {
     s_pix_h  = 0;
     s_dirty_y0 = 0;
     s_dirty_y1 = 0;
+    free(s_band_paint);
+    free(s_band_hash);
+    s_band_paint = NULL;
+    s_band_hash  = NULL;
+    s_nbands     = 0;
+    layers_free();
+    sub_cache_free();
+    free(s_xmap);
+    s_xmap     = NULL;
+    s_xmap_cap = 0;
 }
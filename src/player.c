@@ -5,7 +5,8 @@
  * Threading model:
  *   - Demux thread: reads packets from the container, pushes to queues
  *   - Main thread:  pops video packets, decodes, scales, renders
- *   - SDL audio thread: calls audio_callback() which decodes audio
+ *   - Audio decode thread: decodes + resamples audio into a PCM ring
+ *   - SDL audio thread: calls audio_callback(), which copies from the ring
  *
  * A/V sync strategy:
  *   Audio is the master clock. Video frame display timing is adjusted
@@ -479,6 +480,104 @@ static const char hlsl_overlay_frag[] =
     "    return texOverlay.Sample(sampOverlay, uv);\n"
     "}\n";
 
+/* HDR luma histogram compute shader — one texel per thread, full
+ * resolution. Each 16×16 group bins into groupshared memory first, then
+ * merges its non-empty bins into the global histogram, so global atomics
+ * scale with distinct values per tile rather than with pixels.
+ *
+ * binScale maps the sampled UNORM value to a bin: 65535 for 10-bit
+ * passthrough (bin = exact 10-bit code value), 1023 for 8-bit. */
+static const char hlsl_hdr_hist_comp[] =
+    "Texture2D<float> texY : register(t0, space0);\n"
+    "SamplerState sampY : register(s0, space0);\n"
+    "RWStructuredBuffer<uint> bins : register(u0, space1);\n"
+    "\n"
+    "cbuffer HistParams : register(b0, space2) {\n"
+    "    uint2 size;\n"
+    "    float binScale;\n"
+    "    uint skipCount;\n"
+    "};\n"
+    "\n"
+    "groupshared uint localBins[1024];\n"
+    "\n"
+    "[numthreads(16, 16, 1)]\n"
+    "void main(uint3 id : SV_DispatchThreadID, uint li : SV_GroupIndex) {\n"
+    "    for (uint i = li; i < 1024; i += 256) localBins[i] = 0;\n"
+    "    GroupMemoryBarrierWithGroupSync();\n"
+    "\n"
+    "    if (id.x < size.x && id.y < size.y) {\n"
+    "        float2 uv = (float2(id.xy) + 0.5) / float2(size);\n"
+    "        float v = texY.SampleLevel(sampY, uv, 0);\n"
+    "        uint bin = min((uint)(v * binScale + 0.5), 1023u);\n"
+    "        InterlockedAdd(localBins[bin], 1);\n"
+    "    }\n"
+    "    GroupMemoryBarrierWithGroupSync();\n"
+    "\n"
+    "    for (uint j = li; j < 1024; j += 256)\n"
+    "        if (localBins[j] != 0) InterlockedAdd(bins[j], localBins[j]);\n"
+    "}\n";
+
+/* Histogram → percentile reduction. One group of 256 threads: each
+ * takes 4 bins into groupshared memory (zeroing the global histogram
+ * for the next frame) and sums them; thread 0 then walks the 256
+ * partial sums from the top and finishes inside the matching group.
+ * Writes result[0] = percentile bin, result[1] = total samples. */
+static const char hlsl_hdr_hist_reduce_comp[] =
+    "RWStructuredBuffer<uint> bins : register(u0, space1);\n"
+    "RWStructuredBuffer<uint> result : register(u1, space1);\n"
+    "\n"
+    "cbuffer HistParams : register(b0, space2) {\n"
+    "    uint2 size;\n"
+    "    float binScale;\n"
+    "    uint skipCount;\n"
+    "};\n"
+    "\n"
+    "groupshared uint hist[1024];\n"
+    "groupshared uint partial[256];\n"
+    "\n"
+    "[numthreads(256, 1, 1)]\n"
+    "void main(uint li : SV_GroupIndex) {\n"
+    "    uint base = li * 4;\n"
+    "    uint sum = 0;\n"
+    "    for (uint k = 0; k < 4; k++) {\n"
+    "        uint c = bins[base + k];\n"
+    "        hist[base + k] = c;\n"
+    "        bins[base + k] = 0;\n"
+    "        sum += c;\n"
+    "    }\n"
+    "    partial[li] = sum;\n"
+    "    GroupMemoryBarrierWithGroupSync();\n"
+    "\n"
+    "    if (li == 0) {\n"
+    "        uint total = 0;\n"
+    "        for (uint t = 0; t < 256; t++) total += partial[t];\n"
+    "\n"
+    "        uint acc = 0;\n"
+    "        uint bin = 0;\n"
+    "        for (int g = 255; g >= 0; g--) {\n"
+    "            if (acc + partial[g] < skipCount) {\n"
+    "                acc += partial[g];\n"
+    "                continue;\n"
+    "            }\n"
+    "            for (int b = 3; b >= 0; b--) {\n"
+    "                acc += hist[g * 4 + b];\n"
+    "                if (acc >= skipCount) { bin = g * 4 + b; break; }\n"
+    "            }\n"
+    "            break;\n"
+    "        }\n"
+    "        result[0] = bin;\n"
+    "        result[1] = total;\n"
+    "    }\n"
+    "}\n";
+
+/* Uniform block shared by both histogram passes (16 bytes). */
+typedef struct HDRHistParams {
+    Uint32 width;
+    Uint32 height;
+    float  bin_scale;
+    Uint32 skip_count;
+} HDRHistParams;
+
 
 /* ═══════════════════════════════════════════════════════════════════
  * Shader Compilation Helper
@@ -558,6 +657,66 @@ static SDL_GPUShader *compile_shader(
     return shader;
 }
 
+/* Same three steps for a compute shader, producing a compute pipeline.
+ * Compute resource counts and thread-group size come from reflection. */
+static SDL_GPUComputePipeline *compile_compute_pipeline(
+    SDL_GPUDevice *device,
+    const char *source,
+    const char *entrypoint)
+{
+    SDL_ShaderCross_HLSL_Info hlsl_info;
+    SDL_zero(hlsl_info);
+    hlsl_info.source       = source;
+    hlsl_info.entrypoint   = entrypoint;
+    hlsl_info.include_dir  = NULL;
+    hlsl_info.defines      = NULL;
+    hlsl_info.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+    hlsl_info.props        = 0;
+
+    size_t spirv_size = 0;
+    void *spirv = SDL_ShaderCross_CompileSPIRVFromHLSL(&hlsl_info, &spirv_size);
+    if (!spirv) {
+        log_msg("ERROR: HLSL->SPIRV failed (comp): %s", SDL_GetError());
+        return NULL;
+    }
+
+    SDL_ShaderCross_ComputePipelineMetadata *metadata =
+        SDL_ShaderCross_ReflectComputeSPIRV(spirv, spirv_size, 0);
+    if (!metadata) {
+        log_msg("ERROR: SPIRV reflection failed: %s", SDL_GetError());
+        SDL_free(spirv);
+        return NULL;
+    }
+    log_msg("Shader: reflect OK (comp, samplers=%u rw_buffers=%u uniforms=%u, "
+            "threads=%ux%ux%u)",
+            metadata->num_samplers, metadata->num_readwrite_storage_buffers,
+            metadata->num_uniform_buffers,
+            metadata->threadcount_x, metadata->threadcount_y,
+            metadata->threadcount_z);
+
+    SDL_ShaderCross_SPIRV_Info spirv_info;
+    SDL_zero(spirv_info);
+    spirv_info.bytecode      = spirv;
+    spirv_info.bytecode_size = spirv_size;
+    spirv_info.entrypoint    = entrypoint;
+    spirv_info.shader_stage  = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE;
+    spirv_info.props         = 0;
+
+    SDL_GPUComputePipeline *pipeline =
+        SDL_ShaderCross_CompileComputePipelineFromSPIRV(
+            device, &spirv_info, metadata, 0);
+
+    SDL_free(metadata);
+    SDL_free(spirv);
+
+    if (!pipeline) {
+        log_msg("ERROR: SPIRV->native failed (comp): %s", SDL_GetError());
+        return NULL;
+    }
+    log_msg("Shader: native compile OK (comp)");
+    return pipeline;
+}
+
 
 /* ═══════════════════════════════════════════════════════════════════
  * GPU Pipeline Setup / Teardown
@@ -567,13 +726,99 @@ static SDL_GPUShader *compile_shader(
  * and claiming the window). Compiles shaders and creates the
  * graphics pipelines and sampler.
  *
- * Two pipelines:
+ * Graphics pipelines:
  *   - gpu_pipeline_yuv:     planar YUV420P (3 textures, 3 samplers)
  *   - gpu_pipeline_overlay: RGBA + alpha blend (1 texture, 1 sampler)
+ *   - gpu_pipeline_sub:     the same for premultiplied RGBA (subtitles)
  */
 
+/* Release the HDR histogram pipelines and buffers. */
+static void gpu_destroy_hist_pipelines(PlayerState *ps) {
+    if (ps->gpu_pipeline_hist) {
+        SDL_ReleaseGPUComputePipeline(ps->gpu_device, ps->gpu_pipeline_hist);
+        ps->gpu_pipeline_hist = NULL;
+    }
+    if (ps->gpu_pipeline_hist_reduce) {
+        SDL_ReleaseGPUComputePipeline(ps->gpu_device, ps->gpu_pipeline_hist_reduce);
+        ps->gpu_pipeline_hist_reduce = NULL;
+    }
+    if (ps->gpu_hist_bins) {
+        SDL_ReleaseGPUBuffer(ps->gpu_device, ps->gpu_hist_bins);
+        ps->gpu_hist_bins = NULL;
+    }
+    if (ps->gpu_hist_result) {
+        SDL_ReleaseGPUBuffer(ps->gpu_device, ps->gpu_hist_result);
+        ps->gpu_hist_result = NULL;
+    }
+}
+
+/* Compile the histogram + reduce pipelines and create their storage
+ * buffers. The bins buffer is zeroed once here; after that the reduce
+ * pass clears it as it reads. On any failure everything is released
+ * and the CPU scan stays in use. */
+static void gpu_create_hist_pipelines(PlayerState *ps) {
+    ps->gpu_pipeline_hist = compile_compute_pipeline(
+        ps->gpu_device, hlsl_hdr_hist_comp, "main");
+    ps->gpu_pipeline_hist_reduce = compile_compute_pipeline(
+        ps->gpu_device, hlsl_hdr_hist_reduce_comp, "main");
+
+    SDL_GPUBufferCreateInfo buf_info;
+    SDL_zero(buf_info);
+    buf_info.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ
+                   | SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE;
+    buf_info.size  = HDR_HIST_BINS * sizeof(Uint32);
+    ps->gpu_hist_bins = SDL_CreateGPUBuffer(ps->gpu_device, &buf_info);
+    buf_info.size  = 4 * sizeof(Uint32);
+    ps->gpu_hist_result = SDL_CreateGPUBuffer(ps->gpu_device, &buf_info);
+
+    if (!ps->gpu_pipeline_hist || !ps->gpu_pipeline_hist_reduce ||
+        !ps->gpu_hist_bins || !ps->gpu_hist_result) {
+        log_msg("WARNING: HDR histogram compute unavailable, using CPU scan");
+        gpu_destroy_hist_pipelines(ps);
+        return;
+    }
+
+    /* Zero the bins via a one-off upload */
+    SDL_GPUTransferBufferCreateInfo xfer_info;
+    SDL_zero(xfer_info);
+    xfer_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+    xfer_info.size  = HDR_HIST_BINS * sizeof(Uint32);
+    SDL_GPUTransferBuffer *xfer = SDL_CreateGPUTransferBuffer(ps->gpu_device, &xfer_info);
+    if (!xfer) {
+        log_msg("WARNING: HDR histogram init failed, using CPU scan");
+        gpu_destroy_hist_pipelines(ps);
+        return;
+    }
+    void *dst = SDL_MapGPUTransferBuffer(ps->gpu_device, xfer, false);
+    if (dst) {
+        memset(dst, 0, xfer_info.size);
+        SDL_UnmapGPUTransferBuffer(ps->gpu_device, xfer);
+    }
+
+    SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
+    if (cmd) {
+        SDL_GPUCopyPass *copy = SDL_BeginGPUCopyPass(cmd);
+        SDL_GPUTransferBufferLocation src = { .transfer_buffer = xfer, .offset = 0 };
+        SDL_GPUBufferRegion region = {
+            .buffer = ps->gpu_hist_bins, .offset = 0, .size = xfer_info.size
+        };
+        SDL_UploadToGPUBuffer(copy, &src, &region, false);
+        SDL_EndGPUCopyPass(copy);
+        SDL_SubmitGPUCommandBuffer(cmd);
+    }
+    SDL_ReleaseGPUTransferBuffer(ps->gpu_device, xfer);
+
+    log_msg("GPU: HDR histogram compute created (%d bins)", HDR_HIST_BINS);
+}
+
 int gpu_create_pipelines(PlayerState *ps) {
-    if (!ps->gpu_device || !ps->window) return -1;
+    if (!ps->gpu_device) return -1;
+
+    /* Render target format: the window's swapchain, or RGBA8 for the
+     * offscreen target in headless mode. */
+    ps->gpu_target_format = ps->window
+        ? SDL_GetGPUSwapchainTextureFormat(ps->gpu_device, ps->window)
+        : SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
 
     log_msg("GPU: compiling shaders...");
 
@@ -595,8 +840,7 @@ int gpu_create_pipelines(PlayerState *ps) {
     /* ── Create YUV planar pipeline ── */
     SDL_GPUColorTargetDescription color_desc;
     SDL_zero(color_desc);
-    color_desc.format = SDL_GetGPUSwapchainTextureFormat(
-        ps->gpu_device, ps->window);
+    color_desc.format = ps->gpu_target_format;
 
     SDL_GPUGraphicsPipelineCreateInfo pipe_info;
     SDL_zero(pipe_info);
@@ -632,11 +876,16 @@ int gpu_create_pipelines(PlayerState *ps) {
         return -1;
     }
 
-    /* ── Create overlay pipeline (alpha blending enabled) ──
+    /* ── Create overlay pipelines (alpha blending enabled) ──
      *
      * Standard alpha compositing: src.a * src + (1-src.a) * dst.
      * This is the "over" operator — overlay pixels with alpha < 1
-     * blend with the video underneath. */
+     * blend with the video underneath.
+     *
+     * The subtitle layer is linearly filtered, and filtering straight
+     * alpha drags the colour of transparent texels (black) into glyph
+     * edges. Its textures are premultiplied at staging instead, and
+     * drawn with src + (1-src.a) * dst. */
     {
         /* Need a fresh vertex shader since we released vert above */
         SDL_GPUShader *vert_overlay = compile_shader(
@@ -650,8 +899,7 @@ int gpu_create_pipelines(PlayerState *ps) {
 
         SDL_GPUColorTargetDescription overlay_color_desc;
         SDL_zero(overlay_color_desc);
-        overlay_color_desc.format = SDL_GetGPUSwapchainTextureFormat(
-            ps->gpu_device, ps->window);
+        overlay_color_desc.format = ps->gpu_target_format;
         overlay_color_desc.blend_state.enable_blend          = true;
         overlay_color_desc.blend_state.src_color_blendfactor  = SDL_GPU_BLENDFACTOR_SRC_ALPHA;
         overlay_color_desc.blend_state.dst_color_blendfactor  = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA;
@@ -674,14 +922,18 @@ int gpu_create_pipelines(PlayerState *ps) {
         ps->gpu_pipeline_overlay = SDL_CreateGPUGraphicsPipeline(
             ps->gpu_device, &overlay_pipe);
 
+        overlay_color_desc.blend_state.src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE;
+        ps->gpu_pipeline_sub = SDL_CreateGPUGraphicsPipeline(
+            ps->gpu_device, &overlay_pipe);
+
         SDL_ReleaseGPUShader(ps->gpu_device, vert_overlay);
         SDL_ReleaseGPUShader(ps->gpu_device, frag_overlay);
 
-        if (!ps->gpu_pipeline_overlay) {
+        if (!ps->gpu_pipeline_overlay || !ps->gpu_pipeline_sub) {
             log_msg("ERROR: Failed to create overlay pipeline: %s", SDL_GetError());
             return -1;
         }
-        log_msg("GPU: overlay pipeline created (alpha blend)");
+        log_msg("GPU: overlay pipelines created (alpha blend, premultiplied)");
     }
 
     /* ── Create sampler (linear filtering, no anisotropy) ──
@@ -788,6 +1040,11 @@ int gpu_create_pipelines(PlayerState *ps) {
         log_msg("GPU: blue noise dither texture created (64x64 R8_UNORM)");
     }
 
+    /* ── HDR histogram compute pipelines (optional) ──
+     * Failure is not fatal: hdr_compute_scene_peak falls back to the
+     * CPU scan when gpu_pipeline_hist is NULL. */
+    gpu_create_hist_pipelines(ps);
+
     return 0;
 }
 
@@ -795,6 +1052,7 @@ void gpu_destroy_pipelines(PlayerState *ps) {
     if (!ps->gpu_device) return;
 
     gpu_overlay_destroy(ps);
+    gpu_sub_destroy(ps);
 
     if (ps->gpu_sampler) {
         SDL_ReleaseGPUSampler(ps->gpu_device, ps->gpu_sampler);
@@ -816,6 +1074,11 @@ void gpu_destroy_pipelines(PlayerState *ps) {
         SDL_ReleaseGPUGraphicsPipeline(ps->gpu_device, ps->gpu_pipeline_overlay);
         ps->gpu_pipeline_overlay = NULL;
     }
+    if (ps->gpu_pipeline_sub) {
+        SDL_ReleaseGPUGraphicsPipeline(ps->gpu_device, ps->gpu_pipeline_sub);
+        ps->gpu_pipeline_sub = NULL;
+    }
+    gpu_destroy_hist_pipelines(ps);
 }
 
 
@@ -878,26 +1141,46 @@ static int gpu_create_video_textures(PlayerState *ps) {
         return -1;
     }
 
-    /* Transfer buffers (CPU→GPU staging) */
+    /* Staging ring (CPU→GPU). Row pitch per plane leaves room for the
+     * decoder's aligned linesize, so a padded plane is staged with one
+     * memcpy and uploaded with pixels_per_row = linesize instead of
+     * being repacked row by row. Offsets stay 256-byte aligned. */
+    ps->gpu_upload_pitch_y  = (Uint32)FFALIGN(w  * bpp + 128, 256);
+    ps->gpu_upload_pitch_uv = (Uint32)FFALIGN(cw * bpp + 128, 256);
+    ps->gpu_upload_off_u    = ps->gpu_upload_pitch_y  * h;
+    ps->gpu_upload_off_v    = ps->gpu_upload_off_u + ps->gpu_upload_pitch_uv * ch;
+
     SDL_GPUTransferBufferCreateInfo xfer_info;
     SDL_zero(xfer_info);
     xfer_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
-
-    xfer_info.size = (Uint32)w * h * bpp;
-    ps->gpu_xfer_y = SDL_CreateGPUTransferBuffer(ps->gpu_device, &xfer_info);
-
-    xfer_info.size = (Uint32)cw * ch * bpp;
-    ps->gpu_xfer_u = SDL_CreateGPUTransferBuffer(ps->gpu_device, &xfer_info);
-    ps->gpu_xfer_v = SDL_CreateGPUTransferBuffer(ps->gpu_device, &xfer_info);
-
-    if (!ps->gpu_xfer_y || !ps->gpu_xfer_u || !ps->gpu_xfer_v) {
-        log_msg("ERROR: Failed to create transfer buffers: %s", SDL_GetError());
-        return -1;
+    xfer_info.size  = ps->gpu_upload_off_v + ps->gpu_upload_pitch_uv * ch;
+
+    /* Per-slot HDR percentile readback — tied to the slot's fence so the
+     * result is read one frame later without a stall. */
+    SDL_GPUTransferBufferCreateInfo rb_info;
+    SDL_zero(rb_info);
+    rb_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+    rb_info.size  = 4 * sizeof(Uint32);
+
+    for (int i = 0; i < GPU_UPLOAD_RING; i++) {
+        ps->gpu_upload[i].xfer  = SDL_CreateGPUTransferBuffer(ps->gpu_device, &xfer_info);
+        ps->gpu_upload[i].fence = NULL;
+        ps->gpu_upload[i].hist_rb = ps->gpu_pipeline_hist
+            ? SDL_CreateGPUTransferBuffer(ps->gpu_device, &rb_info) : NULL;
+        ps->gpu_upload[i].hist_pending = 0;
+        if (!ps->gpu_upload[i].xfer ||
+            (ps->gpu_pipeline_hist && !ps->gpu_upload[i].hist_rb)) {
+            log_msg("ERROR: Failed to create transfer buffers: %s", SDL_GetError());
+            return -1;
+        }
     }
+    ps->gpu_upload_idx = 0;
 
     log_msg("GPU: textures created (Y=%dx%d, UV=%dx%d, %s planar)",
             w, h, cw, ch,
             is_10bit ? "R16_UNORM 10-bit" : "R8_UNORM");
+    log_msg("GPU: upload ring %d x %.1f MB", GPU_UPLOAD_RING,
+            xfer_info.size / (1024.0 * 1024.0));
     return 0;
 }
 
@@ -908,9 +1191,17 @@ static void gpu_destroy_video_textures(PlayerState *ps) {
     if (ps->gpu_tex_y)  { SDL_ReleaseGPUTexture(ps->gpu_device, ps->gpu_tex_y);  ps->gpu_tex_y  = NULL; }
     if (ps->gpu_tex_u)  { SDL_ReleaseGPUTexture(ps->gpu_device, ps->gpu_tex_u);  ps->gpu_tex_u  = NULL; }
     if (ps->gpu_tex_v)  { SDL_ReleaseGPUTexture(ps->gpu_device, ps->gpu_tex_v);  ps->gpu_tex_v  = NULL; }
-    if (ps->gpu_xfer_y) { SDL_ReleaseGPUTransferBuffer(ps->gpu_device, ps->gpu_xfer_y); ps->gpu_xfer_y = NULL; }
-    if (ps->gpu_xfer_u) { SDL_ReleaseGPUTransferBuffer(ps->gpu_device, ps->gpu_xfer_u); ps->gpu_xfer_u = NULL; }
-    if (ps->gpu_xfer_v) { SDL_ReleaseGPUTransferBuffer(ps->gpu_device, ps->gpu_xfer_v); ps->gpu_xfer_v = NULL; }
+    for (int i = 0; i < GPU_UPLOAD_RING; i++) {
+        GPUUploadSlot *slot = &ps->gpu_upload[i];
+        if (slot->fence) {
+            SDL_WaitForGPUFences(ps->gpu_device, true, &slot->fence, 1);
+            SDL_ReleaseGPUFence(ps->gpu_device, slot->fence);
+            slot->fence = NULL;
+        }
+        if (slot->xfer) { SDL_ReleaseGPUTransferBuffer(ps->gpu_device, slot->xfer); slot->xfer = NULL; }
+        if (slot->hist_rb) { SDL_ReleaseGPUTransferBuffer(ps->gpu_device, slot->hist_rb); slot->hist_rb = NULL; }
+        slot->hist_pending = 0;
+    }
 }
 
 
@@ -1342,7 +1633,8 @@ static void gpu_setup_uniforms(PlayerState *ps) {
  * The overlay system composites debug info, seek bar, subtitles, and
  * other UI elements as a single RGBA texture drawn over the video
  * with alpha blending. The texture is recreated when the window is
- * resized. Upload happens once per frame when overlay_dirty is set.
+ * resized. Upload happens once per frame when overlay_dirty is set,
+ * and covers only the regions overlay.c found changed (damage bands).
  */
 
 /* Ensure overlay texture and transfer buffer exist at the given size.
@@ -1393,85 +1685,192 @@ int gpu_overlay_ensure(PlayerState *ps, int width, int height) {
     ps->overlay_tex_w = width;
     ps->overlay_tex_h = height;
     ps->overlay_dirty = 0;
+    ps->overlay_full  = 1;   /* contents undefined until the first upload */
 
     log_msg("GPU: overlay texture created (%dx%d RGBA)", width, height);
     return 0;
 }
 
-/* Upload RGBA pixel data to the overlay GPU texture.
- * `rgba` must be width×height×4 bytes, tightly packed. */
+/* Stage changed parts of the overlay for the GPU. `rgba` must be
+ * width×height×4 bytes, tightly packed; only the listed regions are
+ * copied into the transfer buffer (same layout as the image) and later
+ * uploaded by gpu_overlay_copy_cmd(). nregions = 0 means nothing
+ * changed. A newly created texture is always sent whole. */
 void gpu_overlay_upload(PlayerState *ps, const uint8_t *rgba,
-                        int width, int height) {
+                        int width, int height,
+                        const SDL_Rect *regions, int nregions) {
     if (!ps->gpu_overlay_xfer || !ps->gpu_overlay_tex) return;
     if (width != ps->overlay_tex_w || height != ps->overlay_tex_h) return;
 
-    /* Map transfer buffer and copy pixel data */
+    SDL_Rect full = { 0, 0, width, height };
+    if (ps->overlay_full || !regions) {
+        regions  = &full;
+        nregions = 1;
+    }
+    if (nregions <= 0) return;
+
+    /* Regions staged earlier but not copied yet (no frame presented in
+     * between) stay in the list; too many collapses to one full copy. */
+    int n = ps->overlay_dirty ? ps->overlay_nregions : 0;
+    if (n + nregions > OVERLAY_MAX_REGIONS) {
+        regions  = &full;
+        nregions = 1;
+        n        = 0;
+    }
+
+    /* Cycling only happens once the buffer is in a submitted copy, and
+     * recording that copy also emptied the region list */
     uint8_t *dst = SDL_MapGPUTransferBuffer(ps->gpu_device,
                                              ps->gpu_overlay_xfer, true);
     if (!dst) return;
-    memcpy(dst, rgba, (size_t)width * height * 4);
+    size_t stride = (size_t)width * 4;
+    for (int i = 0; i < nregions; i++) {
+        const SDL_Rect *r = &regions[i];
+        size_t off = (size_t)r->y * stride + (size_t)r->x * 4;
+        if (r->x == 0 && r->w == width) {
+            memcpy(dst + off, rgba + off, (size_t)r->h * stride);
+        } else {
+            for (int y = 0; y < r->h; y++, off += stride)
+                memcpy(dst + off, rgba + off, (size_t)r->w * 4);
+        }
+        ps->overlay_regions[n++] = *r;
+    }
     SDL_UnmapGPUTransferBuffer(ps->gpu_device, ps->gpu_overlay_xfer);
 
-    ps->overlay_dirty = 1;
+    ps->overlay_nregions = n;
+    ps->overlay_full     = 0;
+    ps->overlay_dirty    = 1;
 }
 
-/* Issue the GPU copy pass to transfer overlay data to the texture.
+/* Issue the GPU copy pass to transfer overlay data to the texture,
+ * plus a freshly staged subtitle cue (gpu_sub_upload) if there is one.
  * Call this inside an existing command buffer, BEFORE the render pass.
  * Returns the copy pass so the caller can end it, or does it inline. */
 void gpu_overlay_copy_cmd(SDL_GPUCommandBuffer *cmd, PlayerState *ps) {
-    if (!ps->overlay_dirty || !ps->gpu_overlay_tex) return;
+    int overlay = ps->overlay_dirty && ps->gpu_overlay_tex;
+    int subs    = ps->gpu_sub_dirty && ps->gpu_sub_count > 0;
+    if (!overlay && !subs) return;
 
     SDL_GPUCopyPass *copy = SDL_BeginGPUCopyPass(cmd);
-    {
-        SDL_GPUTextureTransferInfo src_info;
-        SDL_GPUTextureRegion dst_region;
+    if (overlay) {
+        /* One upload per staged region, read from its place in the
+         * image-shaped transfer buffer. No cycling: a cycled texture
+         * would lose everything outside the regions. */
+        int bytes = 0;
+        for (int i = 0; i < ps->overlay_nregions; i++) {
+            const SDL_Rect *r = &ps->overlay_regions[i];
+            SDL_GPUTextureTransferInfo src_info;
+            SDL_GPUTextureRegion dst_region;
 
-        SDL_zero(src_info);
-        SDL_zero(dst_region);
-        src_info.transfer_buffer = ps->gpu_overlay_xfer;
-        src_info.pixels_per_row  = ps->overlay_tex_w;
-        src_info.rows_per_layer  = ps->overlay_tex_h;
-        dst_region.texture = ps->gpu_overlay_tex;
-        dst_region.w = ps->overlay_tex_w;
-        dst_region.h = ps->overlay_tex_h;
-        dst_region.d = 1;
-        SDL_UploadToGPUTexture(copy, &src_info, &dst_region, true);
+            SDL_zero(src_info);
+            SDL_zero(dst_region);
+            src_info.transfer_buffer = ps->gpu_overlay_xfer;
+            src_info.offset          = ((Uint32)r->y * ps->overlay_tex_w + r->x) * 4;
+            src_info.pixels_per_row  = ps->overlay_tex_w;
+            src_info.rows_per_layer  = r->h;
+            dst_region.texture = ps->gpu_overlay_tex;
+            dst_region.x = r->x;
+            dst_region.y = r->y;
+            dst_region.w = r->w;
+            dst_region.h = r->h;
+            dst_region.d = 1;
+            SDL_UploadToGPUTexture(copy, &src_info, &dst_region, false);
+            bytes += r->w * r->h * 4;
+        }
+        ps->overlay_copy_bytes   = bytes;
+        ps->overlay_copy_regions = ps->overlay_nregions;
+        ps->overlay_nregions = 0;
+        ps->overlay_dirty    = 0;
     }
-    SDL_EndGPUCopyPass(copy);
+    if (subs) {
+        /* Rects are packed back to back in the staging buffer */
+        Uint32 offset = 0;
+        for (int i = 0; i < ps->gpu_sub_count; i++) {
+            SDL_GPUTextureTransferInfo src_info;
+            SDL_GPUTextureRegion dst_region;
 
-    ps->overlay_dirty = 0;
+            SDL_zero(src_info);
+            SDL_zero(dst_region);
+            src_info.transfer_buffer = ps->gpu_sub_xfer;
+            src_info.offset          = offset;
+            src_info.pixels_per_row  = ps->gpu_sub_tex_w[i];
+            src_info.rows_per_layer  = ps->gpu_sub_tex_h[i];
+            dst_region.texture = ps->gpu_sub_tex[i];
+            dst_region.w = ps->gpu_sub_tex_w[i];
+            dst_region.h = ps->gpu_sub_tex_h[i];
+            dst_region.d = 1;
+            SDL_UploadToGPUTexture(copy, &src_info, &dst_region, true);
+            offset += (Uint32)ps->gpu_sub_tex_w[i] * ps->gpu_sub_tex_h[i] * 4;
+        }
+        ps->gpu_sub_dirty = 0;
+    }
+    SDL_EndGPUCopyPass(copy);
 }
 
-/* Draw the overlay quad within an existing render pass.
- * Uses the overlay pipeline (alpha blend) and a fullscreen viewport.
+/* Draw the overlay quad within an existing render pass, then the
+ * subtitle layer's quads on top (subtitles are frontmost).
+ * Uses the overlay pipeline (alpha blend), and its premultiplied
+ * variant for the subtitle layer.
  * Call AFTER the video quad has been drawn. */
 void gpu_overlay_draw(SDL_GPURenderPass *pass, SDL_GPUCommandBuffer *cmd,
                       PlayerState *ps, Uint32 sc_w, Uint32 sc_h) {
-    if (!ps->gpu_overlay_tex || !ps->gpu_pipeline_overlay || !ps->overlay_active)
+    int overlay = ps->gpu_overlay_tex && ps->overlay_active;
+    int subs    = ps->sub_layer_active && ps->gpu_sub_count > 0;
+    if (!ps->gpu_pipeline_overlay || (!overlay && !subs))
         return;
     (void)cmd;  /* uniform push would use cmd, but overlay has none */
 
-    SDL_BindGPUGraphicsPipeline(pass, ps->gpu_pipeline_overlay);
-
-    /* Fullscreen viewport — overlay covers entire window, not just
-     * the letterboxed video area. This lets us draw seek bars,
-     * debug info, etc. in the black bar regions too. */
-    SDL_GPUViewport viewport;
-    viewport.x = 0;
-    viewport.y = 0;
-    viewport.w = (float)sc_w;
-    viewport.h = (float)sc_h;
-    viewport.min_depth = 0.0f;
-    viewport.max_depth = 1.0f;
-    SDL_SetGPUViewport(pass, &viewport);
-
-    SDL_GPUTextureSamplerBinding binding = {
-        .texture = ps->gpu_overlay_tex,
-        .sampler = ps->gpu_sampler_nearest  /* nearest = pixel-perfect bitmap font */
-    };
-    SDL_BindGPUFragmentSamplers(pass, 0, &binding, 1);
+    if (overlay) {
+        SDL_BindGPUGraphicsPipeline(pass, ps->gpu_pipeline_overlay);
+
+        /* Fullscreen viewport — overlay covers entire window, not just
+         * the letterboxed video area. This lets us draw seek bars,
+         * debug info, etc. in the black bar regions too. */
+        SDL_GPUViewport viewport;
+        viewport.x = 0;
+        viewport.y = 0;
+        viewport.w = (float)sc_w;
+        viewport.h = (float)sc_h;
+        viewport.min_depth = 0.0f;
+        viewport.max_depth = 1.0f;
+        SDL_SetGPUViewport(pass, &viewport);
+
+        SDL_GPUTextureSamplerBinding binding = {
+            .texture = ps->gpu_overlay_tex,
+            .sampler = ps->gpu_sampler_nearest  /* nearest = pixel-perfect bitmap font */
+        };
+        SDL_BindGPUFragmentSamplers(pass, 0, &binding, 1);
+
+        SDL_DrawGPUPrimitives(pass, 4, 1, 0, 0);
+    }
+
+    /* Subtitle rects: the fullscreen quad drawn into a viewport the size
+     * of the destination rect is exactly a scaled blit. Linear sampling
+     * smooths the canvas → display scale (DVD 720×480 → 4K is 4.5×);
+     * the textures are premultiplied so edges filter without fringes. */
+    if (subs)
+        SDL_BindGPUGraphicsPipeline(pass, ps->gpu_pipeline_sub);
+    for (int i = 0; subs && i < ps->gpu_sub_count; i++) {
+        const SDL_FRect *r = &ps->sub_layer_dst[i];
+        if (r->w < 1.0f || r->h < 1.0f) continue;
+
+        SDL_GPUViewport viewport;
+        viewport.x = r->x;
+        viewport.y = r->y;
+        viewport.w = r->w;
+        viewport.h = r->h;
+        viewport.min_depth = 0.0f;
+        viewport.max_depth = 1.0f;
+        SDL_SetGPUViewport(pass, &viewport);
+
+        SDL_GPUTextureSamplerBinding binding = {
+            .texture = ps->gpu_sub_tex[i],
+            .sampler = ps->gpu_sampler
+        };
+        SDL_BindGPUFragmentSamplers(pass, 0, &binding, 1);
 
-    SDL_DrawGPUPrimitives(pass, 4, 1, 0, 0);
+        SDL_DrawGPUPrimitives(pass, 4, 1, 0, 0);
+    }
 }
 
 /* Destroy overlay GPU resources (texture + transfer buffer). */
@@ -1489,105 +1888,410 @@ void gpu_overlay_destroy(PlayerState *ps) {
     ps->overlay_tex_w = 0;
     ps->overlay_tex_h = 0;
     ps->overlay_dirty = 0;
+    ps->overlay_nregions = 0;
+}
+
+/* ── Subtitle layer ──
+ *
+ * Bitmap cues (PGS, VobSub, DVB) bypass the full-window CPU overlay.
+ * Each rect gets its own small texture, uploaded once when the cue
+ * changes (sub_bitmap_serial), and is drawn by gpu_overlay_draw() as a
+ * quad scaled on the GPU. Between cue changes the layer costs one draw
+ * per rect and no transfers. */
+
+/* Stage the current bitmap cue for upload, recreating textures whose
+ * size changed. The copy is recorded by gpu_overlay_copy_cmd(). On
+ * failure gpu_sub_count stays 0 and overlay.c falls back to the CPU
+ * blit for this cue. */
+void gpu_sub_upload(PlayerState *ps) {
+    ps->gpu_sub_serial = ps->sub_bitmap_serial;
+    ps->gpu_sub_count  = 0;
+    ps->gpu_sub_dirty  = 0;
+    if (!ps->gpu_device) return;
+
+    int n = 0;
+    Uint32 total = 0;
+    while (n < ps->sub_bitmap_count && ps->sub_bitmap_data[n]) {
+        total += (Uint32)ps->sub_bitmap_w[n] * ps->sub_bitmap_h[n] * 4;
+        n++;
+    }
+    if (n == 0) return;
+
+    if (total > ps->gpu_sub_xfer_size) {
+        if (ps->gpu_sub_xfer)
+            SDL_ReleaseGPUTransferBuffer(ps->gpu_device, ps->gpu_sub_xfer);
+        SDL_GPUTransferBufferCreateInfo xfer_info;
+        SDL_zero(xfer_info);
+        xfer_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
+        xfer_info.size  = total;
+        ps->gpu_sub_xfer = SDL_CreateGPUTransferBuffer(ps->gpu_device, &xfer_info);
+        ps->gpu_sub_xfer_size = ps->gpu_sub_xfer ? total : 0;
+        if (!ps->gpu_sub_xfer) {
+            log_msg("ERROR: Failed to create subtitle transfer buffer: %s", SDL_GetError());
+            return;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        int w = ps->sub_bitmap_w[i], h = ps->sub_bitmap_h[i];
+        if (ps->gpu_sub_tex[i] && ps->gpu_sub_tex_w[i] == w && ps->gpu_sub_tex_h[i] == h)
+            continue;
+        if (ps->gpu_sub_tex[i])
+            SDL_ReleaseGPUTexture(ps->gpu_device, ps->gpu_sub_tex[i]);
+
+        SDL_GPUTextureCreateInfo tex_info;
+        SDL_zero(tex_info);
+        tex_info.type                 = SDL_GPU_TEXTURETYPE_2D;
+        tex_info.format               = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM;
+        tex_info.width                = w;
+        tex_info.height               = h;
+        tex_info.layer_count_or_depth = 1;
+        tex_info.num_levels           = 1;
+        tex_info.usage                = SDL_GPU_TEXTUREUSAGE_SAMPLER;
+        ps->gpu_sub_tex[i]   = SDL_CreateGPUTexture(ps->gpu_device, &tex_info);
+        ps->gpu_sub_tex_w[i] = ps->gpu_sub_tex[i] ? w : 0;
+        ps->gpu_sub_tex_h[i] = ps->gpu_sub_tex[i] ? h : 0;
+        if (!ps->gpu_sub_tex[i]) {
+            log_msg("ERROR: Failed to create subtitle texture (%dx%d): %s",
+                    w, h, SDL_GetError());
+            return;
+        }
+    }
+
+    /* Premultiply while staging: the layer is drawn with linear
+     * filtering and a premultiplied blend (gpu_pipeline_sub) */
+    uint8_t *dst = SDL_MapGPUTransferBuffer(ps->gpu_device, ps->gpu_sub_xfer, true);
+    if (!dst) return;
+    for (int i = 0; i < n; i++) {
+        size_t px = (size_t)ps->sub_bitmap_w[i] * ps->sub_bitmap_h[i];
+        const uint8_t *src = ps->sub_bitmap_data[i];
+        for (size_t p = 0; p < px; p++, src += 4, dst += 4) {
+            unsigned a = src[3];
+            dst[0] = (uint8_t)((src[0] * a + 127) / 255);
+            dst[1] = (uint8_t)((src[1] * a + 127) / 255);
+            dst[2] = (uint8_t)((src[2] * a + 127) / 255);
+            dst[3] = (uint8_t)a;
+        }
+    }
+    SDL_UnmapGPUTransferBuffer(ps->gpu_device, ps->gpu_sub_xfer);
+
+    ps->gpu_sub_count = n;
+    ps->gpu_sub_dirty = 1;
+}
+
+/* Destroy subtitle layer GPU resources. */
+void gpu_sub_destroy(PlayerState *ps) {
+    if (!ps->gpu_device) return;
+
+    for (int i = 0; i < MAX_SUB_BITMAPS; i++) {
+        if (ps->gpu_sub_tex[i])
+            SDL_ReleaseGPUTexture(ps->gpu_device, ps->gpu_sub_tex[i]);
+        ps->gpu_sub_tex[i]   = NULL;
+        ps->gpu_sub_tex_w[i] = 0;
+        ps->gpu_sub_tex_h[i] = 0;
+    }
+    if (ps->gpu_sub_xfer) {
+        SDL_ReleaseGPUTransferBuffer(ps->gpu_device, ps->gpu_sub_xfer);
+        ps->gpu_sub_xfer = NULL;
+    }
+    ps->gpu_sub_xfer_size = 0;
+    ps->gpu_sub_count     = 0;
+    ps->gpu_sub_dirty     = 0;
+    ps->gpu_sub_serial    = -1;   /* re-upload on next use */
+    ps->sub_layer_active  = 0;
 }
 
 
 /* ═══════════════════════════════════════════════════════════════════
- * Packet Queue — thread-safe FIFO for AVPackets
- * ═══════════════════════════════════════════════════════════════════ */
+ * Packet Queue — lock-free SPSC ring of AVPackets
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Producer (demux) owns head and bytes_in; consumer owns tail and
+ * bytes_out. Each side publishes its index with an SDL atomic store
+ * after touching the slot, which orders the packet data against the
+ * other side's index load.
+ *
+ * pq_flush acts as the consumer. It must run with the real consumer
+ * quiesced: on seek the demux thread holds seek_mutex (subtitle drain
+ * uses TryLock) and each decoder's codec lock, vdec_mutex and
+ * adec_mutex; on audio track change the flushing thread holds
+ * adec_mutex. Lock order: seek_mutex, vdec_mutex, adec_mutex.
+ */
 
-void pq_init(PacketQueue *q) {
+
+/* Packet duration in µs for readahead accounting. Producer and consumer
+ * compute it from the same packet fields, so the totals cancel exactly.
+ * The demux thread stamps pkt->time_base with the stream's time base. */
+static unsigned pq_pkt_duration(const AVPacket *pkt) {
+    if (pkt->duration <= 0 || pkt->time_base.num <= 0 || pkt->time_base.den <= 0)
+        return 0;
+    return (unsigned)av_rescale_q(pkt->duration, pkt->time_base, AV_TIME_BASE_Q);
+}
+
+/* Wake the demux thread if it is parked waiting for queue space. */
+static void pq_signal_space(PacketQueue *q) {
+    DemuxWait *w = q->space_wait;
+    if (w && SDL_GetAtomicInt(&w->waiting)) {
+        SDL_LockMutex(w->mutex);
+        SDL_SignalCondition(w->cond);
+        SDL_UnlockMutex(w->mutex);
+    }
+}
+
+/* slots must be a power of two (the index is masked) */
+void pq_init_sized(PacketQueue *q, unsigned slots) {
     memset(q, 0, sizeof(PacketQueue));
+    q->slots = av_calloc(slots, sizeof(AVPacket *));
+    if (q->slots) {
+        q->capacity = slots;
+        for (unsigned i = 0; i < slots; i++)
+            q->slots[i] = av_packet_alloc();
+    }
     q->mutex = SDL_CreateMutex();
     q->cond  = SDL_CreateCondition();
 }
 
+void pq_init(PacketQueue *q) {
+    pq_init_sized(q, PACKET_QUEUE_SLOTS);
+}
+
 void pq_destroy(PacketQueue *q) {
-    pq_flush(q);
+    if (q->slots) {
+        pq_flush(q);
+        for (unsigned i = 0; i < q->capacity; i++)
+            av_packet_free(&q->slots[i]);
+        av_freep(&q->slots);
+    }
     if (q->mutex) SDL_DestroyMutex(q->mutex);
     if (q->cond)  SDL_DestroyCondition(q->cond);
+    q->mutex = NULL;
+    q->cond  = NULL;
 }
 
-/* Push a packet onto the queue. Caller still owns pkt after this call
- * returns — we move the packet data into a new AVPacket internally. */
+/* Push a packet onto the queue (producer only). The packet data is moved
+ * into a preallocated slot; pkt is left blank. If the ring is full the
+ * packet is dropped (unref'd) and -1 is returned; the first drop on a
+ * queue is logged. */
 int pq_put(PacketQueue *q, AVPacket *pkt) {
-    PacketNode *node = av_malloc(sizeof(PacketNode));
-    if (!node) return -1;
-
-    node->pkt = av_packet_alloc();
-    if (!node->pkt) {
-        av_free(node);
+    unsigned head = (unsigned)SDL_GetAtomicInt(&q->head);
+    unsigned tail = (unsigned)SDL_GetAtomicInt(&q->tail);
+
+    AVPacket *slot = q->slots ? q->slots[head & (q->capacity - 1)] : NULL;
+    if (head - tail >= q->capacity || !slot) {
+        if (q->dropped++ == 0)
+            log_msg("WARN: packet queue full, dropping stream %d packets",
+                    pkt->stream_index);
+        av_packet_unref(pkt);
         return -1;
     }
-    av_packet_move_ref(node->pkt, pkt);
-    node->next = NULL;
-
-    SDL_LockMutex(q->mutex);
 
-    if (!q->last) {
-        q->first = node;
-    } else {
-        q->last->next = node;
+    int size = pkt->size;
+    unsigned dur = pq_pkt_duration(pkt);
+    av_packet_move_ref(slot, pkt);
+    SDL_SetAtomicInt(&q->bytes_in,
+        (int)((unsigned)SDL_GetAtomicInt(&q->bytes_in) + (unsigned)size));
+    SDL_SetAtomicInt(&q->dur_in,
+        (int)((unsigned)SDL_GetAtomicInt(&q->dur_in) + dur));
+    SDL_SetAtomicInt(&q->head, (int)(head + 1));   /* publish slot */
+
+    /* Wake a consumer parked on an empty queue. The consumer sets waiting
+     * before re-checking head under the mutex, so either it sees this
+     * packet or we see waiting=1 here. */
+    if (SDL_GetAtomicInt(&q->waiting)) {
+        SDL_LockMutex(q->mutex);
+        SDL_SignalCondition(q->cond);
+        SDL_UnlockMutex(q->mutex);
     }
-    q->last = node;
-    q->nb_packets++;
-    q->size += node->pkt->size;
+    return 0;
+}
 
-    SDL_SignalCondition(q->cond);
+/* Pop one packet into pkt (consumer only). Returns 1 on success,
+ * 0 if empty (and not blocking), -1 if the queue was aborted. */
+static int pq_try_pop(PacketQueue *q, AVPacket *pkt) {
+    unsigned tail = (unsigned)SDL_GetAtomicInt(&q->tail);
+    unsigned head = (unsigned)SDL_GetAtomicInt(&q->head);
+    if (tail == head) return 0;
+
+    AVPacket *slot = q->slots[tail & (q->capacity - 1)];
+    SDL_SetAtomicInt(&q->bytes_out,
+        (int)((unsigned)SDL_GetAtomicInt(&q->bytes_out) + (unsigned)slot->size));
+    SDL_SetAtomicInt(&q->dur_out,
+        (int)((unsigned)SDL_GetAtomicInt(&q->dur_out) + pq_pkt_duration(slot)));
+    av_packet_move_ref(pkt, slot);
+    SDL_SetAtomicInt(&q->tail, (int)(tail + 1));   /* release slot */
+    pq_signal_space(q);
+    return 1;
+}
+
+/* Sleep until the queue is non-empty, aborted, or timeout_ms elapses
+ * (timeout_ms < 0 waits indefinitely). Consumer only. Returns 1 if
+ * packets are available, 0 on timeout, -1 if aborted. This is the only
+ * place a consumer touches the mutex. */
+int pq_wait(PacketQueue *q, int timeout_ms) {
+    if (q->abort_request) return -1;
+    if (pq_nb_packets(q) > 0) return 1;
+
+    SDL_LockMutex(q->mutex);
+    SDL_SetAtomicInt(&q->waiting, 1);
+    if (!q->abort_request && pq_nb_packets(q) == 0) {
+        if (timeout_ms < 0)
+            SDL_WaitCondition(q->cond, q->mutex);
+        else
+            SDL_WaitConditionTimeout(q->cond, q->mutex, timeout_ms);
+    }
+    SDL_SetAtomicInt(&q->waiting, 0);
     SDL_UnlockMutex(q->mutex);
-    return 0;
+
+    if (q->abort_request) return -1;
+    return pq_nb_packets(q) > 0 ? 1 : 0;
 }
 
 /* Pop a packet from the queue. If block=1, waits until data arrives
  * or abort_request is set. Returns 1 on success, 0 if non-blocking
  * and empty, -1 if aborted. */
 int pq_get(PacketQueue *q, AVPacket *pkt, int block) {
-    int ret = -1;
+    for (;;) {
+        if (q->abort_request) return -1;
+        if (!q->slots) return 0;
+
+        int ret = pq_try_pop(q, pkt);
+        if (ret || !block) return ret;
+
+        if (pq_wait(q, -1) < 0) return -1;
+    }
+}
+
+/* Flush all packets from the queue. Called on seek or close, with the
+ * queue's consumer quiesced (see section comment). */
+void pq_flush(PacketQueue *q) {
+    if (!q->slots) return;
+    unsigned tail = (unsigned)SDL_GetAtomicInt(&q->tail);
+    unsigned head = (unsigned)SDL_GetAtomicInt(&q->head);
+    unsigned out  = (unsigned)SDL_GetAtomicInt(&q->bytes_out);
+    unsigned dout = (unsigned)SDL_GetAtomicInt(&q->dur_out);
+    while (tail != head) {
+        AVPacket *slot = q->slots[tail & (q->capacity - 1)];
+        out  += (unsigned)slot->size;
+        dout += pq_pkt_duration(slot);
+        av_packet_unref(slot);
+        tail++;
+    }
+    SDL_SetAtomicInt(&q->bytes_out, (int)out);
+    SDL_SetAtomicInt(&q->dur_out, (int)dout);
+    SDL_SetAtomicInt(&q->tail, (int)tail);
+    pq_signal_space(q);
+}
 
+/* Make every current and future pq_get/pq_wait on this queue return -1. */
+void pq_abort(PacketQueue *q) {
     SDL_LockMutex(q->mutex);
-    for (;;) {
-        if (q->abort_request) {
-            ret = -1;
-            break;
-        }
+    q->abort_request = 1;
+    SDL_BroadcastCondition(q->cond);
+    SDL_UnlockMutex(q->mutex);
+}
 
-        PacketNode *node = q->first;
-        if (node) {
-            q->first = node->next;
-            if (!q->first) q->last = NULL;
-            q->nb_packets--;
-            q->size -= node->pkt->size;
+/* ═══════════════════════════════════════════════════════════════════
+ * Frame Queue — bounded ring of decoded video frames
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Single producer (video decode thread), single consumer (main thread).
+ * The producer blocks while the ring is full; the consumer never blocks,
+ * it just finds nothing to show yet and re-blits the previous frame.
+ */
 
-            av_packet_move_ref(pkt, node->pkt);
-            av_packet_free(&node->pkt);
-            av_free(node);
-            ret = 1;
-            break;
-        } else if (!block) {
-            ret = 0;
-            break;
-        } else {
-            SDL_WaitCondition(q->cond, q->mutex);
-        }
+int fq_init(FrameQueue *q, int capacity) {
+    memset(q, 0, sizeof(FrameQueue));
+    if (capacity < 2) capacity = 2;
+    if (capacity > FRAME_QUEUE_MAX) capacity = FRAME_QUEUE_MAX;
+    q->capacity = capacity;
+
+    for (int i = 0; i < capacity; i++) {
+        q->slots[i].frame = av_frame_alloc();
+        if (!q->slots[i].frame) return -1;
+    }
+    q->mutex = SDL_CreateMutex();
+    q->cond  = SDL_CreateCondition();
+    return 0;
+}
+
+void fq_destroy(FrameQueue *q) {
+    for (int i = 0; i < q->capacity; i++) {
+        if (q->slots[i].frame) av_frame_free(&q->slots[i].frame);
+    }
+    if (q->mutex) SDL_DestroyMutex(q->mutex);
+    if (q->cond)  SDL_DestroyCondition(q->cond);
+    memset(q, 0, sizeof(FrameQueue));
+}
+
+/* Move a decoded frame into the ring. Blocks while the ring is full.
+ * Returns 1 if queued, 0 if dropped because a seek flushed the queue
+ * after the frame was decoded (stale serial), -1 if aborted.
+ * frame is left empty on return in every case. */
+int fq_push(FrameQueue *q, AVFrame *frame, double pts, int serial) {
+    int ret;
+
+    SDL_LockMutex(q->mutex);
+    while (q->count >= q->capacity && !q->abort_request && serial == q->serial)
+        SDL_WaitCondition(q->cond, q->mutex);
+
+    if (q->abort_request) {
+        ret = -1;
+    } else if (serial != q->serial) {
+        ret = 0;
+    } else {
+        FrameSlot *slot = &q->slots[q->windex];
+        av_frame_move_ref(slot->frame, frame);
+        slot->pts = pts;
+        q->windex = (q->windex + 1) % q->capacity;
+        q->count++;
+        ret = 1;
     }
     SDL_UnlockMutex(q->mutex);
+
+    av_frame_unref(frame);
     return ret;
 }
 
-/* Flush all packets from the queue. Called on seek or close. */
-void pq_flush(PacketQueue *q) {
+/* Pop the oldest frame into dst (previous contents of dst are released).
+ * Non-blocking: returns 1 on success, 0 if the ring is empty. */
+int fq_pop(FrameQueue *q, AVFrame *dst, double *pts) {
+    int ret = 0;
+
+    SDL_LockMutex(q->mutex);
+    if (q->count > 0) {
+        FrameSlot *slot = &q->slots[q->rindex];
+        av_frame_unref(dst);
+        av_frame_move_ref(dst, slot->frame);
+        if (pts) *pts = slot->pts;
+        q->rindex = (q->rindex + 1) % q->capacity;
+        q->count--;
+        SDL_SignalCondition(q->cond);
+        ret = 1;
+    }
+    SDL_UnlockMutex(q->mutex);
+    return ret;
+}
+
+/* Drop every queued frame and start a new serial. Called on seek with
+ * vdec_mutex held, so no frame decoded before the flush can be pushed
+ * under the new serial. */
+void fq_flush(FrameQueue *q) {
+    SDL_LockMutex(q->mutex);
+    for (int i = 0; i < q->capacity; i++)
+        av_frame_unref(q->slots[i].frame);
+    q->rindex = 0;
+    q->windex = 0;
+    q->count  = 0;
+    q->serial++;
+    SDL_BroadcastCondition(q->cond);
+    SDL_UnlockMutex(q->mutex);
+}
+
+/* Wake a producer blocked in fq_push and make it return -1. */
+void fq_abort(FrameQueue *q) {
     SDL_LockMutex(q->mutex);
-    PacketNode *node = q->first;
-    while (node) {
-        PacketNode *next = node->next;
-        av_packet_free(&node->pkt);
-        av_free(node);
-        node = next;
-    }
-    q->first = NULL;
-    q->last  = NULL;
-    q->nb_packets = 0;
-    q->size = 0;
+    q->abort_request = 1;
+    SDL_BroadcastCondition(q->cond);
     SDL_UnlockMutex(q->mutex);
 }
 
@@ -1596,6 +2300,96 @@ void pq_flush(PacketQueue *q) {
  * Open / Close
  * ═══════════════════════════════════════════════════════════════════ */
 
+/* Find and open the software video decoder for stream vidx of fc.
+ * threads/type override the thread policy (type 0 = none); measure
+ * queues a new stream class for idle-time calibration (bench.c). Also
+ * used by the playlist open-ahead thread (preopen.c). Returns NULL on
+ * failure. */
+AVCodecContext *video_decoder_open(AVFormatContext *fc, int vidx, const char *path,
+                                   int threads, int type, int measure, int *calibrated)
+{
+    AVStream *vs = fc->streams[vidx];
+    const AVCodec *codec = NULL;
+
+    /* FFmpeg 8.1's generic 'av1' decoder probes for hardware accel
+     * first and fails catastrophically on systems without AV1 HW
+     * decode (spams "Failed to get pixel format", zero frames output).
+     * Force libdav1d — it's pure software, always works, and is the
+     * reference AV1 decoder. */
+    if (vs->codecpar->codec_id == AV_CODEC_ID_AV1) {
+        codec = avcodec_find_decoder_by_name("libdav1d");
+        if (codec)
+            log_msg("Video codec: libdav1d forced for AV1 (avoiding hw probe)");
+    }
+    if (!codec)
+        codec = avcodec_find_decoder(vs->codecpar->codec_id);
+    if (!codec) {
+        log_msg("ERROR: Unsupported video codec id=%d", vs->codecpar->codec_id);
+        return NULL;
+    }
+    if (vs->codecpar->codec_id != AV_CODEC_ID_AV1)
+        log_msg("Video codec: %s (%s)", codec->name, codec->long_name);
+
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    if (!ctx) return NULL;
+    avcodec_parameters_to_context(ctx, vs->codecpar);
+
+    /* Thread count: auto-detect, capped at 12 for HEVC.
+     *
+     * FF_THREAD_FRAME buffers N frames before outputting the first.
+     * Pipeline fill latency = N × frame_dur (linear, not log).
+     * At 24fps: 16T=667ms, 12T=500ms, 8T=333ms, 4T=167ms.
+     *
+     * On high-core machines (16T+), the 667ms fill causes permanent
+     * A/V desync on heavy files (4K HEVC 10-bit + TrueHD + 29 streams).
+     * Cap at 12 limits fill to 500ms while retaining decode throughput.
+     * Low-core machines (≤12 cores) are unaffected — auto stays below cap.
+     *
+     * Non-HEVC codecs (VC-1, H.264) are uncapped — their pipeline fill
+     * is small enough that the existing A/V sync handles it fine.
+     *
+     * H.264 cap at 8: on high-core machines (16T+), uncapped auto gives
+     * 16 threads → 533ms pipeline fill at 30fps.  Combined with MPEG-TS
+     * interleaved audio/video, this widens the PTS gap between the first
+     * audio and video packets after seek, amplifying post-seek A/V drift.
+     * Cap at 8 (267ms fill) retains full decode throughput for 1080p. */
+    ctx->thread_count = 0; /* auto-detect first */
+    ctx->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
+    if (codec->id == AV_CODEC_ID_HEVC) {
+        ctx->thread_count = 12;
+    } else if (codec->id == AV_CODEC_ID_H264) {
+        int auto_count = SDL_GetNumLogicalCPUCores();
+        if (auto_count > 8) {
+            ctx->thread_count = 8;
+        }
+    }
+
+    /* A per-machine calibration for this stream class replaces the
+     * caps above, which remain the fallback (bench.c). An explicit
+     * override (--bench-decode sweep) replaces both. */
+    *calibrated = 0;
+    if (type) {
+        ctx->thread_count = threads;
+        ctx->thread_type  = type;
+    } else {
+        int n, t;
+        if (calib_decoder_threads(fc, vidx, path, measure, &n, &t)) {
+            ctx->thread_count = n;
+            ctx->thread_type  = t;
+            *calibrated = 1;
+        }
+    }
+
+    int ret = avcodec_open2(ctx, codec, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "[DSVP] Cannot open video codec: %s\n", av_err2str(ret));
+        avcodec_free_context(&ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
 /* Open a media file: probe format, find best streams, init decoders,
  * set up scaling context, create GPU textures, start demux thread. */
 int player_open(PlayerState *ps, const char *filename) {
@@ -1605,19 +2399,26 @@ int player_open(PlayerState *ps, const char *filename) {
     ps->filepath[sizeof(ps->filepath) - 1] = '\0';
     log_msg("player_open: %s", filename);
 
-    /* ── Open container ── */
+    /* ── Open container ──
+     * A playlist neighbour may already be open and probed (preopen.c) */
     ps->fmt_ctx = NULL;
-    ret = avformat_open_input(&ps->fmt_ctx, filename, NULL, NULL);
-    if (ret < 0) {
-        log_msg("ERROR: avformat_open_input failed: %s", av_err2str(ret));
-        return -1;
-    }
+    preopen_free(&ps->preopen_adopted);
+    if (preopen_take(ps, filename, &ps->preopen_adopted)) {
+        ps->fmt_ctx = ps->preopen_adopted.fmt_ctx;
+        ps->preopen_adopted.fmt_ctx = NULL;
+    } else {
+        ret = avformat_open_input(&ps->fmt_ctx, filename, NULL, NULL);
+        if (ret < 0) {
+            log_msg("ERROR: avformat_open_input failed: %s", av_err2str(ret));
+            return -1;
+        }
 
-    ret = avformat_find_stream_info(ps->fmt_ctx, NULL);
-    if (ret < 0) {
-        log_msg("ERROR: avformat_find_stream_info failed: %s", av_err2str(ret));
-        avformat_close_input(&ps->fmt_ctx);
-        return -1;
+        ret = avformat_find_stream_info(ps->fmt_ctx, NULL);
+        if (ret < 0) {
+            log_msg("ERROR: avformat_find_stream_info failed: %s", av_err2str(ret));
+            avformat_close_input(&ps->fmt_ctx);
+            return -1;
+        }
     }
     log_msg("Container: %s (%s), streams=%d",
         ps->fmt_ctx->iformat->name, ps->fmt_ctx->iformat->long_name,
@@ -1627,39 +2428,18 @@ int player_open(PlayerState *ps, const char *filename) {
     ps->video_stream_idx = av_find_best_stream(ps->fmt_ctx, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
     ps->audio_stream_idx = av_find_best_stream(ps->fmt_ctx, AVMEDIA_TYPE_AUDIO, -1, ps->video_stream_idx, NULL, 0);
 
-    /* ── Skip TrueHD audio (unusable without HDMI bitstreaming) ──
-     *
-     * TrueHD Atmos 7.1 MLP decode is extremely CPU-heavy and starves the
-     * video pipeline on complex files (4K HEVC 10-bit + 29 streams).
-     * Without an AVR/soundbar via HDMI, it just gets crushed to S16 stereo
-     * anyway — pointless pain. Every Blu-ray with TrueHD ships an AC3 or
-     * EAC3 compatibility track. Pick that instead.
-     *
-     * Will be removed when HDMI bitstreaming support lands. */
-    if (ps->audio_stream_idx >= 0) {
-        AVStream *as = ps->fmt_ctx->streams[ps->audio_stream_idx];
-        if (as->codecpar->codec_id == AV_CODEC_ID_TRUEHD) {
-            log_msg("Audio: default stream is TrueHD — skipping (no bitstream support)");
-            int fallback = -1;
-            for (unsigned i = 0; i < ps->fmt_ctx->nb_streams; i++) {
-                AVStream *st = ps->fmt_ctx->streams[i];
-                if (st->codecpar->codec_type != AVMEDIA_TYPE_AUDIO) continue;
-                if ((int)i == ps->audio_stream_idx) continue;
-                if (st->codecpar->codec_id == AV_CODEC_ID_TRUEHD) continue;
-                fallback = (int)i;
-                break;
-            }
-            if (fallback >= 0) {
-                const AVCodec *fc = avcodec_find_decoder(
-                    ps->fmt_ctx->streams[fallback]->codecpar->codec_id);
-                log_msg("Audio: fallback to stream %d (%s)",
-                    fallback, fc ? fc->name : "unknown");
-                ps->audio_stream_idx = fallback;
-            } else {
-                log_msg("Audio: no non-TrueHD fallback found — playing without audio");
-                ps->audio_stream_idx = -1;
-            }
-        }
+    /* TrueHD / DTS-HD MA are decoded like any other track: audio decode
+     * has its own high-priority thread and a deeper PCM ring for them
+     * (audio.c), so they no longer compete in lockstep with the video
+     * decoder's frame threads. */
+
+    /* Headless mode renders video only — no audio device, no A/V clock.
+     * --bench-audio keeps audio and picks the track itself. */
+    if (ps->bench_audio) {
+        ps->audio_stream_idx = ps->bench_audio_stream;
+    } else if (ps->headless && ps->audio_stream_idx >= 0) {
+        log_msg("Audio: disabled in headless mode");
+        ps->audio_stream_idx = -1;
     }
 
     if (ps->video_stream_idx < 0) {
@@ -1670,79 +2450,27 @@ int player_open(PlayerState *ps, const char *filename) {
     log_msg("Video stream: idx=%d, Audio stream: idx=%d",
         ps->video_stream_idx, ps->audio_stream_idx);
 
-    /* ── Open video decoder (SOFTWARE ONLY) ── */
-    {
-        AVStream *vs = ps->fmt_ctx->streams[ps->video_stream_idx];
-        const AVCodec *codec = NULL;
-
-        /* FFmpeg 8.1's generic 'av1' decoder probes for hardware accel
-         * first and fails catastrophically on systems without AV1 HW
-         * decode (spams "Failed to get pixel format", zero frames output).
-         * Force libdav1d — it's pure software, always works, and is the
-         * reference AV1 decoder. */
-        if (vs->codecpar->codec_id == AV_CODEC_ID_AV1) {
-            codec = avcodec_find_decoder_by_name("libdav1d");
-            if (codec)
-                log_msg("Video codec: libdav1d forced for AV1 (avoiding hw probe)");
-        }
-        if (!codec)
-            codec = avcodec_find_decoder(vs->codecpar->codec_id);
-        if (!codec) {
-            log_msg("ERROR: Unsupported video codec id=%d", vs->codecpar->codec_id);
-            avformat_close_input(&ps->fmt_ctx);
-            return -1;
-        }
-        if (vs->codecpar->codec_id != AV_CODEC_ID_AV1)
-            log_msg("Video codec: %s (%s)", codec->name, codec->long_name);
-
-        ps->video_codec_ctx = avcodec_alloc_context3(codec);
-        avcodec_parameters_to_context(ps->video_codec_ctx, vs->codecpar);
-
-        /* Thread count: auto-detect, capped at 12 for HEVC.
-         *
-         * FF_THREAD_FRAME buffers N frames before outputting the first.
-         * Pipeline fill latency = N × frame_dur (linear, not log).
-         * At 24fps: 16T=667ms, 12T=500ms, 8T=333ms, 4T=167ms.
-         *
-         * On high-core machines (16T+), the 667ms fill causes permanent
-         * A/V desync on heavy files (4K HEVC 10-bit + TrueHD + 29 streams).
-         * Cap at 12 limits fill to 500ms while retaining decode throughput.
-         * Low-core machines (≤12 cores) are unaffected — auto stays below cap.
-         *
-         * Non-HEVC codecs (VC-1, H.264) are uncapped — their pipeline fill
-         * is small enough that the existing A/V sync handles it fine.
-         *
-         * H.264 cap at 8: on high-core machines (16T+), uncapped auto gives
-         * 16 threads → 533ms pipeline fill at 30fps.  Combined with MPEG-TS
-         * interleaved audio/video, this widens the PTS gap between the first
-         * audio and video packets after seek, amplifying post-seek A/V drift.
-         * Cap at 8 (267ms fill) retains full decode throughput for 1080p. */
-        ps->video_codec_ctx->thread_count = 0; /* auto-detect first */
-        ps->video_codec_ctx->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
-
-        if (codec->id == AV_CODEC_ID_HEVC) {
-            ps->video_codec_ctx->thread_count = 12;
-        } else if (codec->id == AV_CODEC_ID_H264) {
-            int auto_count = SDL_GetNumLogicalCPUCores();
-            if (auto_count > 8) {
-                ps->video_codec_ctx->thread_count = 8;
-            }
-        }
-
-        ret = avcodec_open2(ps->video_codec_ctx, codec, NULL);
-        if (ret < 0) {
-            fprintf(stderr, "[DSVP] Cannot open video codec: %s\n", av_err2str(ret));
-            avformat_close_input(&ps->fmt_ctx);
-            return -1;
-        }
-
-        ps->vid_w = ps->video_codec_ctx->width;
-        ps->vid_h = ps->video_codec_ctx->height;
-        log_msg("Video: %dx%d, pix_fmt=%s, threads=%d",
-            ps->vid_w, ps->vid_h,
-            av_get_pix_fmt_name(ps->video_codec_ctx->pix_fmt),
-            ps->video_codec_ctx->thread_count);
+    /* ── Open video decoder (SOFTWARE ONLY), or adopt the primed one ── */
+    ps->video_codec_ctx = preopen_take_decoder(&ps->preopen_adopted, ps->video_stream_idx,
+                                               &ps->vdec_calibrated);
+    /* The primed decoder keeps its default caps for this file; a new
+     * class is queued for idle-time calibration as on a direct open */
+    if (ps->video_codec_ctx && !ps->vdec_calibrated && !ps->headless)
+        calib_queue(ps->fmt_ctx, ps->video_stream_idx, filename);
+    if (!ps->video_codec_ctx)
+        ps->video_codec_ctx = video_decoder_open(ps->fmt_ctx, ps->video_stream_idx, filename,
+                                                 ps->vdec_threads, ps->vdec_thread_type,
+                                                 !ps->headless, &ps->vdec_calibrated);
+    if (!ps->video_codec_ctx) {
+        avformat_close_input(&ps->fmt_ctx);
+        return -1;
     }
+    ps->vid_w = ps->video_codec_ctx->width;
+    ps->vid_h = ps->video_codec_ctx->height;
+    log_msg("Video: %dx%d, pix_fmt=%s, threads=%d",
+        ps->vid_w, ps->vid_h,
+        av_get_pix_fmt_name(ps->video_codec_ctx->pix_fmt),
+        ps->video_codec_ctx->thread_count);
 
     /* ── Open audio decoder ── */
     if (ps->audio_stream_idx >= 0) {
@@ -1946,8 +2674,11 @@ int player_open(PlayerState *ps, const char *filename) {
         }
     }
 
-    /* ── Resize window to video dimensions ── */
-    {
+    /* ── Resize window to video dimensions (none in headless mode) ── */
+    if (!ps->window) {
+        ps->win_w = ps->vid_w;
+        ps->win_h = ps->vid_h;
+    } else {
         if (!ps->fullscreen) {
             /* Cap to 80% of screen, maintain aspect ratio */
             const SDL_DisplayMode *dm = SDL_GetCurrentDisplayMode(
@@ -1987,8 +2718,9 @@ int player_open(PlayerState *ps, const char *filename) {
         SDL_SetWindowTitle(ps->window, title);
     }
 
-    /* ── Create GPU textures and transfer buffers ── */
-    if (gpu_create_video_textures(ps) < 0) {
+    /* ── Create GPU textures and transfer buffers ──
+     * Skipped when decoding without a GPU device (--bench-decode). */
+    if (ps->gpu_device && gpu_create_video_textures(ps) < 0) {
         log_msg("ERROR: GPU texture creation failed");
         player_close(ps);
         return -1;
@@ -1997,15 +2729,64 @@ int player_open(PlayerState *ps, const char *filename) {
     /* ── Set up GPU color uniforms ── */
     gpu_setup_uniforms(ps);
 
-    /* ── Init packet queues ── */
+    /* ── Init packet queues ──
+     * The audio queue is sized for the busiest cataloged track, since a
+     * track switch reuses it. */
+    unsigned aud_slots = PACKET_QUEUE_SLOTS;
+    for (int i = 0; i < ps->aud_count; i++) {
+        unsigned n = audio_queue_slots(
+            ps->fmt_ctx->streams[ps->aud_stream_indices[i]]->codecpar,
+            AUDIO_QUEUE_MAX_SEC);
+        if (n > aud_slots) aud_slots = n;
+    }
+    if (ps->audio_stream_idx >= 0) {
+        unsigned n = audio_queue_slots(
+            ps->fmt_ctx->streams[ps->audio_stream_idx]->codecpar,
+            AUDIO_QUEUE_MAX_SEC);
+        if (n > aud_slots) aud_slots = n;
+    }
     pq_init(&ps->video_pq);
-    pq_init(&ps->audio_pq);
+    pq_init_sized(&ps->audio_pq, aud_slots);
     for (int i = 0; i < ps->sub_count; i++)
         pq_init(&ps->sub_pqs[i]);
+    for (int i = 0; i < ps->aud_count; i++)
+        pq_init_sized(&ps->aud_alt_pqs[i], audio_queue_slots(
+            ps->fmt_ctx->streams[ps->aud_stream_indices[i]]->codecpar,
+            AUDIO_ALT_QUEUE_SEC));
+    SDL_SetAtomicInt(&ps->aud_switch_request, 0);
+
+    /* ── Readahead budgets (subtitle queues are sparse, not throttled,
+     *    but the selected one can fill its ring and must wake demux) ── */
+    ps->demux_wait.mutex = SDL_CreateMutex();
+    ps->demux_wait.cond  = SDL_CreateCondition();
+    SDL_SetAtomicInt(&ps->demux_wait.waiting, 0);
+    ps->video_pq.max_bytes    = VIDEO_QUEUE_MAX_BYTES;
+    ps->video_pq.max_duration = (int64_t)(VIDEO_QUEUE_MAX_SEC * AV_TIME_BASE);
+    ps->video_pq.space_wait   = &ps->demux_wait;
+    ps->audio_pq.max_bytes    = AUDIO_QUEUE_MAX_BYTES;
+    ps->audio_pq.max_duration = (int64_t)(AUDIO_QUEUE_MAX_SEC * AV_TIME_BASE);
+    ps->audio_pq.space_wait   = &ps->demux_wait;
+    for (int i = 0; i < ps->sub_count; i++)
+        ps->sub_pqs[i].space_wait = &ps->demux_wait;
+
+    /* ── Init decoded frame ring (video decode thread → render loop) ── */
+    if (fq_init(&ps->video_fq, FRAME_QUEUE_SIZE) < 0) {
+        log_msg("ERROR: Cannot allocate video frame queue");
+        player_close(ps);
+        return -1;
+    }
 
-    /* ── Seek mutex (protects codec flush vs decode) ── */
+    /* ── Seek mutex and per-codec locks (codec flush vs decode) ── */
     ps->seek_mutex = SDL_CreateMutex();
+    ps->vdec_mutex = SDL_CreateMutex();
+    ps->adec_mutex = SDL_CreateMutex();
     ps->seeking    = 0;
+    ps->video_draining = 0;
+    ps->video_eof      = 0;
+    ps->seek_discard_until = -1.0;
+    ps->seek_skip_hints    = 0;
+    ps->late_applied       = LATE_NONE;
+    video_late_reset(ps);
 
     /* ── Init timing ── */
     ps->frame_timer      = get_time_sec();
@@ -2026,22 +2807,58 @@ int player_open(PlayerState *ps, const char *filename) {
     ps->diag_frames_displayed = 0;
     ps->diag_frames_decoded   = 0;
     ps->diag_frames_dropped   = 0;
+    ps->diag_frames_repeated  = 0;
     ps->diag_multi_decodes    = 0;
     ps->diag_timer_snaps      = 0;
+    ps->diag_seek_discarded   = 0;
+    ps->diag_late_skipped     = 0;
+    ps->diag_late_changes     = 0;
+    ps->diag_audio_underruns  = 0;
+    ps->diag_audio_switches   = 0;
+    ps->diag_audio_switch_seeks = 0;
+    ps->diag_audio_decode_sec = 0.0;
     ps->diag_max_av_drift     = 0.0;
     ps->diag_last_report      = get_time_sec();
+    sched_reset(ps, 1);
+    ps->preopen_after         = get_time_sec() + PREOPEN_DELAY_SEC;
 
     /* ── Open audio output ── */
     if (ps->audio_codec_ctx) {
         audio_open(ps);
     }
 
+    /* ── Open-ahead packets and first frame, before the demux thread
+     * carries on reading where the open-ahead worker stopped ── */
+    preopen_replay(ps, &ps->preopen_adopted);
+    preopen_free(&ps->preopen_adopted);
+
     /* ── Start demux thread ── */
     ps->eof     = 0;
     ps->playing = 1;
     ps->paused  = 0;
     ps->demux_thread = SDL_CreateThread(demux_thread_func, "demux", ps);
 
+    /* ── Start video decode thread ──
+     * Keeps decoding off the render loop: an expensive I-frame only
+     * drains the frame ring instead of stalling events and presentation. */
+    ps->video_thread = SDL_CreateThread(video_decode_thread_func, "vdecode", ps);
+    log_msg("Video frame queue: %d frames", ps->video_fq.capacity);
+
+    /* ── Start audio decode thread ──
+     * Decode and resample run here, not on SDL's real-time callback,
+     * which only copies PCM out of the ring. */
+    if (ps->aud_count > 0) {
+        ps->audio_space  = SDL_CreateSemaphore(0);
+        ps->audio_thread = SDL_CreateThread(audio_decode_thread_func, "adecode", ps);
+    }
+
+    /* ── Start keyframe indexer (exact seeking) ──
+     * Not for headless opens: --headless, the benches and decoder
+     * calibration never seek, and a TS scan would compete for disk and
+     * CPU with the decode they measure. */
+    if (!ps->headless)
+        seek_index_start(ps);
+
     /* Build media info string */
     player_build_media_info(ps);
 
@@ -2063,8 +2880,19 @@ void player_close(PlayerState *ps) {
         log_msg("DIAG:   Frames displayed:  %d", ps->diag_frames_displayed);
         log_msg("DIAG:   Frames dropped:    %d (%.2f%%)",
                 ps->diag_frames_dropped, drop_pct);
+        log_msg("DIAG:   Frames repeated:   %d", ps->diag_frames_repeated);
+        if (ps->sched.frames > 0)
+            log_msg("DIAG:   Off cadence:       %d / %d (max %.2f vsync)",
+                    ps->sched.off_cadence, ps->sched.frames, ps->sched.err_max);
         log_msg("DIAG:   Multi-decode ticks: %d", ps->diag_multi_decodes);
         log_msg("DIAG:   Timer snap-forwards: %d", ps->diag_timer_snaps);
+        log_msg("DIAG:   Seek discards:     %d", ps->diag_seek_discarded);
+        log_msg("DIAG:   Late policy:       %d changes, %d packets skipped",
+                ps->diag_late_changes, ps->diag_late_skipped);
+        log_msg("DIAG:   Audio underruns:   %d", ps->diag_audio_underruns);
+        if (ps->diag_audio_switches > 0)
+            log_msg("DIAG:   Audio switches:    %d (%d seek fallbacks)",
+                    ps->diag_audio_switches, ps->diag_audio_switch_seeks);
         log_msg("DIAG:   Peak A/V drift:    %.1fms",
                 ps->diag_max_av_drift * 1000.0);
         log_msg("DIAG:   A/V bias:          %.1fms",
@@ -2074,10 +2902,9 @@ void player_close(PlayerState *ps) {
     ps->quit = 1;
 
     /* Signal queues to unblock any waiting threads */
-    ps->video_pq.abort_request = 1;
-    ps->audio_pq.abort_request = 1;
-    SDL_SignalCondition(ps->video_pq.cond);
-    SDL_SignalCondition(ps->audio_pq.cond);
+    pq_abort(&ps->video_pq);
+    pq_abort(&ps->audio_pq);
+    demux_wake(ps);
 
     /* Wait for demux thread */
     if (ps->demux_thread) {
@@ -2085,8 +2912,27 @@ void player_close(PlayerState *ps) {
         ps->demux_thread = NULL;
     }
 
+    /* Wait for video decode thread (may be blocked on a full frame ring) */
+    fq_abort(&ps->video_fq);
+    if (ps->video_thread) {
+        SDL_WaitThread(ps->video_thread, NULL);
+        ps->video_thread = NULL;
+    }
+
+    /* Wait for audio decode thread (waits are bounded at 10ms) */
+    if (ps->audio_thread) {
+        SDL_WaitThread(ps->audio_thread, NULL);
+        ps->audio_thread = NULL;
+    }
+
+    /* Stop keyframe indexer (aborts a scan in progress) */
+    seek_index_stop(ps);
+    ps->seek_discard_until = -1.0;
+    ps->seek_skip_hints    = 0;
+
     /* Close audio */
     audio_close(ps);
+    if (ps->audio_space) { SDL_DestroySemaphore(ps->audio_space); ps->audio_space = NULL; }
 
     /* Close subtitles */
     sub_close_codec(ps);
@@ -2096,9 +2942,20 @@ void player_close(PlayerState *ps) {
     pq_destroy(&ps->audio_pq);
     for (int i = 0; i < ps->sub_count; i++)
         pq_destroy(&ps->sub_pqs[i]);
+    for (int i = 0; i < ps->aud_count; i++)
+        pq_destroy(&ps->aud_alt_pqs[i]);
+    if (ps->aud_switch_ctx) avcodec_free_context(&ps->aud_switch_ctx);
+    SDL_SetAtomicInt(&ps->aud_switch_request, 0);
+    fq_destroy(&ps->video_fq);
 
-    /* Destroy seek mutex */
+    /* Destroy demux wakeup */
+    if (ps->demux_wait.mutex) { SDL_DestroyMutex(ps->demux_wait.mutex); ps->demux_wait.mutex = NULL; }
+    if (ps->demux_wait.cond)  { SDL_DestroyCondition(ps->demux_wait.cond); ps->demux_wait.cond = NULL; }
+
+    /* Destroy seek mutex and codec locks */
     if (ps->seek_mutex) { SDL_DestroyMutex(ps->seek_mutex); ps->seek_mutex = NULL; }
+    if (ps->vdec_mutex) { SDL_DestroyMutex(ps->vdec_mutex); ps->vdec_mutex = NULL; }
+    if (ps->adec_mutex) { SDL_DestroyMutex(ps->adec_mutex); ps->adec_mutex = NULL; }
 
     /* Free frames */
     if (ps->video_frame)  av_frame_free(&ps->video_frame);
@@ -2134,8 +2991,11 @@ void player_close(PlayerState *ps) {
     ps->audio_buf_index    = 0;
     ps->seek_request       = 0;
     ps->seeking            = 0;
+    ps->video_draining     = 0;
+    ps->video_eof          = 0;
     ps->seek_recovering    = 0;
     ps->audio_pts_floor    = 0.0;
+    ps->audio_splice_pts   = 0.0;
     ps->video_ready        = 0;
     ps->show_debug         = 0;
     ps->show_info          = 0;
@@ -2154,23 +3014,241 @@ void player_close(PlayerState *ps) {
     ps->sub_text[0]        = '\0';
     ps->sub_osd[0]         = '\0';
 
-    /* Reset window (skip resize if fullscreen — actual size is monitor) */
-    SDL_SetWindowTitle(ps->window, DSVP_WINDOW_TITLE);
-    if (!ps->fullscreen) {
-        SDL_SetWindowSize(ps->window, DEFAULT_WIN_W, DEFAULT_WIN_H);
-        SDL_SetWindowPosition(ps->window,
-            SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
+    /* Reset window (skip resize if fullscreen — actual size is monitor) */
+    if (!ps->window) return;
+    SDL_SetWindowTitle(ps->window, DSVP_WINDOW_TITLE);
+    if (!ps->fullscreen) {
+        SDL_SetWindowSize(ps->window, DEFAULT_WIN_W, DEFAULT_WIN_H);
+        SDL_SetWindowPosition(ps->window,
+            SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED);
+    }
+}
+
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Demux Thread
+ * ═══════════════════════════════════════════════════════════════════
+ *
+ * Reads packets from the container file and distributes them to
+ * the video and audio packet queues.
+ *
+ * Readahead is bounded per queue by bytes and duration (see the
+ * *_QUEUE_MAX_* budgets in dsvp.h). When the budget is met the thread
+ * parks on demux_wait until a consumer pops a packet, a seek is
+ * requested, or playback closes.
+ */
+
+/* Wake the demux thread from a readahead or EOF wait. Called by
+ * seek requests and player_close; consumers signal via pq_signal_space. */
+void demux_wake(PlayerState *ps) {
+    if (!ps->demux_wait.mutex) return;
+    SDL_LockMutex(ps->demux_wait.mutex);
+    SDL_SignalCondition(ps->demux_wait.cond);
+    SDL_UnlockMutex(ps->demux_wait.mutex);
+}
+
+/* Hard limits: a full ring cannot accept a packet, and max_bytes is the
+ * queue's memory ceiling. Either one stops reading on its own. */
+static int pq_at_capacity(PacketQueue *q) {
+    if (pq_nb_packets(q) >= (int)q->capacity - 1) return 1;
+    if (q->max_bytes > 0 && pq_size(q) >= q->max_bytes) return 1;
+    return 0;
+}
+
+/* Soft limit: queue holds its readahead duration. Queues of packets
+ * without durations fall back to the byte ceiling. */
+static int pq_has_readahead(PacketQueue *q) {
+    return pq_at_capacity(q)
+        || (q->max_duration > 0 && pq_duration(q) >= q->max_duration);
+}
+
+/* Stop reading when any queue hits a hard limit, or when every active
+ * queue has its readahead. Requiring all queues keeps an early-filling
+ * audio queue from starving video (and vice versa) in files with
+ * uneven interleaving. The selected subtitle queue only has the hard
+ * limit, and only while video and audio have packets: subtitles muxed
+ * far ahead are consumed at playback pace, so waiting on them with an
+ * empty A/V queue would stall playback (pq_put then drops instead). */
+static int demux_queues_full(PlayerState *ps) {
+    int has_video = ps->video_stream_idx >= 0;
+    int has_audio = ps->audio_stream_idx >= 0 && ps->audio_codec_ctx;
+    int sub       = ps->sub_selection - 1;
+
+    if (has_video && pq_at_capacity(&ps->video_pq)) return 1;
+    if (has_audio && pq_at_capacity(&ps->audio_pq)) return 1;
+    if (sub >= 0 && sub < ps->sub_count && pq_at_capacity(&ps->sub_pqs[sub])
+            && (!has_video || pq_nb_packets(&ps->video_pq) > 0)
+            && (!has_audio || pq_nb_packets(&ps->audio_pq) > 0))
+        return 1;
+
+    return (!has_video || pq_has_readahead(&ps->video_pq))
+        && (!has_audio || pq_has_readahead(&ps->audio_pq));
+}
+
+/* Park until woken or timeout_ms elapses. 'full' selects the condition
+ * re-checked after publishing waiting=1: readahead full, or EOF. */
+static void demux_park(PlayerState *ps, int full, int timeout_ms) {
+    DemuxWait *w = &ps->demux_wait;
+    SDL_LockMutex(w->mutex);
+    SDL_SetAtomicInt(&w->waiting, 1);
+    if (!ps->quit && !ps->seek_request
+            && (!full || demux_queues_full(ps)))
+        SDL_WaitConditionTimeout(w->cond, w->mutex, timeout_ms);
+    SDL_SetAtomicInt(&w->waiting, 0);
+    SDL_UnlockMutex(w->mutex);
+}
+
+/* ── Inactive audio tracks ──
+ *
+ * Every cataloged audio track is demuxed anyway (exempt from
+ * AVDISCARD_ALL), so instead of dropping the inactive ones their
+ * packets go to a short per-track ring, trimmed to AUDIO_ALT_QUEUE_SEC
+ * — longer than the readahead, so it still covers the playback position.
+ * Each ring is sized for that duration at its track's packet rate
+ * (audio_queue_slots), so TrueHD is not cut short by the slot count.
+ * The demux thread is both producer and consumer of these rings; the
+ * track switch below runs on it too. */
+
+/* Route pkt to its alt ring if it belongs to an inactive cataloged
+ * track. Returns 1 if consumed. */
+static int demux_put_alt_audio(PlayerState *ps, AVPacket *pkt) {
+    for (int i = 0; i < ps->aud_count; i++) {
+        if (ps->aud_stream_indices[i] != pkt->stream_index) continue;
+
+        PacketQueue *q = &ps->aud_alt_pqs[i];
+        AVPacket old;
+        while (pq_nb_packets(q) >= (int)q->capacity - 1 ||
+               pq_duration(q) > (int64_t)(AUDIO_ALT_QUEUE_SEC * AV_TIME_BASE)) {
+            if (pq_get(q, &old, 0) <= 0) break;
+            av_packet_unref(&old);
+        }
+        pq_put(q, pkt);
+        return 1;
+    }
+    return 0;
+}
+
+/* Splice to the decoder audio_cycle() opened. The ring is cut
+ * AUDIO_SWITCH_LEAD past its read position (audio_ring_cut): that much
+ * of the old track still plays, the rest is dropped. The new decoder is
+ * primed from the track's alt ring starting AUDIO_SWITCH_PREROLL before
+ * the cut, and audio_decode_frame() trims its output to begin on the
+ * cut sample and crossfades it in over AUDIO_SWITCH_FADE. The old
+ * track's undecoded packets become its alt ring, so switching back is
+ * instant too. Falls back to a seek if the alt ring does not reach back
+ * to the splice point (e.g. switching straight back); how often is
+ * logged, with the time from key press to the new track being heard. */
+static void demux_switch_audio(PlayerState *ps) {
+    double t0 = get_time_sec();
+    int old_sel = ps->aud_selection;
+    int new_sel = ps->aud_switch_sel;
+    int new_idx = ps->aud_stream_indices[new_sel];
+    AVPacket pkt;
+
+    /* Audio decode thread out; video decode and the callback carry on */
+    SDL_LockMutex(ps->adec_mutex);
+
+    double splice, heard = 0.0;
+    if (!audio_ring_cut(ps, AUDIO_SWITCH_LEAD, &splice, &heard))
+        splice = ps->audio_clock_sync;
+
+    /* Old track: packets not yet decoded become its alt ring */
+    PacketQueue *old_q = &ps->aud_alt_pqs[old_sel];
+    pq_flush(old_q);
+    while (pq_get(&ps->audio_pq, &pkt, 0) > 0)
+        pq_put(old_q, &pkt);
+
+    /* New track: drop what ends before the preroll, move the rest */
+    PacketQueue *new_q = &ps->aud_alt_pqs[new_sel];
+    double tb = av_q2d(ps->fmt_ctx->streams[new_idx]->time_base);
+    double first = -1.0;
+    while (pq_get(new_q, &pkt, 0) > 0) {
+        if (first < 0.0) {
+            if (pkt.pts == AV_NOPTS_VALUE ||
+                (pkt.pts + pkt.duration) * tb < splice - AUDIO_SWITCH_PREROLL) {
+                av_packet_unref(&pkt);
+                continue;
+            }
+            first = pkt.pts * tb;
+        }
+        pq_put(&ps->audio_pq, &pkt);
+    }
+
+    /* Swap decoders. The old context goes back to the main thread
+     * (audio_cycle frees it), which may still be reading it for the
+     * debug panel. */
+    AVCodecContext *old_ctx = ps->audio_codec_ctx;
+    ps->audio_codec_ctx = ps->aud_switch_ctx;
+    ps->aud_switch_ctx  = old_ctx;
+    if (ps->swr_ctx) swr_free(&ps->swr_ctx);
+
+    ps->audio_stream_idx = new_idx;
+    ps->aud_selection    = new_sel;
+    ps->audio_clock      = splice;
+    ps->audio_pts_floor  = 0.0;
+    /* Old decoder output not yet in the ring lies past the splice */
+    ps->audio_buf_size   = 0;
+    ps->audio_buf_index  = 0;
+
+    int covered = first >= 0.0 && first <= splice + 0.05;
+    ps->diag_audio_switches++;
+    if (covered) {
+        ps->audio_splice_pts = splice;
+    } else {
+        ps->audio_xfade_len = 0;
+        ps->diag_audio_switch_seeks++;
+        /* Not enough buffered for this track — fall back to a seek */
+        ps->seek_target  = (int64_t)(fmax(splice, 0.0) * AV_TIME_BASE);
+        ps->seek_flags   = AVSEEK_FLAG_BACKWARD;
+        ps->seek_request = 1;
     }
+    SDL_UnlockMutex(ps->adec_mutex);
+    SDL_SetAtomicInt(&ps->aud_switch_request, 0);
+
+    /* Heard after: key press to here, plus the old PCM still ahead of
+     * the cut. A seek fallback is heard once the seek recovers. */
+    double now = get_time_sec();
+    if (covered)
+        log_msg("Audio: spliced %s at %.3fs, heard after ~%.0fms "
+                "(%.1fms request, %.1fms splice, %.0fms buffered) "
+                "(%d of %d switches fell back to a seek)",
+            ps->aud_stream_names[new_sel], splice,
+            (now - ps->aud_switch_time + heard) * 1000.0,
+            (t0 - ps->aud_switch_time) * 1000.0, (now - t0) * 1000.0,
+            heard * 1000.0,
+            ps->diag_audio_switch_seeks, ps->diag_audio_switches);
+    else
+        log_msg("Audio: switched %s at %.3fs via seek after %.1fms "
+                "(%d of %d switches fell back to a seek)",
+            ps->aud_stream_names[new_sel], splice,
+            (now - ps->aud_switch_time) * 1000.0,
+            ps->diag_audio_switch_seeks, ps->diag_audio_switches);
 }
 
-
-/* ═══════════════════════════════════════════════════════════════════
- * Demux Thread
- * ═══════════════════════════════════════════════════════════════════
- *
- * Reads packets from the container file and distributes them to
- * the video and audio packet queues.
- */
+/* Hand one demuxed packet to its queue: active video/audio, an inactive
+ * audio track's switch buffer, or a subtitle track. Anything else is
+ * dropped. Also replays the open-ahead packets (preopen.c). */
+void demux_route_packet(PlayerState *ps, AVPacket *pkt) {
+    /* Stamp the stream time base for queue duration accounting */
+    pkt->time_base = ps->fmt_ctx->streams[pkt->stream_index]->time_base;
+
+    if (pkt->stream_index == ps->video_stream_idx) {
+        pq_put(&ps->video_pq, pkt);
+    } else if (pkt->stream_index == ps->audio_stream_idx) {
+        pq_put(&ps->audio_pq, pkt);
+    } else if (demux_put_alt_audio(ps, pkt)) {
+        /* inactive audio track — kept for instant switching */
+    } else {
+        /* Check subtitle streams */
+        for (int i = 0; i < ps->sub_count; i++) {
+            if (pkt->stream_index == ps->sub_stream_indices[i]) {
+                pq_put(&ps->sub_pqs[i], pkt);
+                return;
+            }
+        }
+        av_packet_unref(pkt);
+    }
+}
 
 int demux_thread_func(void *arg) {
     PlayerState *ps = (PlayerState *)arg;
@@ -2183,17 +3261,40 @@ int demux_thread_func(void *arg) {
             int64_t target = ps->seek_target;
             log_msg("Demux: seeking to %.3f s", (double)target / AV_TIME_BASE);
 
-            /* CRITICAL: Lock the seek mutex. This prevents the main thread
-             * from calling avcodec_send_packet/receive_frame on the video
-             * codec while we flush it. The audio callback is also paused. */
+            /* Seek mutex keeps the subtitle drain out. The decoders
+             * keep running on what is queued while the container seeks;
+             * their codec locks are taken only for the flush below. */
             SDL_LockMutex(ps->seek_mutex);
             ps->seeking = 1;
 
-            /* Pause audio device so callback can't touch audio codec */
+            /* Pause audio device so stale PCM stops playing */
             if (ps->audio_stream)
                 SDL_PauseAudioStreamDevice(ps->audio_stream);
 
-            int ret = av_seek_frame(ps->fmt_ctx, -1, target, ps->seek_flags);
+            /* Exact seek: land on the last keyframe at or before the
+             * target, then the decode thread drops frames up to it.
+             * With the keyframe index that is a direct jump; until the
+             * index is ready, av_seek_frame backward does the search. */
+            int64_t kf_ts, kf_pos;
+            int ret;
+            if (seek_index_lookup(&ps->seek_index, target, &kf_ts, &kf_pos)) {
+                if (ps->seek_index.by_byte && kf_pos >= 0)
+                    ret = avformat_seek_file(ps->fmt_ctx, -1, INT64_MIN,
+                                             kf_pos, kf_pos, AVSEEK_FLAG_BYTE);
+                else
+                    ret = avformat_seek_file(ps->fmt_ctx, ps->video_stream_idx,
+                                             INT64_MIN, kf_ts, kf_ts, 0);
+                log_msg("Demux: index seek to keyframe %.3f s",
+                        kf_ts * av_q2d(ps->seek_index.time_base));
+            } else {
+                ret = av_seek_frame(ps->fmt_ctx, -1, target,
+                                    ps->seek_flags | AVSEEK_FLAG_BACKWARD);
+            }
+
+            /* CRITICAL: from here to the clock reset neither decoder may
+             * call avcodec_send_packet/receive_frame or touch its queue */
+            SDL_LockMutex(ps->vdec_mutex);
+            SDL_LockMutex(ps->adec_mutex);
             if (ret < 0) {
                 log_msg("ERROR: Seek failed: %s", av_err2str(ret));
             } else {
@@ -2202,12 +3303,23 @@ int demux_thread_func(void *arg) {
                 pq_flush(&ps->audio_pq);
                 for (int i = 0; i < ps->sub_count; i++)
                     pq_flush(&ps->sub_pqs[i]);
+                for (int i = 0; i < ps->aud_count; i++)
+                    pq_flush(&ps->aud_alt_pqs[i]);
                 log_msg("Demux: queues flushed, flushing video codec");
                 if (ps->video_codec_ctx)
                     avcodec_flush_buffers(ps->video_codec_ctx);
+                fq_flush(&ps->video_fq);
+                ps->video_draining = 0;
+                ps->video_eof      = 0;
+                /* Decoding to the seek target needs every packet; the
+                 * render loop re-escalates if still late afterwards */
+                SDL_SetAtomicInt(&ps->late_level, LATE_NONE);
+                ps->seek_discard_until = (ps->video_stream_idx >= 0)
+                    ? (double)target / AV_TIME_BASE : -1.0;
                 log_msg("Demux: video codec flushed, flushing audio codec");
                 if (ps->audio_codec_ctx)
                     avcodec_flush_buffers(ps->audio_codec_ctx);
+                bitstream_flush(ps);
                 if (ps->sub_codec_ctx)
                     avcodec_flush_buffers(ps->sub_codec_ctx);
                 ps->sub_valid = 0;
@@ -2217,9 +3329,10 @@ int demux_thread_func(void *arg) {
             ps->seek_request = 0;
             ps->eof = 0;
 
-            /* Reset audio decode buffer (safe — callback is paused) */
-            ps->audio_buf_size  = 0;
-            ps->audio_buf_index = 0;
+            /* Drop buffered PCM (decode thread is locked out by
+             * adec_mutex; the ring reset takes the stream lock) */
+            audio_ring_reset(ps);
+            ps->audio_splice_pts = 0.0;
 
             /* Reset both clocks to the seek target. Without this,
              * video_clock retains the old position until the first
@@ -2232,6 +3345,8 @@ int demux_thread_func(void *arg) {
                 ps->video_clock = seek_pos;
             }
 
+            SDL_UnlockMutex(ps->adec_mutex);
+            SDL_UnlockMutex(ps->vdec_mutex);
             ps->seeking = 0;
             SDL_UnlockMutex(ps->seek_mutex);
 
@@ -2243,17 +3358,23 @@ int demux_thread_func(void *arg) {
             ps->av_bias = 0.0;
             ps->av_bias_samples = 0;
 
-            /* Resume audio playback */
-            if (ps->audio_stream && !ps->paused)
+            /* Resume audio playback. While the decode thread discards
+             * up to an exact target, audio stays paused — main.c resumes
+             * it with the first displayed frame, and the audio PTS floor
+             * then drops the audio decoded from the keyframe onwards. */
+            if (ps->audio_stream && !ps->paused && ps->seek_discard_until < 0.0)
                 SDL_ResumeAudioStreamDevice(ps->audio_stream);
 
             log_msg("Demux: seek complete");
         }
 
-        /* ── Throttle if queues are full ── */
-        if (ps->video_pq.nb_packets > PACKET_QUEUE_MAX ||
-            ps->audio_pq.nb_packets > PACKET_QUEUE_MAX) {
-            SDL_Delay(10);
+        /* ── Splice in a new audio track (audio_cycle fast path) ── */
+        if (SDL_GetAtomicInt(&ps->aud_switch_request))
+            demux_switch_audio(ps);
+
+        /* ── Throttle on readahead budget ── */
+        if (demux_queues_full(ps)) {
+            demux_park(ps, 1, 100);
             continue;
         }
 
@@ -2263,32 +3384,14 @@ int demux_thread_func(void *arg) {
             if (ret == AVERROR_EOF || avio_feof(ps->fmt_ctx->pb)) {
                 if (!ps->eof) log_msg("Demux: reached end of file");
                 ps->eof = 1;
-                SDL_Delay(100);
+                demux_park(ps, 0, 100);  /* until seek or close */
                 continue;
             }
             log_msg("ERROR: av_read_frame failed: %s", av_err2str(ret));
             break; /* real error */
         }
 
-        /* Route packet to the correct queue */
-        if (pkt->stream_index == ps->video_stream_idx) {
-            pq_put(&ps->video_pq, pkt);
-        } else if (pkt->stream_index == ps->audio_stream_idx) {
-            pq_put(&ps->audio_pq, pkt);
-        } else {
-            /* Check subtitle streams */
-            int routed = 0;
-            for (int i = 0; i < ps->sub_count; i++) {
-                if (pkt->stream_index == ps->sub_stream_indices[i]) {
-                    pq_put(&ps->sub_pqs[i], pkt);
-                    routed = 1;
-                    break;
-                }
-            }
-            if (!routed) {
-                av_packet_unref(pkt);
-            }
-        }
+        demux_route_packet(ps, pkt);
     }
 
     av_packet_free(&pkt);
@@ -2301,59 +3404,261 @@ int demux_thread_func(void *arg) {
  * Video Decode & Display
  * ═══════════════════════════════════════════════════════════════════ */
 
-/* Decode one video frame from the packet queue.
- * Returns 1 if a frame was decoded, 0 if no packets available, -1 on error. */
-int video_decode_frame(PlayerState *ps) {
+/* Exact-seek decode hints. While packets are still short of the seek
+ * target, non-reference frames are skipped inside the decoder: nothing
+ * depends on them and they would be discarded anyway. Reference frames
+ * are decoded in full (loop filter included) — skipping their filtering
+ * would leave drift in the target frame. Caller holds vdec_mutex. */
+static void video_apply_hints(PlayerState *ps) {
+    enum AVDiscard frame = AVDISCARD_DEFAULT, loop = AVDISCARD_DEFAULT;
+    if (ps->seek_skip_hints) {
+        frame = AVDISCARD_NONREF;
+        loop  = AVDISCARD_NONREF;
+    }
+    /* Late policy: the stronger of the two wins */
+    if (ps->late_applied >= LATE_NONREF)  frame = AVDISCARD_NONREF;
+    if (ps->late_applied >= LATE_NOLOOP)  loop  = AVDISCARD_NONKEY;
+    if (ps->late_applied >= LATE_KEYONLY) frame = AVDISCARD_NONKEY;
+    ps->video_codec_ctx->skip_frame       = frame;
+    ps->video_codec_ctx->skip_loop_filter = loop;
+}
+
+static void video_set_skip_hints(PlayerState *ps, int on) {
+    if (ps->seek_skip_hints == on) return;
+    ps->seek_skip_hints = on;
+    video_apply_hints(ps);
+}
+
+/* Decode one video frame from the packet queue into frame.
+ * Runs on the video decode thread. On success, *pts is the frame's
+ * presentation time in seconds and *serial the frame queue serial it
+ * was decoded under (read while vdec_mutex is held, so a concurrent
+ * seek flush is always detected by fq_push).
+ * Returns 1 if a frame was decoded, 2 if a frame was decoded but dropped
+ * short of an exact seek target, 0 if no packets available, -1 on error. */
+int video_decode_frame(PlayerState *ps, AVFrame *frame, double *pts, int *serial) {
     AVPacket pkt;
     int ret;
 
-    /* If a seek is in progress, skip decode entirely.
-     * The demux thread holds seek_mutex and is flushing codecs. */
-    if (ps->seeking) return 0;
-
-    /* Lock to prevent demux thread from flushing codecs mid-decode */
-    if (!SDL_TryLockMutex(ps->seek_mutex)) {
-        return 0; /* mutex held by seek — skip this frame */
-    }
+    /* Lock to prevent demux thread from flushing the codec mid-decode.
+     * Blocks for the length of a seek flush; never held by audio. */
+    SDL_LockMutex(ps->vdec_mutex);
 
     for (;;) {
         /* Try to receive a decoded frame first (may have buffered frames) */
-        ret = avcodec_receive_frame(ps->video_codec_ctx, ps->video_frame);
+        ret = avcodec_receive_frame(ps->video_codec_ctx, frame);
         if (ret == 0) {
             /* Got a frame — compute its PTS in seconds.
              * best_effort_timestamp is preferred: FFmpeg computes it
              * from DTS/packet timing even when the codec doesn't set
              * frame->pts (required for VC-1, some MPEG-2, etc.). */
             AVStream *vs = ps->fmt_ctx->streams[ps->video_stream_idx];
-            double pts = 0.0;
-            int64_t frame_pts = ps->video_frame->best_effort_timestamp;
+            int64_t frame_pts = frame->best_effort_timestamp;
             if (frame_pts == AV_NOPTS_VALUE)
-                frame_pts = ps->video_frame->pts;
-            if (frame_pts != AV_NOPTS_VALUE) {
-                pts = (double)frame_pts * av_q2d(vs->time_base);
+                frame_pts = frame->pts;
+            *pts = (frame_pts != AV_NOPTS_VALUE)
+                ? (double)frame_pts * av_q2d(vs->time_base) : 0.0;
+            *serial = ps->video_fq.serial;
+
+            /* Exact seek: drop frames before the target. Half a frame
+             * of tolerance keeps the frame that covers the target. A
+             * target far beyond the frame is a timestamp discontinuity,
+             * not a GOP — stop discarding rather than eat the stream. */
+            if (ps->seek_discard_until >= 0.0 && frame_pts != AV_NOPTS_VALUE) {
+                double half = (frame->duration > 0)
+                    ? 0.5 * frame->duration * av_q2d(vs->time_base) : 0.02;
+                double gap  = ps->seek_discard_until - *pts;
+                if (gap > half && gap < SEEK_DISCARD_MAX_SEC) {
+                    av_frame_unref(frame);
+                    ps->diag_seek_discarded++;
+                    SDL_UnlockMutex(ps->vdec_mutex);
+                    return 2;
+                }
+                ps->seek_discard_until = -1.0;
+                video_set_skip_hints(ps, 0);
             }
-            ps->video_clock = pts;
-            SDL_UnlockMutex(ps->seek_mutex);
+            SDL_UnlockMutex(ps->vdec_mutex);
             return 1;
         }
+        if (ret == AVERROR_EOF || (ret != AVERROR(EAGAIN) && ps->video_draining)) {
+            /* Decoder drained after EOF — nothing more until a seek */
+            ps->video_eof = 1;
+            ps->seek_discard_until = -1.0;
+            video_set_skip_hints(ps, 0);
+            SDL_UnlockMutex(ps->vdec_mutex);
+            return 0;
+        }
         if (ret != AVERROR(EAGAIN)) {
             log_msg("ERROR: avcodec_receive_frame (video) failed: %s", av_err2str(ret));
-            SDL_UnlockMutex(ps->seek_mutex);
+            SDL_UnlockMutex(ps->vdec_mutex);
             return -1; /* decoder error */
         }
 
         /* Need to feed more packets to the decoder */
         ret = pq_get(&ps->video_pq, &pkt, 0);
         if (ret <= 0) {
-            SDL_UnlockMutex(ps->seek_mutex);
+            /* Demuxer finished and the queue is dry: send the flush
+             * packet so frame-threaded decoders release the frames
+             * they are still holding (up to thread_count of them). */
+            if (ret == 0 && ps->eof && !ps->video_draining) {
+                avcodec_send_packet(ps->video_codec_ctx, NULL);
+                ps->video_draining = 1;
+                continue;
+            }
+            SDL_UnlockMutex(ps->vdec_mutex);
             return 0;  /* no packets available right now */
         }
 
+        /* Decoder hints follow the packet: frame threads copy them at
+         * submission, so toggling per packet is exact. Packets are in
+         * decode order — only a packet whose own PTS is short of the
+         * target can be skipped if it turns out to be non-reference. */
+        if (ps->seek_discard_until >= 0.0) {
+            AVStream *vs = ps->fmt_ctx->streams[ps->video_stream_idx];
+            double tb   = av_q2d(vs->time_base);
+            double half = (pkt.duration > 0) ? 0.5 * pkt.duration * tb : 0.02;
+            double gap  = (pkt.pts != AV_NOPTS_VALUE)
+                ? ps->seek_discard_until - pkt.pts * tb : 0.0;
+            video_set_skip_hints(ps, gap > half && gap < SEEK_DISCARD_MAX_SEC);
+        }
+
+        /* Late policy (video_late_update). Leaving keyframes-only waits
+         * for a keyframe: the packets in between were never decoded, so
+         * anything predicted from them would be garbage. After a seek
+         * the decoder was flushed and nothing is predicted yet. */
+        int late = SDL_GetAtomicInt(&ps->late_level);
+        if (late != ps->late_applied
+                && (late > ps->late_applied || ps->late_applied < LATE_KEYONLY
+                    || (pkt.flags & AV_PKT_FLAG_KEY)
+                    || ps->seek_discard_until >= 0.0)) {
+            ps->late_applied = late;
+            video_apply_hints(ps);
+        }
+        if (ps->late_applied >= LATE_KEYONLY && !(pkt.flags & AV_PKT_FLAG_KEY)) {
+            ps->diag_late_skipped++;
+            av_packet_unref(&pkt);
+            continue;
+        }
+
         avcodec_send_packet(ps->video_codec_ctx, &pkt);
         av_packet_unref(&pkt);
     }
 }
 
+/* Video decode thread: decodes ahead of the render loop into video_fq.
+ * Blocks in fq_push while the ring is full (paused, or decoding faster
+ * than real time), so at most FRAME_QUEUE_SIZE frames are held. */
+int video_decode_thread_func(void *arg) {
+    PlayerState *ps = (PlayerState *)arg;
+    AVFrame *frame = av_frame_alloc();
+    log_msg("Video decode thread started");
+
+    while (frame && !ps->quit) {
+        double pts = 0.0;
+        int serial = 0;
+        int ret = video_decode_frame(ps, frame, &pts, &serial);
+
+        if (ret == 1) {
+            if (fq_push(&ps->video_fq, frame, pts, serial) < 0)
+                break;  /* aborted by player_close */
+        } else if (ret == 2) {
+            continue;   /* discarded on the way to a seek target */
+        } else if (ret < 0) {
+            SDL_Delay(10);
+        } else {
+            /* Starved — sleep until the demuxer pushes a packet. The
+             * timeout covers EOF, which arrives without a packet. */
+            pq_wait(&ps->video_pq, 10);
+        }
+    }
+
+    av_frame_free(&frame);
+    log_msg("Video decode thread exiting");
+    return 0;
+}
+
+/* Take the next decoded frame from the ring for display.
+ * Called from the render loop; never decodes and never blocks.
+ * Moves the frame into ps->video_frame and advances video_clock.
+ * Returns 1 if a frame was taken, 0 if the ring is empty. */
+int video_next_frame(PlayerState *ps) {
+    double pts;
+    if (!fq_pop(&ps->video_fq, ps->video_frame, &pts))
+        return 0;
+    ps->video_clock = pts;
+    return 1;
+}
+
+/* ── Late-frame policy ──
+ *
+ * When decode cannot keep up, dropping frames after decode (main.c) still
+ * pays for every decode. Instead the render loop reports how far video
+ * is behind the audio clock, and the decoder sheds work in steps:
+ * non-reference frames, then the loop filter, then everything but
+ * keyframes. A level holds while it takes effect; sustained lateness
+ * escalates, sustained catch-up steps back down one level at a time.
+ */
+
+static const char *late_level_name(int level) {
+    switch (level) {
+    case LATE_NONREF:  return "skip non-ref";
+    case LATE_NOLOOP:  return "skip non-ref + loop filter";
+    case LATE_KEYONLY: return "keyframes only";
+    default:           return "full decode";
+    }
+}
+
+static void video_late_set(PlayerState *ps, int level, double lag, double now) {
+    int old = SDL_GetAtomicInt(&ps->late_level);
+    SDL_SetAtomicInt(&ps->late_level, level);
+    ps->late_changed   = now;
+    ps->late_bad_since = 0.0;
+    ps->late_ok_since  = 0.0;
+    ps->diag_late_changes++;
+    log_msg("DIAG: late policy %s -> %s at %.3fs (video behind by %.1fms)",
+            late_level_name(old), late_level_name(level),
+            ps->video_clock, lag * 1000.0);
+}
+
+/* Main thread, once per displayed frame with a trusted A/V difference.
+ * lag is how far video trails the audio clock (seconds, > 0 = late). */
+void video_late_update(PlayerState *ps, double lag, double now) {
+    int level = SDL_GetAtomicInt(&ps->late_level);
+
+    if (lag > LATE_ENTER_SEC) {
+        ps->late_ok_since = 0.0;
+        if (ps->late_bad_since <= 0.0)
+            ps->late_bad_since = now;
+        if (level < LATE_KEYONLY
+                && now - ps->late_bad_since >= LATE_ESCALATE_SEC
+                && now - ps->late_changed   >= LATE_ESCALATE_SEC)
+            video_late_set(ps, level + 1, lag, now);
+    } else if (lag < LATE_EXIT_SEC) {
+        ps->late_bad_since = 0.0;
+        if (level == LATE_NONE)
+            return;
+        if (ps->late_ok_since <= 0.0)
+            ps->late_ok_since = now;
+        if (now - ps->late_ok_since >= LATE_RECOVER_SEC
+                && now - ps->late_changed >= LATE_RECOVER_SEC)
+            video_late_set(ps, level - 1, lag, now);
+    } else {
+        ps->late_bad_since = 0.0;
+        ps->late_ok_since  = 0.0;
+    }
+}
+
+/* Back to full decode without waiting (seek, file open). The decoder
+ * picks it up at the next packet, which after a seek is a keyframe. */
+void video_late_reset(PlayerState *ps) {
+    if (SDL_GetAtomicInt(&ps->late_level) != LATE_NONE)
+        log_msg("DIAG: late policy reset to full decode");
+    SDL_SetAtomicInt(&ps->late_level, LATE_NONE);
+    ps->late_changed   = 0.0;
+    ps->late_bad_since = 0.0;
+    ps->late_ok_since  = 0.0;
+}
+
 /* Compute the letterboxed display rectangle for the video.
  * Maintains aspect ratio within the current window, centering with
  * black bars on the shorter axis. Call after window resize or video open. */
@@ -2384,39 +3689,50 @@ void player_update_display_rect(PlayerState *ps) {
 }
 
 
-/* ── Upload one YUV plane from AVFrame to GPU transfer buffer ──
+/* ── Stage one YUV plane from AVFrame into a mapped upload slot ──
  *
- * Handles stride mismatch: FFmpeg's linesize may be wider than the
- * actual pixel width (alignment padding). The transfer buffer is
- * tightly packed at the target width. */
-static void upload_plane(
-    SDL_GPUDevice *device,
-    SDL_GPUTransferBuffer *xfer,
+ * When the source linesize fits the slot's row pitch the plane is copied
+ * with a single memcpy, padding included, and the GPU copy reads it with
+ * pixels_per_row = linesize. Otherwise rows are repacked tightly.
+ * Returns the staged row pitch in samples (for pixels_per_row). */
+static Uint32 stage_plane(
+    uint8_t *dst, Uint32 dst_pitch,
     const uint8_t *src, int src_stride,
-    int width, int height)
+    int width, int height, int bpp)
 {
-    uint8_t *dst = SDL_MapGPUTransferBuffer(device, xfer, true);
-    if (!dst) return;
+    if (src_stride >= width && (Uint32)src_stride <= dst_pitch
+            && src_stride % bpp == 0) {
+        /* Last row copies only the visible bytes — the source buffer
+         * is not guaranteed to extend a full stride past it. */
+        memcpy(dst, src, (size_t)src_stride * (height - 1) + width);
+        return (Uint32)(src_stride / bpp);
+    }
 
-    if (src_stride == width) {
-        /* Tightly packed — single memcpy */
-        memcpy(dst, src, (size_t)width * height);
-    } else {
-        /* Stride mismatch — copy row by row */
-        for (int row = 0; row < height; row++) {
-            memcpy(dst + row * width, src + row * src_stride, width);
-        }
+    /* Stride mismatch — copy row by row */
+    for (int row = 0; row < height; row++) {
+        memcpy(dst + (size_t)row * width, src + (size_t)row * src_stride, width);
     }
+    return (Uint32)(width / bpp);
+}
 
-    SDL_UnmapGPUTransferBuffer(device, xfer);
+/* Take the next upload slot, waiting for the GPU if it is still reading
+ * it from GPU_UPLOAD_RING frames ago (only happens when the GPU lags). */
+static GPUUploadSlot *gpu_upload_acquire(PlayerState *ps) {
+    GPUUploadSlot *slot = &ps->gpu_upload[ps->gpu_upload_idx];
+    if (slot->fence) {
+        SDL_WaitForGPUFences(ps->gpu_device, true, &slot->fence, 1);
+        SDL_ReleaseGPUFence(ps->gpu_device, slot->fence);
+        slot->fence = NULL;
+    }
+    return slot;
 }
 
 
 /* ═══════════════════════════════════════════════════════════════════
- * HDR Dynamic Peak Detection (Layer 1 — CPU histogram scan)
+ * HDR Dynamic Peak Detection
  *
- * Builds a 256-bin histogram of Y plane values per frame, reads off
- * the 99.875th percentile, converts to nits via PQ EOTF, and applies
+ * Builds a histogram of Y plane values per frame, reads off the
+ * 99.875th percentile, converts to nits via PQ EOTF, and applies
  * temporal smoothing. Using a percentile instead of max avoids
  * specular highlights (sun glints, lamp reflections) inflating the
  * peak, which would cause BT.2390 to over-compress midtones.
@@ -2426,7 +3742,14 @@ static void upload_plane(
  * We use a slightly more aggressive value to better handle older
  * film content with occasional bright hotspots.
  *
- * Layer 2 will move this to a GPU compute shader for zero CPU cost.
+ * Layer 2 (default): compute passes on the uploaded gpu_tex_y build a
+ * full-resolution 1024-bin histogram and reduce it to the percentile
+ * bin on the GPU. The bin is read back through the upload slot's
+ * readback buffer on the next frame, so the peak lags one frame and
+ * costs no CPU time on the render thread.
+ *
+ * Layer 1 (fallback, no compute support): 256-bin CPU histogram of the
+ * full-resolution Y plane using the SIMD kernels in histogram.c.
  * ═══════════════════════════════════════════════════════════════════ */
 
 /* PQ EOTF (SMPTE ST 2084): PQ code value [0,1] → linear nits [0,10000].
@@ -2800,65 +4123,31 @@ static void dovi_populate_uniforms(PlayerState *ps, const AVFrame *frame)
 #define PEAK_MIN_NITS       100.0f   /* floor to prevent near-zero peaks   */
 #define PEAK_PERCENTILE     99.875f  /* skip top 0.125% (specular hotspots) */
 
-/* Scan the Y plane, build histogram, extract percentile peak,
- * convert to nits, smooth, and update the uniform.
- * Called once per frame from video_display() for HDR content only. */
-static void hdr_compute_scene_peak(PlayerState *ps, const AVFrame *frame,
-                                   int is_10bit)
+/* Layer 1 fallback: 256-bin histogram of the full-resolution Y plane
+ * on the CPU (SIMD kernels, histogram.c). Returns the percentile as a
+ * texture-space value. */
+static float hdr_scan_percentile_cpu(PlayerState *ps, const AVFrame *frame,
+                                     int is_10bit)
 {
-    /* Skip if not HDR or in PQ bypass debug mode */
-    if (ps->gpu_uniforms.is_hdr < 0.5f) return;
-    if (ps->gpu_uniforms.hdr_debug > 1.5f && ps->gpu_uniforms.hdr_debug < 2.5f)
-        return;  /* mode 2: PQ bypass, use static peak */
-
-    /* DV Profile 5: skip CPU histogram — I-plane is IPTPQc2, not PQ luma.
-     * Histogram reads garbage, stuck at PEAK_MIN_NITS floor.  Use the
-     * static peak from source_max_pq (updated per-frame by dovi_populate_uniforms). */
-    if (ps->gpu_uniforms.is_dovi > 0.5f) {
-        ps->hdr_smoothed_peak = ps->hdr_static_peak;
-        ps->hdr_prev_frame_peak = ps->hdr_static_peak;
-        ps->gpu_uniforms.hdr_peak_nits = ps->hdr_static_peak;
-        return;
-    }
-
-    const uint8_t *data = frame->data[0];
-    int stride = frame->linesize[0];
-    int w = ps->vid_w;
-    int h = ps->vid_h;
-
     /* ── Build 256-bin histogram of Y plane ──
-     * Subsample 4× in each dimension to reduce work.
-     * For 10-bit: bin = uint16 >> 8 (top 8 bits → 256 bins).
+     * For 10-bit: bin = code >> 2 (10 bits → 256 bins).
      * For 8-bit:  bin = uint8 value directly. */
-    int histogram[256];
-    memset(histogram, 0, sizeof(histogram));
-    int total_samples = 0;
-
-    if (is_10bit) {
-        for (int y = 0; y < h; y += 4) {
-            const uint16_t *row = (const uint16_t *)(data + y * stride);
-            for (int x = 0; x < w; x += 4) {
-                histogram[row[x] >> 8]++;
-                total_samples++;
-            }
-        }
-    } else {
-        for (int y = 0; y < h; y += 4) {
-            const uint8_t *row = data + y * stride;
-            for (int x = 0; x < w; x += 4) {
-                histogram[row[x]]++;
-                total_samples++;
-            }
-        }
-    }
+    uint32_t histogram[256];
+    if (is_10bit)
+        hist_luma_u10(frame->data[0], frame->linesize[0],
+                      ps->vid_w, ps->vid_h, histogram);
+    else
+        hist_luma_u8(frame->data[0], frame->linesize[0],
+                     ps->vid_w, ps->vid_h, histogram);
+    uint32_t total_samples = (uint32_t)ps->vid_w * (uint32_t)ps->vid_h;
 
     /* ── Find the 99.875th percentile bin ──
      * Walk from the top bin downward, accumulating counts until
      * we've passed (100 - PEAK_PERCENTILE)% of total samples. */
-    int skip_count = (int)((100.0f - PEAK_PERCENTILE) / 100.0f * total_samples);
+    uint32_t skip_count = (uint32_t)((100.0f - PEAK_PERCENTILE) / 100.0f * total_samples);
     if (skip_count < 1) skip_count = 1;
 
-    int accumulated = 0;
+    uint32_t accumulated = 0;
     int percentile_bin = 255;
     for (int i = 255; i >= 0; i--) {
         accumulated += histogram[i];
@@ -2868,15 +4157,123 @@ static void hdr_compute_scene_peak(PlayerState *ps, const AVFrame *frame,
         }
     }
 
-    /* ── Convert bin to normalized value [0,1] ──
-     * Use bin center: (bin + 0.5) / 256 for 10-bit (maps back to uint16 space).
-     * For 8-bit: (bin + 0.5) / 256 ≈ bin / 255 (close enough). */
+    /* ── Convert bin center to normalized texture value [0,1] ──
+     * 10-bit: bin covers codes [4b, 4b+3] of an R16_UNORM texel,
+     *         centre 4b + 1.5 (matches the GPU path's exact code).
+     * 8-bit:  (bin + 0.5) / 256 ≈ bin / 255 (close enough). */
+    if (is_10bit)
+        return (4.0f * (float)percentile_bin + 1.5f) / 65535.0f;
+    return ((float)percentile_bin + 0.5f) / 256.0f;
+}
+
+/* Record the GPU histogram for the frame just uploaded into `slot`:
+ * histogram pass over gpu_tex_y, reduce pass to the percentile bin,
+ * then a download of the result into the slot's readback buffer.
+ * Called from video_record_upload after the plane copy pass. */
+static void hdr_record_histogram(SDL_GPUCommandBuffer *cmd, PlayerState *ps,
+                                 GPUUploadSlot *slot)
+{
+    int is_10bit = (ps->video_codec_ctx->pix_fmt == AV_PIX_FMT_YUV420P10LE
+                    && !ps->sws_ctx);
+    Uint32 total = (Uint32)ps->vid_w * (Uint32)ps->vid_h;
+
+    HDRHistParams params;
+    params.width      = (Uint32)ps->vid_w;
+    params.height     = (Uint32)ps->vid_h;
+    params.bin_scale  = is_10bit ? 65535.0f : (float)(HDR_HIST_BINS - 1);
+    params.skip_count = (Uint32)((100.0f - PEAK_PERCENTILE) / 100.0f * total);
+    if (params.skip_count < 1) params.skip_count = 1;
+
+    SDL_GPUStorageBufferReadWriteBinding rw[2];
+    SDL_zero(rw);
+    rw[0].buffer = ps->gpu_hist_bins;
+    rw[1].buffer = ps->gpu_hist_result;
+
+    /* ── Pass 1: full-resolution histogram ── */
+    SDL_GPUComputePass *pass = SDL_BeginGPUComputePass(cmd, NULL, 0, rw, 1);
+    SDL_BindGPUComputePipeline(pass, ps->gpu_pipeline_hist);
+    SDL_GPUTextureSamplerBinding tex = {
+        .texture = ps->gpu_tex_y, .sampler = ps->gpu_sampler_nearest
+    };
+    SDL_BindGPUComputeSamplers(pass, 0, &tex, 1);
+    SDL_PushGPUComputeUniformData(cmd, 0, &params, sizeof(params));
+    SDL_DispatchGPUCompute(pass, (params.width + 15) / 16,
+                           (params.height + 15) / 16, 1);
+    SDL_EndGPUComputePass(pass);
+
+    /* ── Pass 2: percentile reduction (separate pass = barrier) ── */
+    pass = SDL_BeginGPUComputePass(cmd, NULL, 0, rw, 2);
+    SDL_BindGPUComputePipeline(pass, ps->gpu_pipeline_hist_reduce);
+    SDL_PushGPUComputeUniformData(cmd, 0, &params, sizeof(params));
+    SDL_DispatchGPUCompute(pass, 1, 1, 1);
+    SDL_EndGPUComputePass(pass);
+
+    /* ── Result → slot readback ── */
+    SDL_GPUCopyPass *copy = SDL_BeginGPUCopyPass(cmd);
+    SDL_GPUBufferRegion src = {
+        .buffer = ps->gpu_hist_result, .offset = 0, .size = 2 * sizeof(Uint32)
+    };
+    SDL_GPUTransferBufferLocation dst = { .transfer_buffer = slot->hist_rb, .offset = 0 };
+    SDL_DownloadFromGPUBuffer(copy, &src, &dst);
+    SDL_EndGPUCopyPass(copy);
+}
+
+/* Fetch the percentile from the previously submitted frame's readback.
+ * Returns 1 and sets *raw_max_norm (texture-space [0,1]) if a result
+ * was ready, 0 if the GPU has not finished it yet (keep the last peak). */
+static int hdr_read_gpu_percentile(PlayerState *ps, int is_10bit,
+                                   float *raw_max_norm)
+{
+    GPUUploadSlot *prev = &ps->gpu_upload[
+        (ps->gpu_upload_idx + GPU_UPLOAD_RING - 1) % GPU_UPLOAD_RING];
+    if (!prev->hist_pending || !prev->hist_rb) return 0;
+    if (prev->fence && !SDL_QueryGPUFence(ps->gpu_device, prev->fence))
+        return 0;
+
+    const Uint32 *res = SDL_MapGPUTransferBuffer(ps->gpu_device, prev->hist_rb, false);
+    if (!res) return 0;
+    Uint32 bin = res[0];
+    SDL_UnmapGPUTransferBuffer(ps->gpu_device, prev->hist_rb);
+    prev->hist_pending = 0;
+
+    *raw_max_norm = is_10bit
+        ? (float)bin / 65535.0f
+        : (float)bin / (float)(HDR_HIST_BINS - 1);
+    return 1;
+}
+
+/* Extract the percentile peak (GPU readback, or CPU scan of the Y
+ * plane as fallback), convert to nits, smooth, and update the uniform.
+ * Called once per frame from video_stage_frame() for HDR content only. */
+static void hdr_compute_scene_peak(PlayerState *ps, const AVFrame *frame,
+                                   int is_10bit)
+{
+    ps->gpu_hist_dispatch = 0;
+
+    /* Skip if not HDR or in PQ bypass debug mode */
+    if (ps->gpu_uniforms.is_hdr < 0.5f) return;
+    if (ps->gpu_uniforms.hdr_debug > 1.5f && ps->gpu_uniforms.hdr_debug < 2.5f)
+        return;  /* mode 2: PQ bypass, use static peak */
+
+    /* DV Profile 5: skip histogram — I-plane is IPTPQc2, not PQ luma.
+     * Histogram reads garbage, stuck at PEAK_MIN_NITS floor.  Use the
+     * static peak from source_max_pq (updated per-frame by dovi_populate_uniforms). */
+    if (ps->gpu_uniforms.is_dovi > 0.5f) {
+        ps->hdr_smoothed_peak = ps->hdr_static_peak;
+        ps->hdr_prev_frame_peak = ps->hdr_static_peak;
+        ps->gpu_uniforms.hdr_peak_nits = ps->hdr_static_peak;
+        return;
+    }
+
     float raw_max_norm;
-    if (is_10bit) {
-        /* Bin represents top 8 bits of uint16. Reconstruct midpoint. */
-        raw_max_norm = ((float)percentile_bin + 0.5f) * 256.0f / 65535.0f;
+
+    if (ps->gpu_pipeline_hist && ps->gpu_upload[0].hist_rb) {
+        /* ── GPU path: dispatch for this frame, consume the last one ── */
+        ps->gpu_hist_dispatch = 1;
+        if (!hdr_read_gpu_percentile(ps, is_10bit, &raw_max_norm))
+            return;
     } else {
-        raw_max_norm = ((float)percentile_bin + 0.5f) / 256.0f;
+        raw_max_norm = hdr_scan_percentile_cpu(ps, frame, is_10bit);
     }
 
     /* ── Apply range expansion (same math as shader) ──
@@ -2939,9 +4336,10 @@ static void hdr_compute_scene_peak(PlayerState *ps, const AVFrame *frame,
 }
 
 
-/* Display the current video frame: upload to GPU → shader draw.
- *
- * This is the hot path. Called once per new frame from main.c.
+/* Prepare the current video frame for upload: swscale if needed, DV
+ * and HDR peak analysis, then stage all three planes into the next
+ * upload slot. Returns the slot (rows[] = staged row pitch per plane,
+ * in samples) or NULL on failure.
  *
  * Three source modes, all using the YUV planar pipeline (3 textures):
  *   1. 10-bit passthrough: direct upload, 2 bytes/sample (R16_UNORM)
@@ -2949,10 +4347,7 @@ static void hdr_compute_scene_peak(PlayerState *ps, const AVFrame *frame,
  *      Range expansion (limited→full) done in fragment shader.
  *   3. All other formats: swscale → upload, 1 byte/sample (R8_UNORM)
  */
-void video_display(PlayerState *ps) {
-    if (!ps->gpu_tex_y || !ps->video_frame || !ps->video_frame->data[0]) return;
-    if (ps->seeking) return;
-
+static GPUUploadSlot *video_stage_frame(PlayerState *ps, Uint32 rows[3]) {
     int w  = ps->vid_w;
     int h  = ps->vid_h;
     int cw = w / 2;
@@ -2960,7 +4355,7 @@ void video_display(PlayerState *ps) {
 
     /* ── Determine source frame and byte width ── */
     AVFrame *src_frame;
-    int bpp;  /* bytes per sample for upload_plane */
+    int bpp;  /* bytes per sample for stage_plane */
 
     int is_10bit_passthrough =
         (ps->video_codec_ctx->pix_fmt == AV_PIX_FMT_YUV420P10LE
@@ -2992,27 +4387,39 @@ void video_display(PlayerState *ps) {
     dovi_log_frame_metadata(ps, ps->video_frame);
     dovi_populate_uniforms(ps, ps->video_frame);
 
-    /* ── HDR dynamic peak detection (CPU scan) ──
-     * Scan luma plane to find actual scene peak before uploading.
+    /* ── HDR dynamic peak detection ──
+     * Consumes last frame's GPU percentile (or scans the luma plane on
+     * the CPU as fallback) and requests this frame's histogram pass.
      * Updates hdr_peak_nits uniform with temporally smoothed value. */
     hdr_compute_scene_peak(ps, src_frame, is_10bit_passthrough);
 
-    /* ── Upload plane data to GPU transfer buffers ── */
-    upload_plane(ps->gpu_device, ps->gpu_xfer_y,
-                 src_frame->data[0], src_frame->linesize[0], w * bpp, h);
-    upload_plane(ps->gpu_device, ps->gpu_xfer_u,
-                 src_frame->data[1], src_frame->linesize[1], cw * bpp, ch);
-    upload_plane(ps->gpu_device, ps->gpu_xfer_v,
-                 src_frame->data[2], src_frame->linesize[2], cw * bpp, ch);
-
-    /* ── GPU command buffer ── */
-    SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
-    if (!cmd) {
-        log_msg("ERROR: SDL_AcquireGPUCommandBuffer failed: %s", SDL_GetError());
-        return;
+    /* ── Stage plane data into the next upload slot (one map) ── */
+    GPUUploadSlot *slot = gpu_upload_acquire(ps);
+    uint8_t *staging = SDL_MapGPUTransferBuffer(ps->gpu_device, slot->xfer, false);
+    if (!staging) {
+        log_msg("ERROR: SDL_MapGPUTransferBuffer failed: %s", SDL_GetError());
+        return NULL;
     }
+    rows[0] = stage_plane(staging, ps->gpu_upload_pitch_y,
+        src_frame->data[0], src_frame->linesize[0], w * bpp, h, bpp);
+    rows[1] = stage_plane(staging + ps->gpu_upload_off_u, ps->gpu_upload_pitch_uv,
+        src_frame->data[1], src_frame->linesize[1], cw * bpp, ch, bpp);
+    rows[2] = stage_plane(staging + ps->gpu_upload_off_v, ps->gpu_upload_pitch_uv,
+        src_frame->data[2], src_frame->linesize[2], cw * bpp, ch, bpp);
+    SDL_UnmapGPUTransferBuffer(ps->gpu_device, slot->xfer);
+    return slot;
+}
+
+/* Record the copy pass: staged upload slot → Y/U/V textures, plus the
+ * HDR histogram passes when hdr_compute_scene_peak requested them. */
+static void video_record_upload(SDL_GPUCommandBuffer *cmd, PlayerState *ps,
+                                GPUUploadSlot *slot, const Uint32 rows[3])
+{
+    int w  = ps->vid_w;
+    int h  = ps->vid_h;
+    int cw = w / 2;
+    int ch = h / 2;
 
-    /* ── Copy pass: transfer buffers → GPU textures ── */
     SDL_GPUCopyPass *copy = SDL_BeginGPUCopyPass(cmd);
     {
         SDL_GPUTextureTransferInfo src_info;
@@ -3021,8 +4428,9 @@ void video_display(PlayerState *ps) {
         /* Y plane */
         SDL_zero(src_info);
         SDL_zero(dst_region);
-        src_info.transfer_buffer = ps->gpu_xfer_y;
-        src_info.pixels_per_row  = w;
+        src_info.transfer_buffer = slot->xfer;
+        src_info.offset          = 0;
+        src_info.pixels_per_row  = rows[0];
         src_info.rows_per_layer  = h;
         dst_region.texture = ps->gpu_tex_y;
         dst_region.w = w;
@@ -3033,8 +4441,9 @@ void video_display(PlayerState *ps) {
         /* U plane */
         SDL_zero(src_info);
         SDL_zero(dst_region);
-        src_info.transfer_buffer = ps->gpu_xfer_u;
-        src_info.pixels_per_row  = cw;
+        src_info.transfer_buffer = slot->xfer;
+        src_info.offset          = ps->gpu_upload_off_u;
+        src_info.pixels_per_row  = rows[1];
         src_info.rows_per_layer  = ch;
         dst_region.texture = ps->gpu_tex_u;
         dst_region.w = cw;
@@ -3045,8 +4454,9 @@ void video_display(PlayerState *ps) {
         /* V plane */
         SDL_zero(src_info);
         SDL_zero(dst_region);
-        src_info.transfer_buffer = ps->gpu_xfer_v;
-        src_info.pixels_per_row  = cw;
+        src_info.transfer_buffer = slot->xfer;
+        src_info.offset          = ps->gpu_upload_off_v;
+        src_info.pixels_per_row  = rows[2];
         src_info.rows_per_layer  = ch;
         dst_region.texture = ps->gpu_tex_v;
         dst_region.w = cw;
@@ -3056,8 +4466,33 @@ void video_display(PlayerState *ps) {
     }
     SDL_EndGPUCopyPass(copy);
 
-    /* ── Overlay copy pass (if dirty) ── */
-    gpu_overlay_copy_cmd(cmd, ps);
+    /* HDR peak: histogram the freshly uploaded Y plane on the GPU */
+    if (ps->gpu_hist_dispatch)
+        hdr_record_histogram(cmd, ps, slot);
+    slot->hist_pending = ps->gpu_hist_dispatch;
+}
+
+/* Display the current video frame: upload to GPU → shader draw.
+ *
+ * This is the hot path. Called once per new frame from main.c.
+ */
+void video_display(PlayerState *ps) {
+    if (!ps->gpu_tex_y || !ps->video_frame || !ps->video_frame->data[0]) return;
+    if (ps->seeking) return;
+
+    Uint32 rows[3];
+    GPUUploadSlot *slot = video_stage_frame(ps, rows);
+    if (!slot) return;
+
+    /* ── GPU command buffer ── */
+    SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
+    if (!cmd) {
+        log_msg("ERROR: SDL_AcquireGPUCommandBuffer failed: %s", SDL_GetError());
+        return;
+    }
+
+    /* ── Copy pass: upload slot → GPU textures ── */
+    video_record_upload(cmd, ps, slot, rows);
 
     /* ── Acquire swapchain texture ── */
     SDL_GPUTexture *swapchain_tex = NULL;
@@ -3073,6 +4508,11 @@ void video_display(PlayerState *ps) {
         return;
     }
 
+    /* ── Overlay copy pass (if dirty) ── recorded only once the command
+     * buffer is sure to be submitted: its regions are partial updates,
+     * and a cancelled copy would leave them stale on the GPU */
+    gpu_overlay_copy_cmd(cmd, ps);
+
     /* Cache physical pixel dimensions for DPI-correct overlay sizing */
     ps->sc_w = (int)sc_w;
     ps->sc_h = (int)sc_h;
@@ -3121,7 +4561,10 @@ void video_display(PlayerState *ps) {
         gpu_overlay_draw(pass, cmd, ps, sc_w, sc_h);
     }
     SDL_EndGPURenderPass(pass);
-    SDL_SubmitGPUCommandBuffer(cmd);
+
+    /* Fence the slot so it is not rewritten while the copy is pending */
+    slot->fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmd);
+    ps->gpu_upload_idx = (ps->gpu_upload_idx + 1) % GPU_UPLOAD_RING;
 
     ps->video_ready = 1;
 }
@@ -3137,9 +4580,6 @@ void video_reblit(PlayerState *ps) {
     SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
     if (!cmd) return;
 
-    /* ── Overlay copy pass (if dirty — e.g. first reblit after overlay update) ── */
-    gpu_overlay_copy_cmd(cmd, ps);
-
     SDL_GPUTexture *swapchain_tex = NULL;
     Uint32 sc_w, sc_h;
     if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmd, ps->window,
@@ -3152,6 +4592,10 @@ void video_reblit(PlayerState *ps) {
         return;
     }
 
+    /* ── Overlay copy pass (if dirty — e.g. first reblit after overlay
+     * update); after the acquire, as in video_display ── */
+    gpu_overlay_copy_cmd(cmd, ps);
+
     /* Cache physical pixel dimensions for DPI-correct overlay sizing */
     ps->sc_w = (int)sc_w;
     ps->sc_h = (int)sc_h;
@@ -3203,6 +4647,121 @@ void video_reblit(PlayerState *ps) {
 }
 
 
+/* Headless render: stage and draw the current video frame into an
+ * offscreen target (vid_w × vid_h, gpu_target_format), then download it.
+ * Same staging, uniforms and shader as video_display — no overlay, no
+ * swapchain, no letterboxing. Each step waits on its fence so the
+ * timings are wall-clock per stage:
+ *   timings[0] upload   — CPU prep + staging (swscale, DV, HDR scan, copy)
+ *   timings[1] draw     — GPU plane copy + YUV shader pass
+ *   timings[2] readback — texture download + map
+ * *hash receives a 64-bit FNV-1a of the downloaded RGBA8 pixels.
+ * Returns 0 on success, -1 on failure. */
+int video_render_offscreen(PlayerState *ps, SDL_GPUTexture *target,
+                           SDL_GPUTransferBuffer *readback,
+                           double timings[3], uint64_t *hash)
+{
+    int w = ps->vid_w;
+    int h = ps->vid_h;
+
+    /* ── Upload ── */
+    double t0 = get_time_sec();
+    Uint32 rows[3];
+    GPUUploadSlot *slot = video_stage_frame(ps, rows);
+    if (!slot) return -1;
+    double t1 = get_time_sec();
+
+    /* ── Draw ── */
+    SDL_GPUCommandBuffer *cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
+    if (!cmd) return -1;
+
+    video_record_upload(cmd, ps, slot, rows);
+
+    SDL_GPUColorTargetInfo color_target;
+    SDL_zero(color_target);
+    color_target.texture     = target;
+    color_target.clear_color = (SDL_FColor){ 0.0f, 0.0f, 0.0f, 1.0f };
+    color_target.load_op     = SDL_GPU_LOADOP_CLEAR;
+    color_target.store_op    = SDL_GPU_STOREOP_STORE;
+
+    SDL_GPURenderPass *pass = SDL_BeginGPURenderPass(cmd, &color_target, 1, NULL);
+    {
+        SDL_BindGPUGraphicsPipeline(pass, ps->gpu_pipeline_yuv);
+
+        SDL_GPUViewport viewport = { 0.0f, 0.0f, (float)w, (float)h, 0.0f, 1.0f };
+        SDL_SetGPUViewport(pass, &viewport);
+
+        ps->gpu_uniforms.frameCount = (float)ps->diag_frames_displayed;
+
+        SDL_PushGPUFragmentUniformData(cmd, 0,
+            &ps->gpu_uniforms, sizeof(ps->gpu_uniforms));
+
+        SDL_GPUTextureSamplerBinding bindings[4] = {
+            { .texture = ps->gpu_tex_y,     .sampler = ps->gpu_sampler },
+            { .texture = ps->gpu_tex_u,     .sampler = ps->gpu_sampler },
+            { .texture = ps->gpu_tex_v,     .sampler = ps->gpu_sampler },
+            { .texture = ps->gpu_tex_noise, .sampler = ps->gpu_sampler_nearest },
+        };
+        SDL_BindGPUFragmentSamplers(pass, 0, bindings, 4);
+
+        SDL_DrawGPUPrimitives(pass, 4, 1, 0, 0);
+    }
+    SDL_EndGPURenderPass(pass);
+
+    SDL_GPUFence *fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmd);
+    if (!fence) return -1;
+    SDL_WaitForGPUFences(ps->gpu_device, true, &fence, 1);
+    SDL_ReleaseGPUFence(ps->gpu_device, fence);
+    ps->gpu_upload_idx = (ps->gpu_upload_idx + 1) % GPU_UPLOAD_RING;
+    double t2 = get_time_sec();
+
+    /* ── Readback ── */
+    cmd = SDL_AcquireGPUCommandBuffer(ps->gpu_device);
+    if (!cmd) return -1;
+
+    SDL_GPUCopyPass *copy = SDL_BeginGPUCopyPass(cmd);
+    {
+        SDL_GPUTextureRegion src_region;
+        SDL_GPUTextureTransferInfo dst_info;
+        SDL_zero(src_region);
+        SDL_zero(dst_info);
+        src_region.texture = target;
+        src_region.w = w;
+        src_region.h = h;
+        src_region.d = 1;
+        dst_info.transfer_buffer = readback;
+        dst_info.pixels_per_row  = w;
+        dst_info.rows_per_layer  = h;
+        SDL_DownloadFromGPUTexture(copy, &src_region, &dst_info);
+    }
+    SDL_EndGPUCopyPass(copy);
+
+    fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmd);
+    if (!fence) return -1;
+    SDL_WaitForGPUFences(ps->gpu_device, true, &fence, 1);
+    SDL_ReleaseGPUFence(ps->gpu_device, fence);
+
+    const uint8_t *px = SDL_MapGPUTransferBuffer(ps->gpu_device, readback, false);
+    if (!px) return -1;
+    double t3 = get_time_sec();
+
+    /* FNV-1a over the whole RGBA8 image */
+    uint64_t hv = 0xcbf29ce484222325ULL;
+    size_t n = (size_t)w * h * 4;
+    for (size_t i = 0; i < n; i++) {
+        hv ^= px[i];
+        hv *= 0x100000001b3ULL;
+    }
+    SDL_UnmapGPUTransferBuffer(ps->gpu_device, readback);
+
+    *hash = hv;
+    timings[0] = (t1 - t0) * 1000.0;
+    timings[1] = (t2 - t1) * 1000.0;
+    timings[2] = (t3 - t2) * 1000.0;
+    return 0;
+}
+
+
 /* ═══════════════════════════════════════════════════════════════════
  * Seeking
  * ═══════════════════════════════════════════════════════════════════ */
@@ -3217,6 +4776,7 @@ void player_seek(PlayerState *ps, double incr) {
     ps->seek_target  = (int64_t)(pos * AV_TIME_BASE);
     ps->seek_flags   = (incr < 0) ? AVSEEK_FLAG_BACKWARD : 0;
     ps->seek_request = 1;
+    demux_wake(ps);
 
     /* Reset video timing after seek */
     ps->frame_timer      = get_time_sec();
@@ -3369,15 +4929,26 @@ void player_build_debug_info(PlayerState *ps) {
     off += snprintf(buf + off, sz - off, "Renderer: SDL_GPU\n");
     off += snprintf(buf + off, sz - off, "A/V Bias:    %.1f ms\n",
         ps->av_bias * 1000.0);
-    off += snprintf(buf + off, sz - off, "Video Queue: %d pkts (%d KB)\n",
-        ps->video_pq.nb_packets, ps->video_pq.size / 1024);
-    off += snprintf(buf + off, sz - off, "Audio Queue: %d pkts (%d KB)\n",
-        ps->audio_pq.nb_packets, ps->audio_pq.size / 1024);
+    off += snprintf(buf + off, sz - off, "Video Queue: %d pkts (%d KB, %.1fs)\n",
+        pq_nb_packets(&ps->video_pq), pq_size(&ps->video_pq) / 1024,
+        (double)pq_duration(&ps->video_pq) / AV_TIME_BASE);
+    off += snprintf(buf + off, sz - off, "Audio Queue: %d pkts (%d KB, %.1fs)\n",
+        pq_nb_packets(&ps->audio_pq), pq_size(&ps->audio_pq) / 1024,
+        (double)pq_duration(&ps->audio_pq) / AV_TIME_BASE);
+    off += snprintf(buf + off, sz - off, "Frame Queue: %d/%d decoded\n",
+        ps->video_fq.count, ps->video_fq.capacity);
+    if (SDL_GetAtomicInt(&ps->seek_index.ready))
+        off += snprintf(buf + off, sz - off, "Seek Index:  %d keyframes (%.2fs, %s)\n",
+            ps->seek_index.count, ps->seek_index.build_sec,
+            ps->seek_index.by_byte ? "byte" : "timestamp");
+    else if (ps->seek_index.thread)
+        off += snprintf(buf + off, sz - off, "Seek Index:  building...\n");
     off += snprintf(buf + off, sz - off, "Volume:      %.0f%%\n", ps->volume * 100.0);
 
     if (ps->video_codec_ctx) {
-        off += snprintf(buf + off, sz - off, "Decoder Threads: %d\n",
-            ps->video_codec_ctx->thread_count);
+        off += snprintf(buf + off, sz - off, "Decoder Threads: %d%s\n",
+            ps->video_codec_ctx->thread_count,
+            ps->vdec_calibrated ? " (calibrated)" : "");
 
         int is_yuv420p = (ps->video_codec_ctx->pix_fmt == AV_PIX_FMT_YUV420P);
         int is_10bit = (ps->video_codec_ctx->pix_fmt == AV_PIX_FMT_YUV420P10LE);
@@ -3450,41 +5021,62 @@ void player_build_debug_info(PlayerState *ps) {
         off += snprintf(buf + off, sz - off, "Source:  %s %s %dHz %dch (%s)\n",
             acodec, afmt ? afmt : "?", src_rate, src_ch, layout_desc);
 
-        /* Determine output format name from SDL spec */
-        const char *out_fmt = (ps->audio_spec.format == SDL_AUDIO_F32) ? "F32" :
-                              (ps->audio_spec.format == SDL_AUDIO_S16) ? "S16" : "???";
-        int out_rate = ps->audio_spec.freq;
-        int out_ch   = ps->audio_spec.channels;
-        off += snprintf(buf + off, sz - off, "Output:  %s %dHz %dch (stereo)\n",
-            out_fmt, out_rate, out_ch);
-
-        int resampling = (src_rate != out_rate);
-        int downmixing = (src_ch != out_ch);
-
-        if (resampling && downmixing)
-            off += snprintf(buf + off, sz - off,
-                "Pipeline: resample %d->%dHz + downmix %dch->%dch + %s\n",
-                src_rate, out_rate, src_ch, out_ch, out_fmt);
-        else if (resampling)
+        if (ps->bitstream_active) {
+            off += snprintf(buf + off, sz - off, "Output:  IEC 61937 %dHz %dch%s\n",
+                ps->spdif.rate, ps->spdif.channels,
+                ps->spdif.channels == 8 ? " (HBR)" : "");
             off += snprintf(buf + off, sz - off,
-                "Pipeline: resample %d->%dHz + %s\n", src_rate, out_rate, out_fmt);
-        else if (downmixing)
-            off += snprintf(buf + off, sz - off,
-                "Pipeline: downmix %dch->%dch + %s\n", src_ch, out_ch, out_fmt);
-        else if (afmt && strcmp(afmt, "flt") == 0 &&
-                 ps->audio_spec.format == SDL_AUDIO_F32)
-            off += snprintf(buf + off, sz - off, "Pipeline: direct (no conversion)\n");
-        else
-            off += snprintf(buf + off, sz - off,
-                "Pipeline: format convert %s->%s\n", afmt ? afmt : "?", out_fmt);
+                "Pipeline: passthrough (no decode, no resample)\n");
+        } else {
+            /* Determine output format name from SDL spec */
+            const char *out_fmt = (ps->audio_spec.format == SDL_AUDIO_F32) ? "F32" :
+                                  (ps->audio_spec.format == SDL_AUDIO_S16) ? "S16" : "???";
+            int out_rate = ps->audio_spec.freq;
+            int out_ch   = ps->audio_spec.channels;
+            char out_desc[64] = {0};
+            av_channel_layout_describe(&ps->audio_out_layout, out_desc, sizeof(out_desc));
+            off += snprintf(buf + off, sz - off, "Output:  %s %dHz %dch (%s)\n",
+                out_fmt, out_rate, out_ch, out_desc);
+
+            int resampling = (src_rate != out_rate);
+            int downmixing = (src_ch != out_ch);
+
+            if (ps->audio_path == AUDIO_PATH_DIRECT)
+                off += snprintf(buf + off, sz - off, "Pipeline: direct (no conversion)\n");
+            else if (ps->audio_path == AUDIO_PATH_INTERLEAVE)
+                off += snprintf(buf + off, sz - off, "Pipeline: interleave (no swr)\n");
+            else if (ps->audio_path == AUDIO_PATH_DOWNMIX)
+                off += snprintf(buf + off, sz - off,
+                    "Pipeline: downmix %dch->%dch (%s, no swr)\n",
+                    src_ch, out_ch, audio_mix_kernel_name(-1));
+            else if (resampling && downmixing)
+                off += snprintf(buf + off, sz - off,
+                    "Pipeline: resample %d->%dHz + downmix %dch->%dch + %s\n",
+                    src_rate, out_rate, src_ch, out_ch, out_fmt);
+            else if (resampling)
+                off += snprintf(buf + off, sz - off,
+                    "Pipeline: resample %d->%dHz + %s\n", src_rate, out_rate, out_fmt);
+            else if (downmixing)
+                off += snprintf(buf + off, sz - off,
+                    "Pipeline: swr remix %dch->%dch + %s\n", src_ch, out_ch, out_fmt);
+            else
+                off += snprintf(buf + off, sz - off,
+                    "Pipeline: format convert %s->%s\n", afmt ? afmt : "?", out_fmt);
+        }
+
+        AudioRing *r = &ps->audio_ring;
+        if (r->buf && r->freq > 0) {
+            unsigned fill = (unsigned)SDL_GetAtomicInt(&r->wpos)
+                          - (unsigned)SDL_GetAtomicInt(&r->rpos);
+            off += snprintf(buf + off, sz - off, "Ring:    %u / %u ms\n",
+                fill * 1000u / (unsigned)r->freq, r->capacity * 1000u / (unsigned)r->freq);
+        }
     } else {
         off += snprintf(buf + off, sz - off, "No audio\n");
     }
 
     /* Lossless availability — scan catalog for TrueHD/DTS-HD MA tracks
-     * that are present in the container but not currently active. These
-     * are only useful over bitstream passthrough; PCM decode of them is
-     * the same lossless output as decoded FLAC from any other source. */
+     * present in the container (selectable with the audio track key). */
     if (ps->fmt_ctx && ps->aud_count > 0) {
         int has_truehd  = 0;
         int has_dtshdma = 0;
@@ -3500,7 +5092,7 @@ void player_build_debug_info(PlayerState *ps) {
                               : has_truehd                ? "TrueHD"
                                                           : "DTS-HD";
             off += snprintf(buf + off, sz - off,
-                "Lossless: %s available (bitstream only)\n", names);
+                "Lossless: %s available\n", names);
         }
     }
 
@@ -3509,8 +5101,23 @@ void player_build_debug_info(PlayerState *ps) {
     off += snprintf(buf + off, sz - off, "Decoded:     %d\n", ps->diag_frames_decoded);
     off += snprintf(buf + off, sz - off, "Displayed:   %d\n", ps->diag_frames_displayed);
     off += snprintf(buf + off, sz - off, "Dropped:     %d\n", ps->diag_frames_dropped);
+    off += snprintf(buf + off, sz - off, "Repeated:    %d\n", ps->diag_frames_repeated);
+    if (ps->sync_mode == SYNC_DISPLAY)
+        off += snprintf(buf + off, sz - off, "Sync:        display %.3fHz, audio x%.4f\n",
+            ps->sched.vsync > 0.0 ? 1.0 / ps->sched.vsync : 0.0,
+            ps->ds_audio_speed);
+    else
+        off += snprintf(buf + off, sz - off, "Sync:        audio master\n");
+    off += sched_debug_info(ps, buf + off, sz - off);
     off += snprintf(buf + off, sz - off, "Multi-ticks: %d\n", ps->diag_multi_decodes);
     off += snprintf(buf + off, sz - off, "Stall snaps: %d\n", ps->diag_timer_snaps);
+    off += snprintf(buf + off, sz - off, "Late:        %s (%d changes, %d pkts skipped)\n",
+        late_level_name(SDL_GetAtomicInt(&ps->late_level)),
+        ps->diag_late_changes, ps->diag_late_skipped);
+    off += snprintf(buf + off, sz - off, "Overlay:     last upload %d KB in %d region%s\n",
+        ps->overlay_copy_bytes / 1024, ps->overlay_copy_regions,
+        ps->overlay_copy_regions == 1 ? "" : "s");
+    off += snprintf(buf + off, sz - off, "Underruns:   %d\n", ps->diag_audio_underruns);
     off += snprintf(buf + off, sz - off, "Peak drift:  %.1f ms\n",
         ps->diag_max_av_drift * 1000.0);
     off += snprintf(buf + off, sz - off, "A/V bias:    %.1f ms\n",
@@ -0,0 +1,266 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * preopen.c — Playlist open-ahead (instant N/B navigation)
+ *
+ * Moving to the next file in a folder used to start from nothing on the
+ * main thread: avformat_open_input, avformat_find_stream_info (which
+ * reads many megabytes on a large MKV), decoder open and a cold
+ * decoder pipeline. While a file plays, its playlist neighbours are now
+ * opened on background threads instead:
+ *
+ *   - container opened and probed
+ *   - video decoder opened (same thread policy as playback) and fed
+ *     until its first frame comes out
+ *   - about PREOPEN_SEC of packets read ahead, all streams, demux order
+ *
+ * player_open() takes a matching slot in place of its own open and
+ * probe, adopts the primed decoder, and replays the packets and first
+ * frame into the fresh queues before the demux thread carries on
+ * reading from where the worker stopped. What is left on the main
+ * thread is texture creation and the audio device.
+ *
+ * Workers run at low priority and only start PREOPEN_DELAY_SEC after an
+ * open, so they stay out of the way of the current file's own pipeline
+ * fill. A slot that is no longer a neighbour is aborted (the interrupt
+ * callback makes blocking I/O return) and freed.
+ */
+
+#include "dsvp.h"
+
+/* Worker-side packet cap, well inside one PACKET_QUEUE_SLOTS ring */
+#define PREOPEN_MAX_PKTS    (PACKET_QUEUE_SLOTS / 2)
+
+static int preopen_interrupt(void *opaque) {
+    PreOpen *po = (PreOpen *)opaque;
+    return SDL_GetAtomicInt(&po->abort);
+}
+
+/* Keep pkt (moved) in the read-ahead list. */
+static int preopen_keep(PreOpen *po, AVPacket *pkt, int fed) {
+    if (po->npkts == po->cap) {
+        int cap = po->cap ? po->cap * 2 : 256;
+        PreOpenPkt *grown = realloc(po->pkts, (size_t)cap * sizeof(*grown));
+        if (!grown) return -1;
+        po->pkts = grown;
+        po->cap  = cap;
+    }
+    AVPacket *p = av_packet_alloc();
+    if (!p) return -1;
+    av_packet_move_ref(p, pkt);
+    po->bytes += p->size;
+    po->pkts[po->npkts].pkt = p;
+    po->pkts[po->npkts].fed = fed;
+    po->npkts++;
+    return 0;
+}
+
+static int preopen_thread_func(void *arg) {
+    PreOpen *po = (PreOpen *)arg;
+    double t0 = get_time_sec();
+    SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+
+    AVFormatContext *fc = avformat_alloc_context();
+    if (!fc) return 0;
+    fc->interrupt_callback.callback = preopen_interrupt;
+    fc->interrupt_callback.opaque   = po;
+    if (avformat_open_input(&fc, po->path, NULL, NULL) < 0)
+        return 0;   /* fc freed by avformat_open_input */
+    po->fmt_ctx = fc;
+
+    if (avformat_find_stream_info(fc, NULL) < 0 || SDL_GetAtomicInt(&po->abort))
+        return 0;
+    po->video_idx = av_find_best_stream(fc, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (po->video_idx < 0)
+        return 0;
+
+    /* Cache only: a new class is queued for calibration by player_open()
+     * when it adopts this decoder */
+    po->video_ctx = video_decoder_open(fc, po->video_idx, po->path, 0, 0, 0,
+                                       &po->calibrated);
+    if (!po->video_ctx)
+        return 0;
+
+    AVStream *vs = fc->streams[po->video_idx];
+    double tb    = av_q2d(vs->time_base);
+    double t_min = 0.0, t_max = 0.0;
+    int    have_t = 0;
+    AVPacket *pkt   = av_packet_alloc();
+    AVFrame  *frame = av_frame_alloc();
+
+    while (pkt && frame && !SDL_GetAtomicInt(&po->abort)) {
+        if (po->first && (t_max - t_min >= PREOPEN_SEC || po->bytes >= PREOPEN_MAX_BYTES))
+            break;
+        if (po->npkts >= PREOPEN_MAX_PKTS)
+            break;
+        if (av_read_frame(fc, pkt) < 0)
+            break;   /* EOF or error: the demux thread finds out again */
+
+        int fed = 0;
+        if (pkt->stream_index == po->video_idx) {
+            if (pkt->pts != AV_NOPTS_VALUE) {
+                double t = pkt->pts * tb;
+                if (!have_t || t < t_min) t_min = t;
+                if (!have_t || t > t_max) t_max = t;
+                have_t = 1;
+            }
+            /* Prime the decoder until its first frame is out */
+            if (!po->first) {
+                avcodec_send_packet(po->video_ctx, pkt);
+                fed = 1;
+                if (avcodec_receive_frame(po->video_ctx, frame) == 0) {
+                    int64_t fpts = frame->best_effort_timestamp;
+                    if (fpts == AV_NOPTS_VALUE) fpts = frame->pts;
+                    po->first_pts = (fpts != AV_NOPTS_VALUE) ? fpts * tb : 0.0;
+                    po->first = frame;
+                    frame = av_frame_alloc();
+                }
+            }
+        }
+        if (preopen_keep(po, pkt, fed) < 0) {
+            av_packet_unref(pkt);
+            break;
+        }
+    }
+    av_packet_free(&pkt);
+    av_frame_free(&frame);
+
+    po->ok       = !SDL_GetAtomicInt(&po->abort);
+    po->open_sec = get_time_sec() - t0;
+    return 0;
+}
+
+/* Release everything a slot holds, aborting its worker first. */
+void preopen_free(PreOpen *po) {
+    if (po->thread) {
+        SDL_SetAtomicInt(&po->abort, 1);
+        SDL_WaitThread(po->thread, NULL);
+    }
+    for (int i = 0; i < po->npkts; i++)
+        av_packet_free(&po->pkts[i].pkt);
+    free(po->pkts);
+    av_frame_free(&po->first);
+    avcodec_free_context(&po->video_ctx);
+    if (po->fmt_ctx)
+        avformat_close_input(&po->fmt_ctx);
+    free(po->path);
+    memset(po, 0, sizeof(*po));
+}
+
+void preopen_clear(PlayerState *ps) {
+    for (int i = 0; i < 2; i++)
+        preopen_free(&ps->preopen[i]);
+    preopen_free(&ps->preopen_adopted);
+}
+
+static void preopen_start(PreOpen *po, const char *path) {
+    memset(po, 0, sizeof(*po));
+    po->path = strdup(path);
+    if (!po->path) return;
+    SDL_SetAtomicInt(&po->abort, 0);
+    po->thread = SDL_CreateThread(preopen_thread_func, "preopen", po);
+    if (!po->thread) {
+        free(po->path);
+        po->path = NULL;
+        return;
+    }
+    log_msg("Open-ahead: %s", path);
+}
+
+/* Main loop, once per iteration: keep the slots on the current file's
+ * playlist neighbours. Cheap when nothing changes. */
+void preopen_poll(PlayerState *ps, double now) {
+    if (!ps->playing || !ps->window || ps->playlist_index < 0 || ps->playlist_count < 2)
+        return;
+    if (ps->preopen_after <= 0.0 || now < ps->preopen_after)
+        return;
+
+    const char *want[2] = { NULL, NULL };
+    if (ps->playlist_index > 0)
+        want[0] = ps->playlist_files[ps->playlist_index - 1];
+    if (ps->playlist_index + 1 < ps->playlist_count)
+        want[1] = ps->playlist_files[ps->playlist_index + 1];
+
+    /* Drop slots that are no longer neighbours */
+    for (int i = 0; i < 2; i++) {
+        PreOpen *po = &ps->preopen[i];
+        if (po->path && !(want[0] && strcmp(po->path, want[0]) == 0)
+                     && !(want[1] && strcmp(po->path, want[1]) == 0))
+            preopen_free(po);
+    }
+
+    /* Start the missing ones in free slots */
+    for (int w = 0; w < 2; w++) {
+        if (!want[w]) continue;
+        int have = 0, slot = -1;
+        for (int i = 0; i < 2; i++) {
+            if (ps->preopen[i].path && strcmp(ps->preopen[i].path, want[w]) == 0)
+                have = 1;
+            else if (!ps->preopen[i].path && slot < 0)
+                slot = i;
+        }
+        if (!have && slot >= 0)
+            preopen_start(&ps->preopen[slot], want[w]);
+    }
+}
+
+/* player_open(): move the slot for path into *out, waiting for its
+ * worker if it is still running. Returns 1 if a usable open was taken. */
+int preopen_take(PlayerState *ps, const char *path, PreOpen *out) {
+    for (int i = 0; i < 2; i++) {
+        PreOpen *po = &ps->preopen[i];
+        if (!po->path || strcmp(po->path, path) != 0)
+            continue;
+
+        double t0 = get_time_sec();
+        SDL_WaitThread(po->thread, NULL);
+        po->thread = NULL;
+        if (!po->ok) {
+            preopen_free(po);
+            return 0;
+        }
+
+        *out = *po;
+        memset(po, 0, sizeof(*po));
+        /* The callback pointed at the slot, which is about to be reused */
+        out->fmt_ctx->interrupt_callback.callback = NULL;
+        out->fmt_ctx->interrupt_callback.opaque   = NULL;
+        log_msg("Open-ahead: taken %s (%d packets, %.1f MB, first frame %s, "
+                "worker %.0fms, waited %.0fms)",
+                path, out->npkts, out->bytes / (1024.0 * 1024.0),
+                out->first ? "ready" : "pending",
+                out->open_sec * 1000.0, (get_time_sec() - t0) * 1000.0);
+        return 1;
+    }
+    return 0;
+}
+
+/* player_open(): the primed decoder, if it decoded the stream playback
+ * chose. Otherwise it is dropped and every packet will be replayed. */
+AVCodecContext *preopen_take_decoder(PreOpen *po, int vidx, int *calibrated) {
+    if (po->video_ctx && po->video_idx == vidx) {
+        AVCodecContext *ctx = po->video_ctx;
+        po->video_ctx = NULL;
+        po->primed    = 1;
+        *calibrated   = po->calibrated;
+        return ctx;
+    }
+    avcodec_free_context(&po->video_ctx);
+    av_frame_free(&po->first);
+    return NULL;
+}
+
+/* player_open(), queues ready, threads not started: hand the read-ahead
+ * packets to their queues in demux order and the first frame to the
+ * frame ring. Packets the adopted decoder already consumed are skipped. */
+void preopen_replay(PlayerState *ps, PreOpen *po) {
+    for (int i = 0; i < po->npkts; i++) {
+        AVPacket *p = po->pkts[i].pkt;
+        if (!(po->primed && po->pkts[i].fed))
+            demux_route_packet(ps, p);
+        av_packet_free(&po->pkts[i].pkt);
+    }
+    po->npkts = 0;
+
+    if (po->first)
+        fq_push(&ps->video_fq, po->first, po->first_pts, ps->video_fq.serial);
+}
@@ -0,0 +1,279 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * sched.c — Presentation scheduler (vsync measurement, cadence planning)
+ *
+ * The render loop runs once per vsync (VSYNC present mode,
+ * WaitAndAcquire). This module turns that heartbeat into a measured
+ * vsync period and uses it two ways:
+ *
+ *   Planning (--sync display). Each frame stays up for a whole number
+ *   of vsyncs. The fractional remainder carries to the next frame, so
+ *   24p on 60 Hz comes out as an even 3:2 cadence, 24p on 120 Hz as 5:5
+ *   and 60p on 60 Hz as 1:1. Video runs at the display's pace; audio
+ *   follows through a PI controller on the A/V difference that sets
+ *   ds_audio_speed (1 ± DS_SPEED_MAX), applied by audio_convert_frame()
+ *   through swr compensation. Only drift beyond DS_RESYNC_SEC (a decode
+ *   stall, a device hiccup) is fixed by dropping or repeating a frame.
+ *   Passthrough audio cannot be resampled; with a bitstream active only
+ *   the drop/repeat path keeps sync.
+ *
+ *   Scoring (both modes). Every displayed frame is checked against the
+ *   ideal cadence: `owed` accumulates content time minus screen time in
+ *   vsyncs. A clean 3:2 keeps it within ±0.5; a 2/3/2/2 stutter
+ *   pushes it past ±0.5 and counts as an off-cadence frame, after which
+ *   it restarts from zero so one slip is counted once. Missed vsyncs (a GPU
+ *   stall) show up too, since screen time is measured from tick deltas,
+ *   not loop iterations.
+ */
+
+#include "dsvp.h"
+
+/* Seed the vsync estimate from the display mode (exact rational rate
+ * when the driver reports one). */
+static double sched_refresh(PlayerState *ps) {
+    const SDL_DisplayMode *dm = ps->window
+        ? SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(ps->window)) : NULL;
+    if (dm && dm->refresh_rate_numerator > 0 && dm->refresh_rate_denominator > 0)
+        return (double)dm->refresh_rate_denominator / dm->refresh_rate_numerator;
+    if (dm && dm->refresh_rate > 1.0f)
+        return 1.0 / dm->refresh_rate;
+    return 1.0 / 60.0;
+}
+
+/* Forget cadence and controller state (seek, sync mode switch). With
+ * stats set (file open) the cadence counters start over as well. */
+void sched_reset(PlayerState *ps, int stats) {
+    PresentSched *s = &ps->sched;
+
+    s->phase       = 0.0;
+    s->ticks_left  = 0;
+    s->frame_ticks = 0;
+    s->scoring     = 0;
+    s->owed        = 0.0;
+    ps->ds_drift_i     = 0.0;
+    ps->ds_audio_speed = 1.0;
+
+    if (stats) {
+        s->vsync_nominal = sched_refresh(ps);
+        if (s->vsync <= 0.0)
+            s->vsync = s->vsync_nominal;
+        s->frames      = 0;
+        s->off_cadence = 0;
+        s->err_max     = 0.0;
+        s->err_sum     = 0.0;
+        memset(s->held, 0, sizeof(s->held));
+    }
+}
+
+/* Once per render tick, before frame selection. Refines the vsync
+ * estimate and charges the elapsed vsyncs to the frame on screen. */
+void sched_vsync(PlayerState *ps, double now) {
+    PresentSched *s = &ps->sched;
+
+    if (s->vsync <= 0.0)
+        s->vsync = s->vsync_nominal = sched_refresh(ps);
+
+    if (s->last_tick > 0.0) {
+        double dt = now - s->last_tick;
+
+        /* Tick deltas near the estimate are vsyncs; late ticks (a hitch,
+         * a missed vsync) are not and are left out of the estimate */
+        if (dt > s->vsync * 0.5 && dt < s->vsync * 1.5)
+            s->vsync = s->vsync * 0.99 + dt * 0.01;
+
+        if (dt > 0.25) {
+            s->scoring = 0;      /* pause or stall: not a cadence */
+        } else {
+            int n = (int)(dt / s->vsync + 0.5);
+            s->frame_ticks += n < 1 ? 1 : n;
+        }
+    }
+    s->last_tick = now;
+}
+
+/* A new frame was just presented: score the one it replaces. */
+void sched_frame_shown(PlayerState *ps) {
+    PresentSched *s = &ps->sched;
+    double content = ps->video_clock - s->shown_pts;
+
+    if (s->scoring && s->frame_ticks > 0 && content > 0.0 && content < 1.0) {
+        int bin = s->frame_ticks < SCHED_HELD_BINS ? s->frame_ticks : SCHED_HELD_BINS;
+        s->held[bin - 1]++;
+
+        s->owed += content / s->vsync - s->frame_ticks;
+        double err = fabs(s->owed);
+        s->frames++;
+        s->err_sum += err;
+        if (err > s->err_max)
+            s->err_max = err;
+
+        /* A little slack above 0.5 for vsync estimate noise. Restart
+         * the window from zero: a clean cadence either side of the
+         * break stays inside ±0.5 again. */
+        if (err > 0.6) {
+            s->off_cadence++;
+            s->owed = 0.0;
+        }
+    } else {
+        s->owed = 0.0;
+    }
+
+    s->shown_pts = ps->video_clock;
+    s->frame_ticks = 0;
+    s->scoring     = 1;
+}
+
+/* Display sync: one vsync tick. Returns 1 if a new frame was popped for
+ * display, 0 if the current one stays up, -1 if the frame queue is
+ * empty. Call after sched_vsync(). */
+int sched_tick(PlayerState *ps) {
+    PresentSched *s = &ps->sched;
+
+    if (--s->ticks_left > 0)
+        return 0;   /* current frame has vsyncs left */
+
+    if (!video_next_frame(ps)) {
+        s->ticks_left = 0;   /* try again next vsync */
+        if (ps->video_ready && !ps->seek_recovering && !ps->eof)
+            ps->diag_frames_repeated++;
+        return -1;
+    }
+    ps->diag_frames_decoded++;
+
+    double pts_delay = ps->video_clock - ps->frame_last_pts;
+    if (pts_delay <= 0.0 || pts_delay >= 1.0)
+        pts_delay = ps->frame_last_delay;
+    ps->frame_last_pts   = ps->video_clock;
+    ps->frame_last_delay = pts_delay;
+
+    /* Content faster than the display (50p on 30 Hz): drop the frames
+     * the cadence has no vsync for. The frame just popped is the one
+     * skipped, so it counts as dropped like the A/V catch-up below */
+    s->phase += pts_delay / s->vsync;
+    while (s->phase < 0.5 && video_next_frame(ps)) {
+        ps->diag_frames_decoded++;
+        ps->diag_frames_dropped++;
+        s->phase += pts_delay / s->vsync;
+        ps->frame_last_pts = ps->video_clock;
+    }
+
+    int ticks = (int)(s->phase + 0.5);
+    if (ticks < 1) ticks = 1;
+    s->phase -= ticks;
+
+    /* ── Audio follows video ── */
+    if (ps->audio_stream_idx >= 0 && !ps->seek_recovering) {
+        double av_diff = ps->video_clock - ps->audio_clock_sync;
+
+        video_late_update(ps, -av_diff, s->last_tick);
+
+        if (av_diff < -DS_RESYNC_SEC) {
+            /* Video late: drop up to 4 frames toward the audio */
+            for (int i = 0; i < 4 && av_diff < -DS_RESYNC_SEC; i++) {
+                if (!video_next_frame(ps)) break;
+                ps->diag_frames_decoded++;
+                ps->diag_frames_dropped++;
+                ps->frame_last_pts = ps->video_clock;
+                av_diff = ps->video_clock - ps->audio_clock_sync;
+            }
+            log_msg("DIAG: display sync dropped to %.3fs (A/V drift: %.1fms)",
+                    ps->video_clock, av_diff * 1000.0);
+        } else if (av_diff > DS_RESYNC_SEC) {
+            /* Video early: hold this frame one vsync longer */
+            ticks++;
+            ps->diag_frames_repeated++;
+            log_msg("DIAG: display sync repeat at %.3fs (A/V drift: %.1fms)",
+                    ps->video_clock, av_diff * 1000.0);
+        } else {
+            /* Positive drift (video ahead) speeds audio up. The integral
+             * settles on the steady clock ratio between display and
+             * audio device; the proportional term removes the offset. */
+            ps->ds_drift_i += av_diff * 0.001;
+            if (ps->ds_drift_i >  DS_SPEED_MAX) ps->ds_drift_i =  DS_SPEED_MAX;
+            if (ps->ds_drift_i < -DS_SPEED_MAX) ps->ds_drift_i = -DS_SPEED_MAX;
+            double adj = ps->ds_drift_i + av_diff * 0.05;
+            if (adj >  DS_SPEED_MAX) adj =  DS_SPEED_MAX;
+            if (adj < -DS_SPEED_MAX) adj = -DS_SPEED_MAX;
+            ps->ds_audio_speed = 1.0 + adj;
+        }
+
+        if (fabs(av_diff) > fabs(ps->diag_max_av_drift))
+            ps->diag_max_av_drift = av_diff;
+    }
+
+    s->ticks_left = ticks;
+    return 1;
+}
+
+/* Ideal cadence for the current content rate: whole ratios are n:n,
+ * half ratios alternate (3:2). Anything else is a mixed cadence. The
+ * residual against the nearest pattern sets how often it slips a vsync
+ * (23.976 fps on a 60.000 Hz panel: every ~16.7 s). */
+static void sched_cadence_name(double ratio, double frame_dur,
+                               char *buf, int sz, double *slip_sec)
+{
+    double half = floor(ratio * 2.0 + 0.5) / 2.0;
+    *slip_sec = 0.0;
+
+    if (ratio < 0.95 || fabs(ratio - half) > 0.02 * ratio) {
+        snprintf(buf, sz, "mixed (%.3f vsync/frame)", ratio);
+        return;
+    }
+    int hi = (int)ceil(half), lo = (int)floor(half);
+    snprintf(buf, sz, "%d:%d", hi, lo);
+    double resid = fabs(ratio - half);
+    if (resid > 1e-4)
+        *slip_sec = frame_dur / resid;
+}
+
+/* Append to buf at *off, never past sz: a truncated snprintf returns
+ * the length it wanted, so *off is clamped to the terminating NUL. */
+static void sched_appendf(char *buf, int sz, int *off, const char *fmt, ...) {
+    if (*off >= sz - 1) return;
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf + *off, (size_t)(sz - *off), fmt, args);
+    va_end(args);
+    if (n > 0)
+        *off = (*off + n < sz - 1) ? *off + n : sz - 1;
+}
+
+/* Debug panel lines (player_build_debug_info). Returns bytes written,
+ * at most sz - 1. */
+int sched_debug_info(PlayerState *ps, char *buf, int sz) {
+    PresentSched *s = &ps->sched;
+    int off = 0;
+
+    if (s->vsync <= 0.0 || sz <= 0)
+        return 0;
+    buf[0] = '\0';
+
+    sched_appendf(buf, sz, &off, "Display:     %.3f Hz measured (%.3f mode)\n",
+        1.0 / s->vsync, s->vsync_nominal > 0.0 ? 1.0 / s->vsync_nominal : 0.0);
+
+    if (ps->frame_last_delay > 0.0) {
+        char name[48];
+        double slip;
+        sched_cadence_name(ps->frame_last_delay / s->vsync, ps->frame_last_delay,
+                           name, sizeof(name), &slip);
+        if (slip > 0.0)
+            sched_appendf(buf, sz, &off, "Cadence:     %s for %.3f fps, slip every %.1fs\n",
+                name, 1.0 / ps->frame_last_delay, slip);
+        else
+            sched_appendf(buf, sz, &off, "Cadence:     %s for %.3f fps\n",
+                name, 1.0 / ps->frame_last_delay);
+    }
+
+    if (s->frames > 0)
+        sched_appendf(buf, sz, &off,
+            "Cadence err: %d / %d off (%.2f%%), max %.2f, avg %.2f vsync\n",
+            s->off_cadence, s->frames, 100.0 * s->off_cadence / s->frames,
+            s->err_max, s->err_sum / s->frames);
+
+    sched_appendf(buf, sz, &off, "Held:       ");
+    for (int i = 0; i < SCHED_HELD_BINS && off < sz - 1; i++)
+        sched_appendf(buf, sz, &off, " %d%s:%d", i + 1,
+            i == SCHED_HELD_BINS - 1 ? "+" : "", s->held[i]);
+    sched_appendf(buf, sz, &off, "\n");
+    return off;
+}
@@ -0,0 +1,281 @@
+/*
+ * DSVP — Dead Simple Video Player
+ * seekindex.c — Background keyframe index for exact seeking
+ *
+ * One low-priority thread per file builds a sorted table of the video
+ * stream's keyframes on its own AVFormatContext, so it never touches
+ * the demuxer the playback threads are using:
+ *
+ *   - Containers with an index (MKV Cues, MP4 stss, AVI idx1): the
+ *     keyframe entries are copied and the table is ready in
+ *     milliseconds. Matroska reads its Cues lazily, on the first seek,
+ *     so a seek past the end is made first; before that the table only
+ *     holds the clusters the probe touched. The table is trusted only
+ *     if it reaches to within SEEK_INDEX_TAIL_SEC of the duration.
+ *   - Containers without one (MPEG-TS, raw ES, PS) are scanned once
+ *     with every other stream discarded, recording each keyframe
+ *     packet's PTS and byte offset.
+ *
+ * The table is published once, with an atomic flag, and is read-only
+ * afterwards — lookups need no lock. Until it is ready, seeks fall back
+ * to av_seek_frame.
+ *
+ * Memory: 16 bytes per keyframe (≈115 KB for two hours at 1s GOP).
+ */
+
+#include "dsvp.h"
+
+/* A container index whose last keyframe is further than this from the
+ * end of the stream is partial (probe-time entries only): scan instead */
+#define SEEK_INDEX_TAIL_SEC  30.0
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Table Building
+ * ═══════════════════════════════════════════════════════════════════ */
+
+typedef struct SeekIndexEntry {
+    int64_t ts;
+    int64_t pos;
+} SeekIndexEntry;
+
+static int seek_index_cmp(const void *a, const void *b) {
+    int64_t x = ((const SeekIndexEntry *)a)->ts;
+    int64_t y = ((const SeekIndexEntry *)b)->ts;
+    return (x > y) - (x < y);
+}
+
+/* Append one keyframe, growing the array geometrically. */
+static int seek_index_push(SeekIndexEntry **e, int *count, int *cap,
+                           int64_t ts, int64_t pos)
+{
+    if (*count == *cap) {
+        int ncap = *cap ? *cap * 2 : 1024;
+        SeekIndexEntry *n = realloc(*e, (size_t)ncap * sizeof(**e));
+        if (!n) return -1;
+        *e   = n;
+        *cap = ncap;
+    }
+    (*e)[*count].ts  = ts;
+    (*e)[*count].pos = pos;
+    (*count)++;
+    return 0;
+}
+
+static int seek_index_interrupt(void *opaque) {
+    SeekIndex *ix = (SeekIndex *)opaque;
+    return SDL_GetAtomicInt(&ix->abort);
+}
+
+/* Open and probe the file on a private context. Blocking I/O returns
+ * as soon as seek_index_stop() raises the abort flag. */
+static AVFormatContext *seek_index_open(SeekIndex *ix) {
+    AVFormatContext *fc = avformat_alloc_context();
+    if (!fc) return NULL;
+    fc->interrupt_callback.callback = seek_index_interrupt;
+    fc->interrupt_callback.opaque   = ix;
+    if (avformat_open_input(&fc, ix->path, NULL, NULL) < 0) {
+        if (!SDL_GetAtomicInt(&ix->abort))
+            log_msg("Seek index: cannot open %s", ix->path);
+        return NULL;   /* fc freed by avformat_open_input */
+    }
+    /* Match the playback context's stream numbering (TS creates
+     * streams while probing) */
+    if (avformat_find_stream_info(fc, NULL) < 0 ||
+        ix->stream_idx >= (int)fc->nb_streams) {
+        avformat_close_input(&fc);
+        return NULL;
+    }
+    return fc;
+}
+
+/* Copy the container's keyframe entries for st. */
+static void seek_index_collect(AVStream *st, SeekIndexEntry **e, int *count, int *cap) {
+    *count = 0;
+    int n = avformat_index_get_entries_count(st);
+    for (int i = 0; i < n; i++) {
+        const AVIndexEntry *ie = avformat_index_get_entry(st, i);
+        if (ie && (ie->flags & AVINDEX_KEYFRAME))
+            if (seek_index_push(e, count, cap, ie->timestamp, ie->pos) < 0)
+                break;
+    }
+}
+
+/* 1 if the entries reach the end of the stream. An unknown duration
+ * cannot be checked, so it does not count as complete. */
+static int seek_index_complete(AVFormatContext *fc, AVStream *st,
+                               const SeekIndexEntry *e, int count)
+{
+    if (count < 2) return 0;
+
+    int64_t end;
+    if (st->duration != AV_NOPTS_VALUE && st->duration > 0)
+        end = st->duration;
+    else if (fc->duration != AV_NOPTS_VALUE && fc->duration > 0)
+        end = av_rescale_q(fc->duration, AV_TIME_BASE_Q, st->time_base);
+    else
+        return 0;
+    if (st->start_time != AV_NOPTS_VALUE)
+        end += st->start_time;
+
+    int64_t last = e[0].ts;
+    for (int i = 1; i < count; i++)
+        if (e[i].ts > last) last = e[i].ts;
+
+    int64_t tail = av_rescale_q((int64_t)(SEEK_INDEX_TAIL_SEC * AV_TIME_BASE),
+                                AV_TIME_BASE_Q, st->time_base);
+    return last >= end - tail;
+}
+
+static int seek_index_thread(void *arg) {
+    SeekIndex *ix = (SeekIndex *)arg;
+    double t0 = get_time_sec();
+
+    /* Indexing must never compete with decode for CPU */
+    SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_LOW);
+
+    AVFormatContext *fc = seek_index_open(ix);
+    if (!fc) return 0;
+
+    AVStream *st = fc->streams[ix->stream_idx];
+    SeekIndexEntry *e = NULL;
+    int count = 0, cap = 0;
+    int from_container = 0;
+
+    /* ── Container index (Cues / stss / idx1) ── */
+    seek_index_collect(st, &e, &count, &cap);
+    if (!seek_index_complete(fc, st, e, count) && !SDL_GetAtomicInt(&ix->abort)) {
+        /* Lazily read indexes (Matroska Cues) load on the first seek */
+        avformat_seek_file(fc, ix->stream_idx, INT64_MIN, INT64_MAX, INT64_MAX, 0);
+        seek_index_collect(st, &e, &count, &cap);
+    }
+    if (seek_index_complete(fc, st, e, count)) {
+        from_container = 1;
+    } else if (!SDL_GetAtomicInt(&ix->abort)) {
+        /* ── One-pass scan: video packets only, from a fresh context
+         * (the probe seek above moved the read position) ── */
+        if (count > 0)
+            log_msg("Seek index: container index covers only part of the file, scanning");
+        count = 0;
+        avformat_close_input(&fc);
+        fc = seek_index_open(ix);
+        if (!fc) {
+            free(e);
+            return 0;
+        }
+        st = fc->streams[ix->stream_idx];
+        for (unsigned i = 0; i < fc->nb_streams; i++)
+            if ((int)i != ix->stream_idx)
+                fc->streams[i]->discard = AVDISCARD_ALL;
+
+        AVPacket *pkt = av_packet_alloc();
+        while (pkt && !SDL_GetAtomicInt(&ix->abort)
+               && av_read_frame(fc, pkt) >= 0) {
+            if (pkt->stream_index == ix->stream_idx &&
+                (pkt->flags & AV_PKT_FLAG_KEY)) {
+                int64_t ts = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+                if (ts != AV_NOPTS_VALUE &&
+                    seek_index_push(&e, &count, &cap, ts, pkt->pos) < 0) {
+                    av_packet_unref(pkt);
+                    break;
+                }
+            }
+            av_packet_unref(pkt);
+        }
+        av_packet_free(&pkt);
+    }
+
+    /* Byte seeks for scanned containers: their timestamp seek is a
+     * bisection that can land on a non-keyframe. Container indexes
+     * seek by timestamp, which resolves to the same entry. */
+    int by_byte = !from_container && !(fc->iformat->flags & AVFMT_NO_BYTE_SEEK);
+    ix->time_base = st->time_base;
+    avformat_close_input(&fc);
+
+    if (SDL_GetAtomicInt(&ix->abort) || count == 0) {
+        free(e);
+        return 0;
+    }
+
+    qsort(e, count, sizeof(*e), seek_index_cmp);
+
+    /* ── Split into the published arrays ── */
+    ix->ts  = malloc((size_t)count * sizeof(int64_t));
+    ix->pos = malloc((size_t)count * sizeof(int64_t));
+    if (!ix->ts || !ix->pos) {
+        free(ix->ts);
+        free(ix->pos);
+        ix->ts = ix->pos = NULL;
+        free(e);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        ix->ts[i]  = e[i].ts;
+        ix->pos[i] = e[i].pos;
+    }
+    free(e);
+
+    ix->count     = count;
+    ix->by_byte   = by_byte;
+    ix->build_sec = get_time_sec() - t0;
+    SDL_SetAtomicInt(&ix->ready, 1);   /* publish: arrays immutable from here */
+
+    log_msg("Seek index: %d keyframes from %s in %.2fs (%s seeks)",
+            count, from_container ? "container index" : "scan",
+            ix->build_sec, by_byte ? "byte" : "timestamp");
+    return 0;
+}
+
+/* ═══════════════════════════════════════════════════════════════════
+ * Lifetime / Lookup
+ * ═══════════════════════════════════════════════════════════════════ */
+
+/* Start indexing the current file's video stream. Called from
+ * player_open() once the playback threads are running. */
+void seek_index_start(PlayerState *ps) {
+    SeekIndex *ix = &ps->seek_index;
+    memset(ix, 0, sizeof(*ix));
+    if (ps->video_stream_idx < 0) return;
+
+    ix->stream_idx = ps->video_stream_idx;
+    ix->path = strdup(ps->filepath);
+    if (!ix->path) return;
+    ix->thread = SDL_CreateThread(seek_index_thread, "seekindex", ix);
+}
+
+/* Abort the scan (if still running), join, and free the table. */
+void seek_index_stop(PlayerState *ps) {
+    SeekIndex *ix = &ps->seek_index;
+    if (ix->thread) {
+        SDL_SetAtomicInt(&ix->abort, 1);
+        SDL_WaitThread(ix->thread, NULL);
+        ix->thread = NULL;
+    }
+    free(ix->ts);
+    free(ix->pos);
+    free(ix->path);
+    memset(ix, 0, sizeof(*ix));
+}
+
+/* Find the last keyframe at or before target (AV_TIME_BASE units, same
+ * clock as seek_target). Returns 1 and fills *ts (stream time base) and
+ * *pos (byte offset, -1 if unknown), or 0 if the index is not ready. */
+int seek_index_lookup(SeekIndex *ix, int64_t target, int64_t *ts, int64_t *pos) {
+    if (!SDL_GetAtomicInt(&ix->ready) || ix->count == 0) return 0;
+
+    int64_t t = av_rescale_q(target, AV_TIME_BASE_Q, ix->time_base);
+
+    /* Binary search: largest i with ts[i] <= t (first entry if none) */
+    int lo = 0, hi = ix->count - 1, best = 0;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (ix->ts[mid] <= t) {
+            best = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    *ts  = ix->ts[best];
+    *pos = ix->pos[best];
+    return 1;
+}
@@ -177,6 +177,7 @@ static void sub_clear_bitmaps(PlayerState *ps) {
         }
     }
     ps->sub_bitmap_count = 0;
+    ps->sub_bitmap_serial++;   /* GPU subtitle layer re-uploads */
 }
 
 
@@ -437,9 +438,39 @@ static uint8_t *pgs_try_decompress(const uint8_t *data, int size, int *out_size)
  * Called from the main thread each frame. Pops ONE subtitle at a
  * time from the queue and holds it until its display time expires.
  * Skips subtitles whose end time has already passed.
+ *
+ * The main thread is the sole consumer of every sub_pqs ring. The demux
+ * thread flushes them (and the subtitle codec) during seeks with
+ * seek_mutex held, so all queue access here happens under TryLock.
  */
 
+/* Inactive tracks are never drained by decoding, so keep only their
+ * newest packets — a track switch then starts near the current position
+ * instead of the demuxer dropping fresh packets into a full ring. */
+static void sub_trim_inactive(PlayerState *ps) {
+    AVPacket pkt;
+    for (int i = 0; i < ps->sub_count; i++) {
+        if (i == ps->sub_selection - 1) continue;
+        PacketQueue *q = &ps->sub_pqs[i];
+        while (pq_nb_packets(q) > PACKET_QUEUE_SLOTS / 2
+                && pq_get(q, &pkt, 0) > 0)
+            av_packet_unref(&pkt);
+    }
+}
+
+static void sub_decode_queue(PlayerState *ps);
+
 void sub_decode_pending(PlayerState *ps) {
+    if (ps->seeking || !ps->seek_mutex) return;
+    if (!SDL_TryLockMutex(ps->seek_mutex)) return;  /* seek flushing queues */
+
+    sub_trim_inactive(ps);
+    sub_decode_queue(ps);
+
+    SDL_UnlockMutex(ps->seek_mutex);
+}
+
+static void sub_decode_queue(PlayerState *ps) {
     if (ps->sub_active_idx < 0 || !ps->sub_codec_ctx) return;
     if (ps->sub_selection <= 0 || ps->sub_selection > ps->sub_count) return;
 